@@ -0,0 +1,87 @@
+#include "Devices.hpp"
+#include "RAM.tcc"
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+/*
+Measures what the interpreter spends on each instruction
+
+A loop of ALU instructions, mixing primary opcodes and SPECIAL ones, runs from
+RAM with both interpreters. The plain Interpreter fetches and decodes every
+instruction before calling its handler, the CachedInterpreter calls the
+handlers it decoded once.
+*/
+
+const uint32_t PROGRAM_ADDRESS = 0x80010000;
+const uint32_t LOOP_UNROLL = 64;
+const uint64_t INSTRUCTIONS_PER_ROUND = 50000000;
+
+static uint32_t encodeRegister(uint32_t function, uint32_t rs, uint32_t rt, uint32_t rd, uint32_t shiftAmount) {
+    return (rs << 21) | (rt << 16) | (rd << 11) | (shiftAmount << 6) | function;
+}
+
+static uint32_t encodeImmediate(uint32_t opcode, uint32_t rs, uint32_t rt, uint16_t immediate) {
+    return (opcode << 26) | (rs << 21) | (rt << 16) | immediate;
+}
+
+static vector<uint32_t> makeProgram() {
+    // Registers 8 to 15 are shuffled around so no instruction is a no-op
+    const vector<uint32_t> body = {
+        encodeImmediate(0b001001, 8, 9, 0x0011),    // addiu
+        encodeRegister(0b100001, 8, 9, 10, 0),      // addu
+        encodeImmediate(0b001101, 10, 11, 0x00f0),  // ori
+        encodeRegister(0b000000, 0, 11, 12, 3),     // sll
+        encodeRegister(0b100110, 12, 9, 13, 0),     // xor
+        encodeImmediate(0b001111, 0, 14, 0x1234),   // lui
+        encodeRegister(0b101011, 13, 14, 15, 0),    // sltu
+        encodeImmediate(0b001100, 15, 8, 0x7fff),   // andi
+        encodeRegister(0b100011, 10, 8, 9, 0),      // subu
+        encodeRegister(0b000010, 0, 13, 11, 5),     // srl
+        encodeImmediate(0b001010, 12, 10, 0x0100),  // slti
+        encodeRegister(0b100101, 9, 14, 12, 0),     // or
+    };
+    vector<uint32_t> program;
+    for (uint32_t i = 0; i < LOOP_UNROLL; i++) {
+        program.push_back(body[i % body.size()]);
+    }
+    // j PROGRAM_ADDRESS and its delay slot
+    program.push_back((0b000010 << 26) | ((PROGRAM_ADDRESS >> 2) & 0x3ffffff));
+    program.push_back(0);
+    return program;
+}
+
+static double nanosecondsPerInstruction(CPUExecutionMode mode) {
+    Devices devices;
+    devices.cpu->setExecutionMode(mode);
+    devices.cpu->setIdleLoopSkipping(false);
+
+    uint32_t offset = PROGRAM_ADDRESS & 0x1fffff;
+    for (uint32_t word : makeProgram()) {
+        devices.ram->store<uint32_t>(offset, word);
+        offset += 4;
+    }
+    devices.cpu->setProgramCounter(PROGRAM_ADDRESS);
+
+    CPU *cpu = devices.cpu.get();
+    return fastestRound([cpu]() {
+        uint64_t executed = 0;
+        while (executed < INSTRUCTIONS_PER_ROUND) {
+            uint32_t executedInstructions = 0;
+            cpu->run(1000000, executedInstructions);
+            executed += executedInstructions;
+        }
+        return executed;
+    });
+}
+
+int main() {
+    double interpreter = nanosecondsPerInstruction(Interpreter);
+    double cachedInterpreter = nanosecondsPerInstruction(CachedInterpreter);
+    printf("Interpreter:        %.2f ns per instruction, %.0f MIPS\n", interpreter, 1000 / interpreter);
+    printf("Cached interpreter: %.2f ns per instruction, %.0f MIPS\n", cachedInterpreter, 1000 / cachedInterpreter);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,42 @@
+#include "Devices.hpp"
+#include <chrono>
+
+using namespace std;
+
+const uint32_t BENCHMARK_ROUNDS = 5;
+
+Devices::Devices() {
+    scheduler = make_unique<Scheduler>();
+    debugger = make_unique<Debugger>();
+    cop0 = make_unique<COP0>();
+    bios = make_unique<BIOS>(NoLog);
+    ram = make_unique<RAM>();
+    gpu = make_unique<GPU>(NoLog);
+    scratchpad = make_unique<Scratchpad>();
+    interruptController = make_unique<InterruptController>(NoLog, cop0);
+    cdrom = make_unique<CDROM>(NoLog, interruptController, scheduler);
+    dma = make_unique<DMA>(NoLog, ram, gpu, cdrom, interruptController);
+    expansion1 = make_unique<Expansion1>();
+    timer0 = make_unique<Timer0>(scheduler);
+    timer1 = make_unique<Timer1>(scheduler);
+    timer2 = make_unique<Timer2>(scheduler);
+    controller = make_unique<Controller>(NoLog, interruptController, scheduler);
+    spu = make_unique<SPU>(NoLog);
+    interconnect = make_unique<Interconnect>(NoLog, cop0, bios, ram, gpu, dma, scratchpad, cdrom, interruptController, expansion1, timer0, timer1, timer2, controller, spu, debugger);
+    cpu = make_unique<CPU>(NoLog, interconnect, cop0, scheduler, debugger, false);
+    debugger->setCPU(cpu.get());
+}
+
+double fastestRound(const function<uint64_t()> &round) {
+    double fastest = 0;
+    for (uint32_t i = 0; i < BENCHMARK_ROUNDS; i++) {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        uint64_t operations = round();
+        chrono::duration<double, nano> elapsed = chrono::steady_clock::now() - start;
+        double nanoseconds = elapsed.count() / operations;
+        if (i == 0 || nanoseconds < fastest) {
+            fastest = nanoseconds;
+        }
+    }
+    return fastest;
+}
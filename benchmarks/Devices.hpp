@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include "CPU.hpp"
+#include "COP0.hpp"
+#include "Interconnect.hpp"
+#include "BIOS.hpp"
+#include "RAM.hpp"
+#include "GPU.hpp"
+#include "DMA.hpp"
+#include "Scratchpad.hpp"
+#include "CDROM.hpp"
+#include "InterruptController.hpp"
+#include "Expansion1.hpp"
+#include "Timer.hpp"
+#include "Controller.hpp"
+#include "SPU.hpp"
+#include "Debugger.hpp"
+#include "Scheduler.hpp"
+
+// The console wired up like Machine does, without a BIOS image, logs or a GPU backend
+struct Devices {
+    std::unique_ptr<Scheduler> scheduler;
+    std::unique_ptr<Debugger> debugger;
+    std::unique_ptr<COP0> cop0;
+    std::unique_ptr<BIOS> bios;
+    std::unique_ptr<RAM> ram;
+    std::unique_ptr<GPU> gpu;
+    std::unique_ptr<Scratchpad> scratchpad;
+    std::unique_ptr<InterruptController> interruptController;
+    std::unique_ptr<CDROM> cdrom;
+    std::unique_ptr<DMA> dma;
+    std::unique_ptr<Expansion1> expansion1;
+    std::unique_ptr<Timer0> timer0;
+    std::unique_ptr<Timer1> timer1;
+    std::unique_ptr<Timer2> timer2;
+    std::unique_ptr<Controller> controller;
+    std::unique_ptr<SPU> spu;
+    std::unique_ptr<Interconnect> interconnect;
+    std::unique_ptr<CPU> cpu;
+
+    Devices();
+};
+
+// Runs the same round several times and returns the nanoseconds per operation of the
+// fastest one, the slower rounds got interrupted by the host. A round returns how many
+// operations it did
+double fastestRound(const std::function<uint64_t()> &round);
@@ -0,0 +1,82 @@
+#include "Devices.hpp"
+#include "RAM.tcc"
+#include "BIOS.tcc"
+#include "Scratchpad.tcc"
+#include "Interconnect.tcc"
+#include <cstdio>
+#include <cstdlib>
+
+using namespace std;
+
+/*
+Measures word loads and stores on the memories the CPU fetches and accesses data from
+
+Each access walks the whole memory a word at a time, first through the devices
+themselves and then through the Interconnect at the KSEG0 and KSEG1 addresses
+instruction fetches use.
+*/
+
+const uint64_t ACCESSES_PER_ROUND = 64 * 1024 * 1024;
+
+// Folded into the output so loads can't be optimized away
+static uint32_t checksum = 0;
+
+template <typename Access>
+static double millionsOfAccessesPerSecond(uint32_t size, Access access) {
+    double nanoseconds = fastestRound([size, &access]() {
+        uint32_t sum = 0;
+        uint64_t accesses = 0;
+        while (accesses < ACCESSES_PER_ROUND) {
+            for (uint32_t offset = 0; offset < size; offset += 4) {
+                sum += access(offset);
+            }
+            accesses += size / 4;
+        }
+        checksum ^= sum;
+        return accesses;
+    });
+    return 1000 / nanoseconds;
+}
+
+int main() {
+    Devices devices;
+    RAM *ram = devices.ram.get();
+    BIOS *bios = devices.bios.get();
+    Scratchpad *scratchpad = devices.scratchpad.get();
+    Interconnect *interconnect = devices.interconnect.get();
+
+    double ramLoads = millionsOfAccessesPerSecond(RAM_SIZE, [ram](uint32_t offset) {
+        return ram->load<uint32_t>(offset);
+    });
+    double ramStores = millionsOfAccessesPerSecond(RAM_SIZE, [ram](uint32_t offset) {
+        ram->store<uint32_t>(offset, offset);
+        return 0;
+    });
+    double biosLoads = millionsOfAccessesPerSecond(BIOS_SIZE, [bios](uint32_t offset) {
+        return bios->load<uint32_t>(offset);
+    });
+    double scratchpadLoads = millionsOfAccessesPerSecond(SCRATCHPAD_SIZE, [scratchpad](uint32_t offset) {
+        return scratchpad->load<uint32_t>(offset);
+    });
+    double scratchpadStores = millionsOfAccessesPerSecond(SCRATCHPAD_SIZE, [scratchpad](uint32_t offset) {
+        scratchpad->store<uint32_t>(offset, offset);
+        return 0;
+    });
+    double ramFetches = millionsOfAccessesPerSecond(RAM_SIZE, [interconnect](uint32_t offset) {
+        return interconnect->load<uint32_t>(0x80000000 + offset);
+    });
+    double biosFetches = millionsOfAccessesPerSecond(BIOS_SIZE, [interconnect](uint32_t offset) {
+        return interconnect->load<uint32_t>(0xbfc00000 + offset);
+    });
+
+    printf("Millions of word accesses per second\n");
+    printf("RAM loads:                          %.0f\n", ramLoads);
+    printf("RAM stores:                         %.0f\n", ramStores);
+    printf("BIOS loads:                         %.0f\n", biosLoads);
+    printf("Scratchpad loads:                   %.0f\n", scratchpadLoads);
+    printf("Scratchpad stores:                  %.0f\n", scratchpadStores);
+    printf("Interconnect loads from KSEG0 RAM:  %.0f\n", ramFetches);
+    printf("Interconnect loads from KSEG1 BIOS: %.0f\n", biosFetches);
+    printf("Checksum: %#x\n", checksum);
+    return EXIT_SUCCESS;
+}
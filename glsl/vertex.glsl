@@ -3,10 +3,7 @@
 in ivec2 vertex_point;
 in uvec3 vertex_color;
 in ivec2 texture_point;
-in uint texture_blend_mode;
-in uvec2 texture_page;
-in uint texture_depth_shift;
-in uvec2 clut;
+in uint vertex_attributes;
 
 out vec3 color;
 out vec2 fragment_texture_point;
@@ -15,19 +12,15 @@ flat out uvec2 fragment_texture_page;
 flat out uint fragment_texture_depth_shift;
 flat out uvec2 fragment_clut;
 
-uniform ivec2 offset;
-
 void main() {
-    ivec2 position = vertex_point + offset;
-
-    float x_pos = (float(position.x) / 512) - 1.0;
-    float y_pos = 1.0 - (float(position.y) / 256);
+    float x_pos = (float(vertex_point.x) / 512) - 1.0;
+    float y_pos = 1.0 - (float(vertex_point.y) / 256);
 
     gl_Position.xyzw = vec4(x_pos, y_pos, 0.0, 1.0);
     color = vec3(float(vertex_color.r) / 255, float(vertex_color.g) / 255, float(vertex_color.b) / 255);
     fragment_texture_point = vec2(texture_point);
-    fragment_texture_blend_mode = texture_blend_mode;
-    fragment_texture_page = texture_page;
-    fragment_texture_depth_shift = texture_depth_shift;
-    fragment_clut = clut;
+    fragment_clut = uvec2((vertex_attributes & 0x3fU) << 4, (vertex_attributes >> 6) & 0x1ffU);
+    fragment_texture_page = uvec2(((vertex_attributes >> 16) & 0xfU) << 6, ((vertex_attributes >> 20) & 0x1U) << 8);
+    fragment_texture_blend_mode = (vertex_attributes >> 21) & 0x3U;
+    fragment_texture_depth_shift = (vertex_attributes >> 23) & 0x3U;
 }
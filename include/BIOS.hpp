@@ -5,11 +5,13 @@
 #include <array>
 #include <filesystem>
 #include "Logger.hpp"
+#include "SharedMemory.hpp"
 
 const uint32_t BIOS_SIZE = 512*1024;
 
 class BIOS {
-    uint8_t data[BIOS_SIZE];
+    SharedMemory memory;
+    uint8_t *data;
     Logger logger;
 
     std::string formatBIOSFunction(std::string function, unsigned int argc, std::array<uint32_t, 4> subroutineArguments);
@@ -21,9 +23,12 @@ public:
     BIOS(LogLevel logLevel);
     ~BIOS();
 
+    std::array<uint32_t, 3> functionsStepAddresses() const;
     std::optional<std::string> checkFunctions(uint32_t programCounter, uint32_t r9, std::array<uint32_t, 4> subroutineArguments);
 
     void loadBin(const std::filesystem::path& filePath);
+    uint8_t* dataAtOffset(uint32_t offset);
+    const SharedMemory& getMemory() const;
     template <typename T>
     inline T load(uint32_t offset) const;
 };
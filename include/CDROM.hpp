@@ -5,6 +5,7 @@
 #include <filesystem>
 #include "InterruptController.hpp"
 #include "CDImage.hpp"
+#include "Scheduler.hpp"
 #include "Logger.hpp"
 
 /*
@@ -218,6 +219,7 @@ union CDROMMode {
 class CDROM {
     Logger logger;
     std::unique_ptr<InterruptController> &interruptController;
+    std::unique_ptr<Scheduler> &scheduler;
     CDImage image;
 
     CDROMStatus status;
@@ -230,7 +232,6 @@ class CDROM {
     std::queue<CDROMInterruptNumber> interruptQueue;
     uint32_t seekSector;
     uint32_t readSector;
-    uint32_t counter;
     CDSector currentSector;
     std::vector<uint32_t> readBuffer;
     uint32_t readBufferIndex;
@@ -263,6 +264,7 @@ class CDROM {
 
     void updateStatusRegister();
     uint8_t loadByteFromReadBuffer();
+    void scheduleNextSector();
 
 /*
 Command          Parameters      Response(s)
@@ -324,10 +326,11 @@ Command          Parameters      Response(s)
 
     void handleUnsupportedOperation(uint8_t operation);
 public:
-    CDROM(LogLevel logLevel, std::unique_ptr<InterruptController> &interruptController);
+    CDROM(LogLevel logLevel, std::unique_ptr<InterruptController> &interruptController, std::unique_ptr<Scheduler> &scheduler);
     ~CDROM();
 
-    void step();
+    void triggerInterrupt();
+    void readNextSector();
 
     template <typename T>
     inline T load(uint32_t offset);
@@ -1,11 +1,16 @@
 #pragma once
 #include <memory>
 #include <array>
+#include <vector>
+#include <unordered_map>
 #include "Interconnect.hpp"
 #include "Instruction.hpp"
 #include "Debugger.hpp"
 #include "COP0.hpp"
 #include "Logger.hpp"
+#include "CPUExecutionMode.hpp"
+#include "LockstepJournal.hpp"
+#include "Scheduler.hpp"
 
 struct LoadSlot {
     uint32_t registerIndex;
@@ -13,6 +18,98 @@ struct LoadSlot {
     uint32_t previousValue;
 };
 
+class CPU;
+class Recompiler;
+
+// Range of the CPU clock relative to the rest of the machine
+const uint32_t CPU_MINIMUM_CLOCK_PERCENTAGE = 50;
+const uint32_t CPU_MAXIMUM_CLOCK_PERCENTAGE = 400;
+
+typedef void (CPU::*InstructionHandler)(Instruction);
+// Native code generated for a basic block, returns the number of instructions executed
+typedef uint32_t (*RecompiledCode)();
+
+struct CachedInstruction {
+    InstructionHandler handler;
+    Instruction instruction;
+};
+
+// A run of guest instructions decoded once, ending after the delay slot of the
+// first branch or jump found, or at the end of a RAM code page.
+// Blocks are keyed by their physical address and, when they live in RAM,
+// remember the generation of their page so writes can invalidate them.
+struct BasicBlock {
+    std::vector<CachedInstruction> instructions;
+    bool isInRAM;
+    uint32_t ramOffset;
+    uint32_t generation;
+    RecompiledCode recompiledCode;
+    bool isRecompilable;
+    // Branches back to its own start and has no side effects other than loads
+    bool isIdleLoopCandidate;
+};
+
+// ALU operations shared by the register, immediate and shift instruction handlers,
+// the shift operations take the shift amount as their second operand
+struct AddOperation {
+    static uint32_t apply(uint32_t a, uint32_t b) { return a + b; }
+};
+
+struct SubtractOperation {
+    static uint32_t apply(uint32_t a, uint32_t b) { return a - b; }
+};
+
+struct AndOperation {
+    static uint32_t apply(uint32_t a, uint32_t b) { return a & b; }
+};
+
+struct OrOperation {
+    static uint32_t apply(uint32_t a, uint32_t b) { return a | b; }
+};
+
+struct ExclusiveOrOperation {
+    static uint32_t apply(uint32_t a, uint32_t b) { return a ^ b; }
+};
+
+struct NotOrOperation {
+    static uint32_t apply(uint32_t a, uint32_t b) { return ~(a | b); }
+};
+
+struct SetOnLessThanOperation {
+    static uint32_t apply(uint32_t a, uint32_t b) { return (int32_t)a < (int32_t)b; }
+};
+
+struct SetOnLessThanUnsignedOperation {
+    static uint32_t apply(uint32_t a, uint32_t b) { return a < b; }
+};
+
+struct ShiftLeftLogicalOperation {
+    static uint32_t apply(uint32_t a, uint32_t b) { return a << b; }
+};
+
+struct ShiftRightLogicalOperation {
+    static uint32_t apply(uint32_t a, uint32_t b) { return a >> b; }
+};
+
+struct ShiftRightArithmeticOperation {
+    static uint32_t apply(uint32_t a, uint32_t b) { return ((int32_t)a) >> b; }
+};
+
+// Architectural state compared by the lockstep mode
+struct CPUSnapshot {
+    std::array<uint32_t, 32> registers;
+    uint32_t programCounter;
+    uint32_t jumpDestination;
+    bool isBranching;
+    std::array<LoadSlot, 2> loadSlots;
+    uint32_t highRegister;
+    uint32_t lowRegister;
+    // Restored so replaying a block doesn't count its stalls twice
+    uint32_t stallCycles;
+    uint64_t multiplyDivideReadyCycle;
+    COP0 cop0;
+};
+
 /*
 CPU Register Summary
 Name       Alias    Common Usage
@@ -32,6 +129,8 @@ R31        ra       Return address (used so by JAL,BLTZAL,BGEZAL opcodes)
 -          hi,lo    Multiply/divide results, may be changed by subroutines
 */
 class CPU {
+    friend class Recompiler;
+
     Logger logger;
     uint32_t programCounter;
     uint32_t jumpDestination;
@@ -43,67 +142,130 @@ class CPU {
     uint32_t lowRegister;
     std::unique_ptr<Interconnect> &interconnect;
     std::unique_ptr<COP0> &cop0;
+    std::unique_ptr<Scheduler> &scheduler;
+    std::unique_ptr<Debugger> &debugger;
     Instruction currentInstruction;
     bool logBiosFunctionCalls;
 
+    CPUExecutionMode executionMode;
+    std::unordered_map<uint32_t, BasicBlock> basicBlocks;
+    BasicBlock *currentBasicBlock;
+    uint32_t currentBasicBlockIndex;
+    uint32_t currentBasicBlockProgramCounter;
+    uint64_t invalidatedBasicBlocks;
+
+    std::unique_ptr<Recompiler> recompiler;
+    bool lockstep;
+    LockstepJournal *lockstepJournal;
+    std::unique_ptr<LockstepJournal> journal;
+    uint64_t recompiledBasicBlocks;
+    std::vector<uint32_t> executionHooks;
+
+    bool idleLoopSkipping;
+    uint32_t idleLoopAddress;
+    std::array<uint32_t, 32> idleLoopRegisters;
+    uint64_t skippedIdleCycles;
+
+    // Clocks the current instruction waited on memory or on the multiplier/divider, on top
+    // of the one it takes, and when the result of the last MULT or DIV lands in hi/lo
+    uint32_t stallCycles;
+    uint64_t multiplyDivideReadyCycle;
+    // CPU cycles run so far, unlike the scheduler's timestamp it doesn't depend on the clock percentage
+    uint64_t cycleCount;
+    // A recompiled block only advances the clock once it's done, this is how many cycles the
+    // instructions before the one calling back into the interpreter took
+    uint32_t blockElapsedCycles;
+
+    // CPU cycles run per 100 system clocks, the leftover fraction of a system clock is
+    // kept for the next advance so the scaling doesn't drift
+    uint32_t clockPercentage;
+    uint32_t clockRemainder;
+
     void moveLoadDelaySlots();
     void loadDelaySlot(uint32_t registerIndex, uint32_t value);
     void invalidateLoadSlot(uint32_t registerIndex);
+    // Loads on behalf of the executed instruction, which waits on the bus for them
+    template <typename T>
+    inline T loadData(uint32_t address);
+    void startMultiplyDivide(uint32_t cycles);
+    void waitForMultiplyDivide();
+    uint64_t currentCycle() const;
+    inline void advanceCycles(uint32_t cycles);
 
     uint32_t registerAtIndex(uint32_t index) const;
     void setRegisterAtIndex(uint32_t index, uint32_t value);
 
+    void executeInstruction(const CachedInstruction *cachedInstruction);
     void decodeAndExecuteInstruction(Instruction instruction);
+    InstructionHandler decodeInstruction(Instruction instruction) const;
+
+    // Handlers indexed by the primary opcode field, and by the secondary one for SPECIAL,
+    // built at compile time so decoding is two table lookups instead of a switch
+    static const std::array<InstructionHandler, 64> primaryOpcodeHandlers;
+    static const std::array<InstructionHandler, 64> secondaryOpcodeHandlers;
+    static constexpr std::array<InstructionHandler, 64> makePrimaryOpcodeHandlers();
+    static constexpr std::array<InstructionHandler, 64> makeSecondaryOpcodeHandlers();
+
+    const CachedInstruction* nextCachedInstruction();
+    BasicBlock* lookupBasicBlock(uint32_t address);
+    void compileBasicBlock(BasicBlock &basicBlock, uint32_t address);
+    bool isBasicBlockValid(const BasicBlock &basicBlock) const;
+
+    bool isExecutionHook(uint32_t address) const;
+    uint32_t executeRecompiledBasicBlock(BasicBlock &basicBlock, uint32_t address);
+    bool isIdleLoopCandidate(const BasicBlock &basicBlock, uint32_t address) const;
+    bool isIdleLoopIteration(const BasicBlock &basicBlock, uint32_t address);
+    bool hasSideEffectFreeLoads(const BasicBlock &basicBlock) const;
+    RecompiledCode recompiledCodeForBasicBlock(BasicBlock &basicBlock, uint32_t address);
+    void flushRecompiledCode();
+    uint32_t executeInLockstep(RecompiledCode recompiledCode);
+    CPUSnapshot snapshot() const;
+    void restore(const CPUSnapshot &snapshot);
+    std::optional<std::string> compare(const CPUSnapshot &recompiled, const CPUSnapshot &interpreted) const;
     void branch(uint32_t offset);
     void triggerException(ExceptionType exceptionType);
 
+    // rd = rs <op> rt
+    template <typename Operation>
+    void operationRegister(Instruction instruction);
+    // rt = rs <op> imm, sign extended or not
+    template <typename Operation, bool signExtend>
+    void operationImmediate(Instruction instruction);
+    // rd = rt <op> shiftimm
+    template <typename Operation>
+    void operationShiftImmediate(Instruction instruction);
+    // rd = rt <op> (rs & 0x1f)
+    template <typename Operation>
+    void operationShiftVariable(Instruction instruction);
+
+    void operationSpecial(Instruction instruction);
     void operationLoadUpperImmediate(Instruction instruction);
-    void operationBitwiseOrImmediate(Instruction instruction);
-    void operationShiftLeftLogical(Instruction instruction);
-    void operationAddImmediateUnsigned(Instruction instruction);
     void operationJump(Instruction instruction);
-    void operationBitwiseOr(Instruction Instruction);
     void operationCoprocessor0(Instruction instruction);
     void operationMoveToCoprocessor0(Instruction instruction);
     void operationBranchIfNotEqual(Instruction instruction);
     void operationAddImmediate(Instruction instruction);
-    void operationSetOnLessThanUnsigned(Instruction instruction);
-    void operationAddUnsigned(Instruction instruction);
     void operationJumpAndLink(Instruction instruction);
-    void operationBitwiseAndImmediate(Instruction instruction);
     void operationJumpRegister(Instruction instruction);
     void operationBranchIfEqual(Instruction instruction);
     void operationMoveFromCoprocessor0(Instruction instruction);
-    void operationBitwiseAnd(Instruction instruction);
     void operationAdd(Instruction instruction);
     void operationBranchIfGreaterThanZero(Instruction instruction);
     void operationBranchIfLessThanOrEqualToZero(Instruction instruction);
     void operationJumpAndLinkRegister(Instruction instruction);
     void operationsMultipleBranchIf(Instruction instruction);
-    void operationSetIfLessThanImmediate(Instruction instruction);
-    void operationSubstractUnsigned(Instruction instruction);
-    void operationShiftRightArithmetic(Instruction instruction);
     void operationDivision(Instruction instruction);
     void operationMoveFromLowRegister(Instruction instruction);
-    void operationShiftRightLogical(Instruction instruction);
-    void operationSetIfLessThanImmediateUnsigned(Instruction instruction);
     void operationDivisionUnsigned(Instruction instruction);
     void operationMoveFromHighRegister(Instruction instruction);
-    void operationSetOnLessThan(Instruction instruction);
     void operationSystemCall(Instruction instruction);
     void operationMoveToLowRegister(Instruction instruction);
     void operationMoveToHighRegister(Instruction instruction);
     void operationReturnFromException(Instruction instruction);
-    void operationShiftLeftLogicalVariable(Instruction instruction);
-    void operationBitwiseNotOr(Instruction instruction);
-    void operationShiftRightArithmeticVariable(Instruction instruction);
-    void operationShiftRightLogicalVariable(Instruction instruction);
     void operationMultiplyUnsigned(Instruction instruction);
-    void operationBitwiseExclusiveOr(Instruction instruction);
     void operationBreak(Instruction instruction);
     void operationMultiply(Instruction instruction);
     void operationSubstract(Instruction instruction);
-    void operationBitwiseExclusiveOrImmediate(Instruction instruction);
     void operationCoprocessor1(Instruction instruction);
     void operationCoprocessor2(Instruction instruction);
     void operationCoprocessor3(Instruction instruction);
@@ -124,7 +286,7 @@ class CPU {
 
     void operationStoreWord(Instruction instruction);
     void operationStoreHalfWord(Instruction instruction);
-    void operationStoreByte(Instruction instruction) const;
+    void operationStoreByte(Instruction instruction);
 
     void operationLoadWord(Instruction instruction);
     void operationLoadHalfWord(Instruction instruction);
@@ -134,7 +296,7 @@ class CPU {
 
     void operationIllegal(Instruction instruction);
 public:
-    CPU(LogLevel logLevel, std::unique_ptr<Interconnect> &interconnect, std::unique_ptr<COP0> &cop0, bool logBiosFunctionCalls);
+    CPU(LogLevel logLevel, std::unique_ptr<Interconnect> &interconnect, std::unique_ptr<COP0> &cop0, std::unique_ptr<Scheduler> &scheduler, std::unique_ptr<Debugger> &debugger, bool logBiosFunctionCalls);
     ~CPU();
 
     std::unique_ptr<COP0>& cop0Ref();
@@ -145,6 +307,29 @@ public:
     inline void store(uint32_t address, T value) const;
 
     bool executeNextInstruction();
+    // Runs until at least cycleBudget system clocks went by or a scheduled event is due, stopping
+    // early right before an instruction at a hooked address. Returns false when stopped on a COP0
+    // breakpoint. Every instruction takes a cycle plus the wait states of its fetch and loads,
+    // a cycle lasts a system clock unless the CPU clock is scaled. When the CPU is found
+    // spinning in an idle loop it skips ahead to the next scheduled event
+    bool run(uint32_t cycleBudget, uint32_t &executedInstructions);
+    void addExecutionHook(uint32_t address);
+
+    void setExecutionMode(CPUExecutionMode mode);
+    CPUExecutionMode getExecutionMode();
+    void setLockstep(bool enabled);
+    bool isLockstepEnabled();
+    size_t basicBlockCount();
+    uint64_t invalidatedBasicBlockCount();
+    uint64_t recompiledBasicBlockCount();
+    void setIdleLoopSkipping(bool enabled);
+    // Overclocks or underclocks the CPU without touching the time base of the devices
+    void setClockPercentage(uint32_t percentage);
+    uint32_t getClockPercentage();
+    // Used by BIOS functions emulated natively in place of the instruction at their entry point
+    bool hasPendingDelaySlot();
+    void returnFromSubroutine(uint32_t returnValue);
+    uint64_t skippedIdleCycleCount();
     // GDB register naming and order used here:
     // r0-r31
     std::array<uint32_t, 32> getRegisters();
@@ -1,15 +1,73 @@
 #pragma once
 #include "CPU.hpp"
 #include "Interconnect.tcc"
+#include "Scheduler.tcc"
 
 template <typename T>
 inline T CPU::load(uint32_t address) const {
     static_assert(std::is_same<T, uint8_t>() || std::is_same<T, uint16_t>() || std::is_same<T, uint32_t>(), "Invalid type");
+    if (lockstepJournal != nullptr) {
+        if (lockstepJournal->isReplaying()) {
+            return lockstepJournal->replayLoad(address, sizeof(T));
+        }
+        T value = interconnect->load<T>(address);
+        lockstepJournal->recordLoad(address, sizeof(T), value);
+        return value;
+    }
     return interconnect->load<T>(address);
 }
 
+inline void CPU::advanceCycles(uint32_t cycles) {
+    cycleCount += cycles;
+    if (clockPercentage == 100) {
+        scheduler->advance(cycles);
+        return;
+    }
+    uint64_t scaledCycles = static_cast<uint64_t>(cycles) * 100 + clockRemainder;
+    scheduler->advance(scaledCycles / clockPercentage);
+    clockRemainder = scaledCycles % clockPercentage;
+}
+
+template <typename T>
+inline T CPU::loadData(uint32_t address) {
+    stallCycles += interconnect->loadCycles<T>(address);
+    return load<T>(address);
+}
+
 template <typename T>
 inline void CPU::store(uint32_t address, T value) const {
     static_assert(std::is_same<T, uint8_t>() || std::is_same<T, uint16_t>() || std::is_same<T, uint32_t>(), "Invalid type");
+    if (lockstepJournal != nullptr) {
+        if (lockstepJournal->isReplaying()) {
+            lockstepJournal->replayStore(address, sizeof(T), value);
+            return;
+        }
+        lockstepJournal->recordStore(address, sizeof(T), value);
+    }
     interconnect->store<T>(address, value);
 }
+
+template <typename Operation>
+inline void CPU::operationRegister(Instruction instruction) {
+    uint32_t value = Operation::apply(registerAtIndex(instruction.rs), registerAtIndex(instruction.rt));
+    setRegisterAtIndex(instruction.rd, value);
+}
+
+template <typename Operation, bool signExtend>
+inline void CPU::operationImmediate(Instruction instruction) {
+    uint32_t imm = signExtend ? instruction.immSE() : instruction.imm();
+    uint32_t value = Operation::apply(registerAtIndex(instruction.rs), imm);
+    setRegisterAtIndex(instruction.rt, value);
+}
+
+template <typename Operation>
+inline void CPU::operationShiftImmediate(Instruction instruction) {
+    uint32_t value = Operation::apply(registerAtIndex(instruction.rt), instruction.shiftimm);
+    setRegisterAtIndex(instruction.rd, value);
+}
+
+template <typename Operation>
+inline void CPU::operationShiftVariable(Instruction instruction) {
+    uint32_t value = Operation::apply(registerAtIndex(instruction.rt), registerAtIndex(instruction.rs) & 0x1f);
+    setRegisterAtIndex(instruction.rd, value);
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+enum CPUExecutionMode : uint8_t {
+    // Fetches and decodes every instruction through the Interconnect
+    Interpreter = 0,
+    // Decodes guest basic blocks once and executes the cached handlers
+    CachedInterpreter = 1,
+    // Translates guest basic blocks to native code, see Recompiler.hpp
+    DynamicRecompiler = 2,
+};
+
+CPUExecutionMode cpuExecutionModeWithValue(std::string value);
+std::string cpuExecutionModeName(CPUExecutionMode mode);
@@ -3,6 +3,8 @@
 #include <yaml/Yaml.hpp>
 #include <filesystem>
 #include "Logger.hpp"
+#include "CPUExecutionMode.hpp"
+#include "VSyncMode.hpp"
 
 class ConfigurationManager {
     static ConfigurationManager *instance;
@@ -12,6 +14,15 @@ class ConfigurationManager {
     std::string ctrllerName;
     bool resizeWindowToFitFramefuffer;
     bool showDebugInfoWindow;
+    CPUExecutionMode cpuMode;
+    bool cpuLockstep;
+    bool cpuIdleLoopSkipping;
+    uint32_t cpuClock;
+    bool biosHighLevelEmulation;
+    bool fastmem;
+    bool gpuThread;
+    bool throttle;
+    VSyncMode vsync;
 
     LogLevel bios;
     LogLevel cdrom;
@@ -35,6 +46,17 @@ public:
     std::string controllerName();
     bool shouldResizeWindowToFitFramebuffer();
     bool shouldShowDebugInfoWindow();
+    CPUExecutionMode cpuExecutionMode();
+    bool shouldRunCPUInLockstep();
+    bool shouldSkipCPUIdleLoops();
+    // Percentage of the original CPU clock
+    uint32_t cpuClockPercentage();
+    bool shouldEmulateBIOSFunctions();
+    bool shouldUseFastmem();
+    bool shouldRunGPUOnThread();
+    // Off runs frames as fast as the host allows
+    bool shouldThrottleFrames();
+    VSyncMode vsyncMode();
 
     LogLevel biosLogLevel();
     LogLevel cdromLogLevel();
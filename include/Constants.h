@@ -8,3 +8,7 @@ const uint32_t VideoSystemClocksPerScanline = 3413;
 // TODO: DotClock depends on the horizontal resolution
 const uint32_t VideoSystemClocksPerDot = 6;
 const uint32_t ScanlinesPerFrame = 263;
+const uint32_t SystemClocksPerVideoFrame = VideoSystemClocksPerScanline * ScanlinesPerFrame * 7 / 11;
+const uint32_t PALVideoSystemClocksPerScanline = 3406;
+const uint32_t PALScanlinesPerFrame = 314;
+const uint32_t PALSystemClocksPerVideoFrame = PALVideoSystemClocksPerScanline * PALScanlinesPerFrame * 7 / 11;
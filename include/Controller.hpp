@@ -4,6 +4,7 @@
 #include "Logger.hpp"
 #include "DigitalController.hpp"
 #include "InterruptController.hpp"
+#include "Scheduler.hpp"
 
 enum Device : uint8_t {
     NoDevice = 0x0,
@@ -153,8 +154,7 @@ class Controller {
     Logger logger;
 
     std::unique_ptr<InterruptController> &interruptController;
-    bool shouldCount;
-    uint32_t counter;
+    std::unique_ptr<Scheduler> &scheduler;
 
     std::unique_ptr<DigitalController> digitalController;
     Device currentDevice;
@@ -175,11 +175,11 @@ class Controller {
     uint32_t getStatusRegister();
     uint16_t getControlRegister();
 public:
-    Controller(LogLevel logLevel, std::unique_ptr<InterruptController> &interruptController);
+    Controller(LogLevel logLevel, std::unique_ptr<InterruptController> &interruptController, std::unique_ptr<Scheduler> &scheduler);
     ~Controller();
 
-    void step(uint32_t steps);
-    void updateInput();
+    void triggerAcknowledgeInterrupt();
+    void setSwitches(DigitalControllerSwitches switches);
 
     template <typename T>
     inline T load(uint32_t offset);
@@ -0,0 +1,19 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include "DigitalController.hpp"
+#include "Logger.hpp"
+
+// Digital switches of the first controller, read from the configured joystick or the keyboard
+class ControllerInput {
+    Logger logger;
+    SDL_Joystick *joystick;
+    DigitalControllerSwitches switches;
+
+    void updateWithJoystick();
+    void updateWithKeyboard();
+public:
+    ControllerInput(LogLevel logLevel);
+    ~ControllerInput();
+
+    DigitalControllerSwitches updateInput();
+};
@@ -213,7 +213,6 @@ class DMA {
 
     DMAControl control;
     DMAInterrupt interrupt;
-    bool shouldTriggerInterrupt;
 
     Channel channels[7];
     Channel& channelForPort(DMAPort port);
@@ -236,8 +235,6 @@ public:
     DMA(LogLevel logLevel, std::unique_ptr<RAM> &ram, std::unique_ptr<GPU> &gpu, std::unique_ptr<CDROM> &cdrom, std::unique_ptr<InterruptController> &interruptController);
     ~DMA();
 
-    void step();
-
     template <typename T>
     inline T load(uint32_t offset);
     template <typename T>
@@ -5,6 +5,7 @@
 #include <SDL2/SDL.h>
 #include <vector>
 #include <string>
+#include "EmulationStatistics.hpp"
 
 class DebugInfoRenderer {
     std::unique_ptr<Window> &debugWindow;
@@ -14,6 +15,6 @@ public:
     DebugInfoRenderer(std::unique_ptr<Window> &debugWindow);
     ~DebugInfoRenderer();
 
-    void update(std::vector<std::string> biosFunctionsLog);
+    void update(std::vector<std::string> biosFunctionsLog, const EmulationStatistics &statistics);
     void handleSDLEvent(SDL_Event event);
 };
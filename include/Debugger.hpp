@@ -5,9 +5,9 @@
 
 class CPU;
 
+// Breakpoints and watchpoints of one emulator. The GDB server is process-wide,
+// so only the first debugger to stop gets attached to it
 class Debugger {
-    static Debugger* instance;
-
     std::vector<uint32_t> breakpoints;
     std::vector<uint32_t> loadWatchpoints;
     std::vector<uint32_t> storeWatchpoints;
@@ -16,9 +16,9 @@ class Debugger {
     bool stopped;
     bool attached;
     bool step;
-    Debugger();
 public:
-    static Debugger* getInstance();
+    Debugger();
+    ~Debugger();
 
     void setCPU(CPU *cpu);
     CPU* getCPU();
@@ -1,7 +1,6 @@
 #pragma once
 #include <cstdint>
 #include "Logger.hpp"
-#include <SDL2/SDL.h>
 
 /*
 Standard Controllers
@@ -74,13 +73,9 @@ enum CommunicationSequenceStage : uint8_t {
 
 class DigitalController {
     Logger logger;
-    SDL_Joystick *joystick;
     CommunicationSequenceStage currentStage;
     uint16_t identifier;
     DigitalControllerSwitches switches;
-
-    void updateWithJoystick();
-    void updateWithKeyboard();
 public:
     DigitalController(LogLevel logLevel);
     ~DigitalController();
@@ -88,5 +83,5 @@ public:
     uint8_t getResponse(uint8_t value);
     CommunicationSequenceStage getCurrentStage();
     bool getAcknowledge();
-    void updateInput();
+    void setSwitches(DigitalControllerSwitches switches);
 };
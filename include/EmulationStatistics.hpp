@@ -0,0 +1,63 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct BIOSFunctionStatistics {
+    std::string name;
+    uint64_t calls;
+    // Estimated guest instructions the kernel would have executed
+    uint64_t skippedInstructions;
+};
+
+// Host frame times, in milliseconds, over the last second
+struct FramePacingStatistics {
+    bool throttled;
+    double targetFrameTime;
+    double averageFrameTime;
+    // Standard deviation from the target frame time
+    double frameTimeJitter;
+    double maximumFrameTimeDeviation;
+    // Frames that ended past their deadline since the start
+    uint64_t lateFrames;
+};
+
+// Vertex batches flushed during the last frame, by what forced them out
+struct RendererStatistics {
+    uint64_t drawCalls;
+    uint64_t flushes;
+    uint64_t bufferFullFlushes;
+    uint64_t frameEndFlushes;
+    uint64_t vramReadFlushes;
+    uint64_t imageLoadFlushes;
+};
+
+struct IOPortStatistics {
+    std::string device;
+    uint32_t address;
+    uint64_t loads;
+    uint64_t stores;
+};
+
+struct EmulationStatistics {
+    std::string cpuExecutionMode;
+    // Guest instructions executed per host second, averaged over the last second
+    double emulatedMHz;
+    // Guest instructions executed per emulated second, which follows the CPU clock
+    double guestMIPS;
+    uint32_t cpuClockPercentage;
+    uint64_t executedInstructions;
+    uint64_t cachedBasicBlocks;
+    uint64_t invalidatedBasicBlocks;
+    uint64_t recompiledBasicBlocks;
+    // CPU cycles fast-forwarded in idle loops during the last frame
+    uint64_t skippedIdleCycles;
+    bool biosHighLevelEmulation;
+    std::vector<BIOSFunctionStatistics> biosFunctions;
+    bool cpuLockstep;
+    // Most accessed I/O ports since power on
+    std::vector<IOPortStatistics> ioPorts;
+    RendererStatistics renderer;
+    // Filled by whoever paces the frames
+    FramePacingStatistics framePacing;
+};
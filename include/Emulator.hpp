@@ -1,71 +1,123 @@
 #pragma once
 #include <memory>
 #include <filesystem>
-#include "CPU.hpp"
-#include "COP0.hpp"
-#include "Interconnect.hpp"
-#include "BIOS.hpp"
-#include "RAM.hpp"
-#include "GPU.hpp"
-#include "DMA.hpp"
-#include "Scratchpad.hpp"
-#include "CDROM.hpp"
-#include "InterruptController.hpp"
-#include "Expansion1.hpp"
-#include "Timer.hpp"
-#include "Window.hpp"
-#include <SDL2/SDL.h>
-#include "DebugInfoRenderer.hpp"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
 #include <vector>
-#include "Controller.hpp"
 #include <string>
+#include <chrono>
+#include <SDL2/SDL.h>
+#include "Machine.hpp"
+#include "Window.hpp"
+#include "Renderer.hpp"
+#include "FramePacer.hpp"
+#include "DebugInfoRenderer.hpp"
+#include "ControllerInput.hpp"
 #include "Logger.hpp"
-#include "SPU.hpp"
 
+class EmulatorRunner;
+
+// Requests from the main thread that change the machine, run between frames
+enum EmulatorCommand {
+    DebugCommand,
+    CycleCPUExecutionModeCommand,
+    ToggleCPULockstepCommand,
+    CycleCPUClockCommand,
+    ToggleThrottleCommand
+};
+
+struct TimedControllerSwitches {
+    std::chrono::steady_clock::time_point time;
+    DigitalControllerSwitches switches;
+};
+
+/*
+SDL front-end over a Machine: windows, the OpenGL renderer, the debug info
+window and keyboard or joystick input. Several headless emulators can run side
+by side on different threads, SDL windows and OpenGL contexts belong to the
+main thread
+
+With windows the machine runs on an emulation thread, paced by a FramePacer,
+while the main thread polls events and input and presents finished frames, so
+neither waits on the other. Input is sampled with the time it changed and lands
+at the matching point of the next emulated frame.
+*/
 class Emulator {
     Logger logger;
+    EmulatorRunner *emulatorRunner;
     std::unique_ptr<Window> mainWindow;
     std::unique_ptr<Window> debugWindow;
 
     std::unique_ptr<DebugInfoRenderer> debugInfoRenderer;
+    std::unique_ptr<ControllerInput> controllerInput;
 
-    std::unique_ptr<CPU> cpu;
-    std::unique_ptr<COP0> cop0;
-    std::unique_ptr<Interconnect> interconnect;
-    std::unique_ptr<BIOS> bios;
-    std::unique_ptr<RAM> ram;
-    std::unique_ptr<GPU> gpu;
-    std::unique_ptr<DMA> dma;
-    std::unique_ptr<Scratchpad> scratchpad;
-    std::unique_ptr<CDROM> cdrom;
-    std::unique_ptr<InterruptController> interruptController;
-    std::unique_ptr<Expansion1> expansion1;
-    std::unique_ptr<Timer0> timer0;
-    std::unique_ptr<Timer1> timer1;
-    std::unique_ptr<Timer2> timer2;
-    std::unique_ptr<Controller> controller;
-    std::unique_ptr<SPU> spu;
-
-    std::string ttyBuffer;
-    std::vector<std::string> biosFunctionsLog;
+    std::unique_ptr<Machine> machine;
+    // Owned by the machine, presented from the main thread
+    Renderer *renderer;
 
     bool showDebugInfoWindow;
-    bool logBiosFunctionCalls;
 
-    void checkBIOSFunctions();
-    void checkTTY(char c);
+    bool headless;
+    uint32_t frameLimit;
+
+    FramePacer framePacer;
+    std::thread emulationThread;
+    std::atomic<bool> stopRequested;
+    std::atomic<bool> emulationFinished;
+
+    // Main thread to emulation thread
+    std::mutex inputMutex;
+    std::deque<TimedControllerSwitches> pendingControllerSwitches;
+    std::deque<EmulatorCommand> pendingCommands;
+    DigitalControllerSwitches lastControllerSwitches;
+
+    // Emulation thread to main thread
+    std::mutex frameMutex;
+    std::condition_variable frameCondition;
+    uint64_t completedFrames;
+    uint64_t presentedFrames;
+    EmulationStatistics statistics;
+    std::vector<std::string> biosFunctionsLog;
+
     void setupSDL();
     void setupOpenGL();
+    void runEmulationThread();
+    void runCommand(EmulatorCommand command);
+    void postCommand(EmulatorCommand command);
+    void runPendingCommands();
+    void queueControllerSwitches(std::chrono::steady_clock::time_point intervalStart, std::chrono::steady_clock::time_point intervalEnd);
+    void publishFrame();
 public:
-    Emulator();
+    Emulator(EmulatorRunner *emulatorRunner);
     ~Emulator();
 
+    Machine* getMachine();
     CPU* getCPU();
+    Debugger* getDebugger();
     void emulateFrame();
-    void transferToRAM(std::filesystem::path filePath, uint32_t origin, uint32_t size, uint32_t destination);
+    void startEmulationThread();
+    void stopEmulationThread();
+    // Main thread, while the emulation thread runs
+    void pollInput();
+    bool waitForFrame(std::chrono::steady_clock::duration timeout);
+    void presentFrame();
+    void debug();
     void dumpRAM();
     void handleSDLEvent(SDL_Event event);
     bool shouldTerminate();
+    bool isHeadless();
+    uint64_t emulatedFrameCount();
+    uint64_t executedInstructionCount();
+    // 1 when the machine failed, the guest exit code otherwise
+    uint32_t getExitCode();
     void toggleDebugInfoWindow();
+    void cycleCPUExecutionMode();
+    void toggleCPULockstep();
+    void cycleCPUClock();
+    void toggleThrottle();
     void loadCDROMImageFile(std::filesystem::path filePath);
+    void loadExecutable(std::filesystem::path filePath);
 };
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <array>
+#include "RAM.hpp"
+#include "Scratchpad.hpp"
+#include "BIOS.hpp"
+#include "Logger.hpp"
+
+// Faulting accesses are decoded from x86-64 code and the host page size has to
+// match RAM code pages, which Linux on x86-64 guarantees
+#if defined(__linux__) && defined(__x86_64__)
+#define RUBY_FASTMEM_SUPPORTED 1
+#else
+#define RUBY_FASTMEM_SUPPORTED 0
+#endif
+
+const uint64_t FASTMEM_REGION_SIZE = 0x100000000;
+
+class Interconnect;
+
+/*
+Host mapping of the whole guest address space
+
+A 4GB region is reserved so every guest address is host base + address. RAM
+(with its mirrors), scratchpad and BIOS are mapped into it through their
+SharedMemory in KUSEG, KSEG0 and KSEG1, everything else is left inaccessible.
+The scratchpad takes a whole host page, so the 3K after it read as memory.
+
+Recompiled code accesses memory with a single host instruction. Accesses to
+guarded pages (I/O ports, BIOS writes, RAM code pages and RAM while the cache
+is isolated) raise SIGSEGV, the handler decodes the faulting instruction,
+runs the access through the Interconnect and resumes after it. The handler is
+shared by every emulator in the process and installed while any region exists.
+*/
+class Fastmem {
+    Logger logger;
+    Interconnect *interconnect;
+    uint8_t *base;
+    std::array<bool, RAM_CODE_PAGE_COUNT> writeProtectedRAMPages;
+    bool isCacheIsolated;
+
+    bool mapMemory(uint32_t address, const SharedMemory &memory, uint32_t size, bool isWritable);
+    void protectRAM(uint32_t offset, uint32_t size, bool isWritable);
+public:
+    Fastmem(LogLevel logLevel, Interconnect *interconnect, const RAM &ram, const Scratchpad &scratchpad, const BIOS &bios);
+    ~Fastmem();
+
+    static bool isSupported();
+    bool isEnabled() const;
+    uint8_t* getBase() const;
+    bool isMapped(uint32_t address) const;
+
+    void setRAMCodePageWriteProtected(uint32_t offset, bool isWriteProtected);
+    void setCacheIsolated(bool isIsolated);
+    bool handleFault(uintptr_t faultAddress, uint64_t &accumulator, uint64_t &instructionPointer);
+};
@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+#include <chrono>
+#include "EmulationStatistics.hpp"
+
+/*
+Keeps emulated frames in step with the host clock
+
+Each frame is due as long after the previous one as the system clocks it
+emulated would take on the console, so PAL frames get paced at 50 Hz and
+NTSC ones at 60 Hz. The pacer sleeps until shortly before the deadline and
+spins the rest, the margin follows how late the host wakes the thread up.
+Deadlines advance from the previous deadline, not from when the frame
+finished, so waiting doesn't drift. After falling behind by more than a few
+frames the timeline starts over instead of running frames back to back to
+catch up. Unthrottled, frames run as fast as they can, which is what
+benchmarks want.
+*/
+class FramePacer {
+    bool throttled;
+    std::chrono::steady_clock::time_point previousDeadline;
+    std::chrono::steady_clock::time_point deadline;
+    std::chrono::steady_clock::duration spinMargin;
+    std::chrono::steady_clock::time_point lastFrameEnd;
+
+    FramePacingStatistics statistics;
+    uint32_t measuredFrames;
+    double measuredFrameTime;
+    double measuredSquaredDeviation;
+    double measuredMaximumDeviation;
+
+    void sleepUntil(std::chrono::steady_clock::time_point time);
+    void measureFrame(std::chrono::steady_clock::duration frameTime, std::chrono::steady_clock::duration targetFrameTime);
+public:
+    FramePacer();
+    ~FramePacer();
+
+    void setThrottled(bool throttled);
+    bool isThrottled() const;
+    // Starts a new timeline from now, after emulation was paused
+    void reset();
+    // Waits until the next frame is due, given the system clocks the last one emulated
+    void waitForNextFrame(uint64_t emulatedClocks);
+    // Host time the current frame covers, from the previous deadline to the current one
+    std::chrono::steady_clock::time_point frameIntervalStart() const;
+    std::chrono::steady_clock::time_point frameIntervalEnd() const;
+    const FramePacingStatistics& getStatistics() const;
+};
@@ -2,10 +2,15 @@
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <thread>
+#include <atomic>
+#include <array>
+#include <utility>
 #include "GPUInstructionBuffer.hpp"
-#include "Renderer.hpp"
+#include "GPUCommandRing.hpp"
+#include "GPUBackend.hpp"
 #include "GPUImageBuffer.hpp"
-#include "Window.hpp"
+#include "Vertex.hpp"
 #include "Logger.hpp"
 
 enum TexturePageColors {
@@ -46,6 +51,15 @@ enum GP0Mode {
     ImageLoad = 1
 };
 
+class GPU;
+
+// Words a GP0 command takes, the command word included, and what runs once they arrived
+struct GP0Operation {
+    // Poly-lines take -1, they run until the termination code
+    int32_t words;
+    void (GPU::*method)();
+};
+
 /*
 1F801814h - GPUSTAT - GPU Status Register (R)
 0-3   Texture page X Base   (N*64)                              ;GP0(E1h).0-3
@@ -144,16 +158,31 @@ GP1(07h) - Vertical Display range (on Screen)
     GPUInstructionBuffer gp0InstructionBuffer;
     int32_t gp0WordsRemaining;
     uint32_t gp0WordsRead;
-    std::function<void(void)> gp0InstructionMethod;
+    void (GPU::*gp0InstructionMethod)();
 
     uint32_t gpuRead;
 
     GP0Mode gp0Mode;
 
-    std::unique_ptr<Renderer> renderer;
+    std::unique_ptr<GPUBackend> renderer;
 
     std::unique_ptr<GPUImageBuffer> imageBuffer;
 
+/*
+Threaded mode
+
+GP0 and GP1 words go through the command ring and run on the GPU thread, which
+also owns the backend. GPUSTAT is published by the GPU thread after every word
+that can change it, and the emulation thread remembers how many words it had
+pushed up to the last of those, so a status read only waits for that word and
+not for the drawing queued after it.
+*/
+    std::unique_ptr<GPUCommandRing> commandRing;
+    std::thread thread;
+    std::function<void(void)> threadCall;
+    std::atomic<uint32_t> publishedStatus;
+    uint64_t statusCommandCount;
+
     void operationGp0Nop();
     void operationGp0DrawMode();
     void operationGp0SetDrawingAreaTopLeft();
@@ -165,67 +194,21 @@ GP1(07h) - Vertical Display range (on Screen)
     void operationGp0CopyRectangleCPUToVRAM();
     void operationGp0CopyRectangleVRAMToCPU();
 
-    void operationGp0MonochromeThreePointOpaque();
-    void operationGp0MonochromeThreePointSemiTransparent();
-    void operationGp0MonochromeFourPointOpaque();
-    void operationGp0MonochromeFourPointSemiTransparent();
-
-    void operationGp0TexturedThreePointOpaqueTextureBlending();
-    void operationGp0TexturedThreePointOpaqueRawTexture();
-    void operationGp0TexturedThreePointSemiTransparentTextureBlending();
-    void operationGp0TexturedThreePointSemiTransparentRawTexture();
-    void operationGp0TexturedFourPointOpaqueTextureBlending();
-    void operationGp0TexturedFourPointOpaqueRawTexture();
-    void operationGp0TexturedFourPointSemiTransparentTextureBlending();
-    void operationGp0TexturedFourPointSemiTransparentRawTexture();
-
-    void operationGp0ShadedThreePointOpaque();
-    void operationGp0ShadedThreePointSemiTransparent();
-    void operationGp0ShadedFourPointOpaque();
-    void operationGp0ShadedFourPointSemiTransparent();
-
-    void operationGp0TexturedShadedThreePointOpaqueTextureBlending();
-    void operationGp0TexturedShadedThreePointSemiTransparentTextureBlending();
-    void operationGp0TexturedShadedFourPointOpaqueTextureBlending();
-    void operationGp0TexturedShadedFourPointSemiTransparentTextureBlending();
-
     void operationGp0FillRectagleInVRAM();
 
-    void operationGp0MonochromeLineOpaque();
-    void operationGp0MonochromeLineSemiTransparent();
-    void operationGp0MonochromePolylineOpaque();
-    void operationGp0MonochromePolylineSemiTransparent();
-
-    void operationGp0ShadedLineOpaque();
-    void operationGp0ShadedLineSemiTransparent();
-    void operationGp0ShadedPolylineOpaque();
-    void operationGp0ShadedPolylineSemiTransparent();
+    template <uint8_t opCode>
+    void operationGp0Polygon();
+    template <uint8_t opCode>
+    void operationGp0Line();
+    template <uint8_t opCode>
+    void operationGp0Rectangle();
+    void operationGp0Unhandled();
 
-    void operationGp0MonochromeQuadOpaque();
-    void operationGp0MonochromeQuadSemiTransparent();
-    void operationGp0MonochromeQuad1x1Opaque();
-    void operationGp0MonochromeQuad1x1SemiTransparent();
-    void operationGp0MonochromeQuad8x8Opaque();
-    void operationGp0MonochromeQuad8x8SemiTransparent();
-    void operationGp0MonochromeQuad16x16Opaque();
-    void operationGp0MonochromeQuad16x16SemiTransparent();
-
-    void operationGp0TexturedQuadOpaqueTextureBlending();
-    void operationGp0TexturedQuadOpaqueRawTexture();
-    void operationGp0TexturedSemiTransparentOpaqueTextureBlending();
-    void operationGp0TexturedSemiTransparentOpaqueRawTexture();
-    void operationGp0TexturedQuad1x1OpaqueTextureBlending();
-    void operationGp0TexturedQuad1x1OpaqueRawTexture();
-    void operationGp0TexturedQuad1x1SemiTransparentTextureBlending();
-    void operationGp0TexturedQuad1x1SemiTransparentRawTexture();
-    void operationGp0TexturedQuad8x8OpaqueTextureBlending();
-    void operationGp0TexturedQuad8x8OpaqueRawTexture();
-    void operationGp0TexturedQuad8x8SemiTransparentTextureBlending();
-    void operationGp0TexturedQuad8x8SemiTransparentRawTexture();
-    void operationGp0TexturedQuad16x16OpaqueTextureBlending();
-    void operationGp0TexturedQuad16x16OpaqueRawTexture();
-    void operationGp0TexturedQuad16x16SemiTransparentTextureBlending();
-    void operationGp0TexturedQuad16x16SemiTransparentRawTexture();
+    template <uint8_t opCode>
+    static constexpr GP0Operation gp0OperationFor();
+    template <size_t... opCodes>
+    static constexpr std::array<GP0Operation, 256> makeGp0Operations(std::index_sequence<opCodes...>);
+    static const std::array<GP0Operation, 256> gp0Operations;
 
     void operationGp1Reset(uint32_t value);
     void operationGp1DisplayMode(uint32_t value);
@@ -250,20 +233,35 @@ GP1(07h) - Vertical Display range (on Screen)
     void monochromeLine(unsigned int numberOfPoints, bool opaque);
     void shadedLine(unsigned int numberOfPoints, bool opaque);
 
+    void executeGp0(uint32_t value);
     void executeGp1(uint32_t value);
+    void renderFrame();
+    void runThread(FatalErrorState *fatalErrorState);
+    void runOnThread(std::function<void(void)> call);
+    void synchronize();
     TexturePageColors texturePageColorsWithValue(uint32_t value) const;
     uint8_t horizontalResolutionFromValues(uint8_t value1, uint8_t value2) const;
 public:
-    GPU(LogLevel logLevel, std::unique_ptr<Window> &mainWindow);
+    GPU(LogLevel logLevel);
     ~GPU();
+
+    void setRenderer(std::unique_ptr<GPUBackend> renderer);
+    void setThreaded(bool threaded);
+    bool isThreaded() const;
+    void attachRendererToCurrentThread();
+    void detachRendererFromCurrentThread();
     template <typename T>
-    inline T load(uint32_t offset) const;
+    inline T load(uint32_t offset);
     template <typename T>
     inline void store(uint32_t offset, T value);
 
-    // TODO: should be private
-    void executeGp0(uint32_t value);
+    inline void writeGp0(uint32_t value);
+    inline void writeGp1(uint32_t value);
+    // Draws the frame, waiting for the GPU thread to be done with it when threaded
     void render();
+    VideoMode currentVideoMode();
     Dimensions getResolution();
     Point getDisplayAreaStart();
+    bool readVRAM(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t *pixels);
+    RendererStatistics rendererStatistics();
 };
@@ -1,17 +1,23 @@
 #pragma once
 #include "GPU.hpp"
+#include "GPUCommandRing.tcc"
 
 template <typename T>
-inline T GPU::load(uint32_t offset) const {
+inline T GPU::load(uint32_t offset) {
     static_assert(std::is_same<T, uint8_t>() || std::is_same<T, uint16_t>() || std::is_same<T, uint32_t>(), "Invalid type");
     if (sizeof(T) != 4) {
         logger.logError("Unsupported GPU read with size: %d", sizeof(T));
     }
     switch (offset) {
         case 0: {
+            synchronize();
             return readRegister();
         }
         case 4: {
+            if (commandRing) {
+                commandRing->waitUntilPopped(statusCommandCount);
+                return publishedStatus.load(std::memory_order_acquire);
+            }
             return statusRegister();
         }
         default: {
@@ -29,11 +35,11 @@ inline void GPU::store(uint32_t offset, T value) {
     }
     switch (offset) {
         case 0: {
-            executeGp0(value);
+            writeGp0(value);
             break;
         }
         case 4: {
-            executeGp1(value);
+            writeGp1(value);
             break;
         }
         default: {
@@ -42,3 +48,158 @@ inline void GPU::store(uint32_t offset, T value) {
         }
     }
 }
+
+// Only E1h and E6h change GPUSTAT, a parameter word that happens to look like them just costs a wait
+inline bool isStatusGp0Word(uint32_t value) {
+    uint32_t opcode = value >> 24;
+    return opcode == 0xe1 || opcode == 0xe6;
+}
+
+inline void GPU::writeGp0(uint32_t value) {
+    if (!commandRing) {
+        executeGp0(value);
+        return;
+    }
+    if (isStatusGp0Word(value)) {
+        statusCommandCount = commandRing->pushedCount() + 1;
+    }
+    commandRing->push(GPUCommandKind::GP0Command, value);
+}
+
+inline void GPU::writeGp1(uint32_t value) {
+    if (!commandRing) {
+        executeGp1(value);
+        return;
+    }
+    statusCommandCount = commandRing->pushedCount() + 1;
+    commandRing->push(GPUCommandKind::GP1Command, value);
+}
+
+/*
+GP0(20h..3Fh) - Polygons
+0     Raw texture, the color is ignored            (textured only)
+1     Semi-transparent
+2     Textured, a Texcoord word follows each vertex
+3     Four points, otherwise three
+4     Gouraud shaded, a Color word precedes each vertex after the first
+The first texcoord carries the palette (CLUT) and the second the texture page.
+*/
+template <uint8_t opCode>
+void GPU::operationGp0Polygon() {
+    constexpr unsigned int numberOfPoints = (opCode & 0x08) ? 4 : 3;
+    constexpr bool opaque = !(opCode & 0x02);
+    constexpr TextureBlendMode textureBlendMode = (opCode & 0x01) ? TextureBlendModeRawTexture : TextureBlendModeTextureBlend;
+    if constexpr ((opCode & 0x10) && (opCode & 0x04)) {
+        shadedTexturedPolygon(numberOfPoints, opaque, textureBlendMode);
+    } else if constexpr (opCode & 0x10) {
+        shadedPolygon(numberOfPoints, opaque);
+    } else if constexpr (opCode & 0x04) {
+        texturedPolygon(numberOfPoints, opaque, textureBlendMode);
+    } else {
+        monochromePolygon(numberOfPoints, opaque);
+    }
+}
+
+/*
+GP0(40h..5Fh) - Lines
+1     Semi-transparent
+3     Poly-line, vertices follow until the Termination Code (55555555h)
+4     Gouraud shaded, a Color word precedes each vertex after the first
+*/
+template <uint8_t opCode>
+void GPU::operationGp0Line() {
+    constexpr bool opaque = !(opCode & 0x02);
+    constexpr bool polyline = opCode & 0x08;
+    if constexpr (opCode & 0x10) {
+        shadedLine(polyline ? (gp0WordsRead - 1) / 2 : 2, opaque);
+    } else {
+        monochromeLine(polyline ? gp0WordsRead - 2 : 2, opaque);
+    }
+}
+
+/*
+GP0(60h..7Fh) - Rectangles
+0     Raw texture, the color is ignored            (textured only)
+1     Semi-transparent
+2     Textured, a Texcoord+Palette word follows the vertex
+3-4   Size (0=variable, 1=1x1, 2=8x8, 3=16x16), variable ones end with Width+Height
+*/
+template <uint8_t opCode>
+void GPU::operationGp0Rectangle() {
+    constexpr bool opaque = !(opCode & 0x02);
+    constexpr bool textured = opCode & 0x04;
+    constexpr uint8_t size = (opCode >> 3) & 0x3;
+    constexpr TextureBlendMode textureBlendMode = (opCode & 0x01) ? TextureBlendModeRawTexture : TextureBlendModeTextureBlend;
+    Dimensions dimensions = Dimensions(1, 1);
+    if constexpr (size == 0) {
+        dimensions = Dimensions(gp0InstructionBuffer[textured ? 3 : 2]);
+    } else if constexpr (size == 2) {
+        dimensions = Dimensions(8, 8);
+    } else if constexpr (size == 3) {
+        dimensions = Dimensions(16, 16);
+    }
+    if constexpr (textured) {
+        texturedQuad(dimensions, opaque, textureBlendMode);
+    } else {
+        quad(dimensions, opaque);
+    }
+}
+
+template <uint8_t opCode>
+constexpr GP0Operation GPU::gp0OperationFor() {
+    constexpr bool textured = opCode & 0x04;
+    constexpr bool shaded = opCode & 0x10;
+    if constexpr (opCode >= 0x20 && opCode <= 0x3f) {
+        constexpr int32_t numberOfPoints = (opCode & 0x08) ? 4 : 3;
+        return { numberOfPoints * (textured ? 2 : 1) + (shaded ? numberOfPoints : 1), &GPU::operationGp0Polygon<opCode> };
+    } else if constexpr (opCode >= 0x40 && opCode <= 0x5f) {
+        return { (opCode & 0x08) ? -1 : (shaded ? 4 : 3), &GPU::operationGp0Line<opCode> };
+    } else if constexpr (opCode >= 0x60 && opCode <= 0x7f) {
+        constexpr bool variableSize = ((opCode >> 3) & 0x3) == 0;
+        return { 2 + (textured ? 1 : 0) + (variableSize ? 1 : 0), &GPU::operationGp0Rectangle<opCode> };
+    }
+    switch (opCode) {
+        case 0x00: {
+            return { 1, &GPU::operationGp0Nop };
+        }
+        case 0x01: {
+            return { 1, &GPU::operationGp0ClearCache };
+        }
+        case 0x02: {
+            return { 3, &GPU::operationGp0FillRectagleInVRAM };
+        }
+        case 0xa0: {
+            return { 3, &GPU::operationGp0CopyRectangleCPUToVRAM };
+        }
+        case 0xc0: {
+            return { 3, &GPU::operationGp0CopyRectangleVRAMToCPU };
+        }
+        case 0xe1: {
+            return { 1, &GPU::operationGp0DrawMode };
+        }
+        case 0xe2: {
+            return { 1, &GPU::operationGp0TextureWindowSetting };
+        }
+        case 0xe3: {
+            return { 1, &GPU::operationGp0SetDrawingAreaTopLeft };
+        }
+        case 0xe4: {
+            return { 1, &GPU::operationGp0SetDrawingAreaBottomRight };
+        }
+        case 0xe5: {
+            return { 1, &GPU::operationGp0SetDrawingOffset };
+        }
+        case 0xe6: {
+            return { 1, &GPU::operationGp0MaskBitSetting };
+        }
+        default: {
+            return { 1, &GPU::operationGp0Unhandled };
+        }
+    }
+}
+
+// Every opcode gets its entry at compile time, primitives with their own handler
+template <size_t... opCodes>
+constexpr std::array<GP0Operation, 256> GPU::makeGp0Operations(std::index_sequence<opCodes...>) {
+    return {{ gp0OperationFor<opCodes>()... }};
+}
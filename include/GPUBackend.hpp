@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include "Vertex.hpp"
+#include "GPUImageBuffer.hpp"
+#include "EmulationStatistics.hpp"
+
+class GPU;
+
+const uint32_t GPU_POLYGON_MAXIMUM_VERTICES = 4;
+
+/*
+Rasterizer behind the GPU
+
+The GPU only decodes GP0 and GP1 commands, what gets drawn goes to a backend
+like the OpenGL Renderer. Without one (headless, or embedded where nobody looks
+at the picture) draw commands are decoded and dropped.
+*/
+class GPUBackend {
+public:
+    virtual ~GPUBackend() {}
+
+    // Vertices are only read during the call, so they can live on the caller's stack
+    virtual void pushLine(const Vertex *vertices, unsigned int count) = 0;
+    virtual void pushPolygon(const Vertex *vertices, unsigned int count) = 0;
+    virtual void setDrawingOffset(int16_t x, int16_t y) = 0;
+    virtual void prepareFrame() = 0;
+    virtual void renderFrame() = 0;
+    virtual void finalizeFrame(GPU *gpu) = 0;
+    virtual void loadImage(std::unique_ptr<GPUImageBuffer> &imageBuffer) = 0;
+    // Copies a VRAM rectangle as 15 bit pixels, false when it can't be read back
+    virtual bool readVRAM(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t *pixels) = 0;
+    // A threaded GPU draws from its own thread, which takes the backend over while it runs
+    virtual void attachToCurrentThread() {}
+    virtual void detachFromCurrentThread() {}
+    // Safe to call from any thread
+    virtual RendererStatistics lastFrameStatistics() { return RendererStatistics(); }
+};
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+
+enum GPUCommandKind : uint8_t {
+    GP0Command,
+    GP1Command,
+    RenderCommand,
+    CallCommand,
+    StopCommand
+};
+
+struct GPUCommand {
+    GPUCommandKind kind;
+    uint32_t value;
+};
+
+const uint64_t GPU_COMMAND_RING_SIZE = 1 << 16;
+
+/*
+Single producer, single consumer queue from the emulation thread to the GPU thread
+
+Both indices only grow and get masked into the ring. A command is popped after it
+has been executed, so waiting for an index means waiting for its effects. Neither
+side locks while there is work, the GPU thread only sleeps on the condition
+variable after the ring has been empty for a while.
+*/
+class GPUCommandRing {
+    std::vector<GPUCommand> commands;
+    alignas(64) std::atomic<uint64_t> writeIndex;
+    alignas(64) std::atomic<uint64_t> readIndex;
+    alignas(64) std::atomic<bool> isConsumerSleeping;
+    std::mutex mutex;
+    std::condition_variable condition;
+
+    void waitForCommand();
+    void wakeConsumer();
+public:
+    GPUCommandRing();
+    ~GPUCommandRing();
+
+    // Emulation thread
+    inline void push(GPUCommandKind kind, uint32_t value);
+    inline uint64_t pushedCount() const;
+    void waitUntilPopped(uint64_t count);
+
+    // GPU thread
+    inline GPUCommand front();
+    inline void pop();
+};
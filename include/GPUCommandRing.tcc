@@ -0,0 +1,31 @@
+#pragma once
+#include "GPUCommandRing.hpp"
+
+inline void GPUCommandRing::push(GPUCommandKind kind, uint32_t value) {
+    uint64_t index = writeIndex.load(std::memory_order_relaxed);
+    if (index - readIndex.load(std::memory_order_acquire) == GPU_COMMAND_RING_SIZE) {
+        waitUntilPopped(index - GPU_COMMAND_RING_SIZE + 1);
+    }
+    commands[index & (GPU_COMMAND_RING_SIZE - 1)] = { kind, value };
+    // Paired with the consumer going to sleep, one of the two always sees the other
+    writeIndex.store(index + 1, std::memory_order_seq_cst);
+    if (isConsumerSleeping.load(std::memory_order_seq_cst)) {
+        wakeConsumer();
+    }
+}
+
+inline uint64_t GPUCommandRing::pushedCount() const {
+    return writeIndex.load(std::memory_order_relaxed);
+}
+
+inline GPUCommand GPUCommandRing::front() {
+    uint64_t index = readIndex.load(std::memory_order_relaxed);
+    if (index == writeIndex.load(std::memory_order_acquire)) {
+        waitForCommand();
+    }
+    return commands[index & (GPU_COMMAND_RING_SIZE - 1)];
+}
+
+inline void GPUCommandRing::pop() {
+    readIndex.store(readIndex.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
@@ -2,7 +2,39 @@
 #include <string>
 #include <cstdint>
 #include <filesystem>
+#include <cstring>
+#include <type_traits>
 
 void readBinary(const std::filesystem::path& filePath, uint8_t *data, uint32_t atOrigin, int64_t size);
 void readBinary(const std::filesystem::path& filePath, uint8_t *data);
 uint8_t decimalFromBCDEncodedInt(uint8_t bcdEncoded);
+
+// Guest memory is little endian, so on little endian hosts these are a single
+// (possibly unaligned) host load or store
+template <typename T>
+inline T loadLittleEndian(const uint8_t *data) {
+    static_assert(std::is_same<T, uint8_t>() || std::is_same<T, uint16_t>() || std::is_same<T, uint32_t>(), "Invalid type");
+    T value;
+    memcpy(&value, data, sizeof(T));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    if constexpr (sizeof(T) == 2) {
+        value = __builtin_bswap16(value);
+    } else if constexpr (sizeof(T) == 4) {
+        value = __builtin_bswap32(value);
+    }
+#endif
+    return value;
+}
+
+template <typename T>
+inline void storeLittleEndian(uint8_t *data, T value) {
+    static_assert(std::is_same<T, uint8_t>() || std::is_same<T, uint16_t>() || std::is_same<T, uint32_t>(), "Invalid type");
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    if constexpr (sizeof(T) == 2) {
+        value = __builtin_bswap16(value);
+    } else if constexpr (sizeof(T) == 4) {
+        value = __builtin_bswap32(value);
+    }
+#endif
+    memcpy(data, &value, sizeof(T));
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <string>
+#include <optional>
+#include <array>
+#include "CPU.hpp"
+#include "Logger.hpp"
+#include "EmulationStatistics.hpp"
+
+/*
+High level emulation of BIOS kernel functions
+
+Calls to 0xA0, 0xB0 and 0xC0 with the function number in r9 are caught right
+before the dispatcher runs. The functions below have no side effects other
+than on the memory they are given, so they are run natively and the CPU goes
+straight back to ra with the result in v0, as the kernel would.
+
+Calls that can't be handled (e.g. a load still pending in the delay slot of
+the call) are left to the real BIOS.
+*/
+class HighLevelBIOS {
+    Logger logger;
+    std::unique_ptr<CPU> &cpu;
+    std::vector<BIOSFunctionStatistics> functions;
+
+    std::optional<uint32_t> callAFunction(uint32_t r9, std::array<uint32_t, 4> subroutineArguments, BIOSFunctionStatistics *&function);
+    std::optional<uint32_t> callBFunction(uint32_t r9, std::array<uint32_t, 4> subroutineArguments, BIOSFunctionStatistics *&function);
+
+    BIOSFunctionStatistics* statisticsForFunction(std::string name, uint32_t processedBytes);
+
+    uint32_t stringCompare(uint32_t str1, uint32_t str2, uint32_t &processedBytes);
+    uint32_t stringCopy(uint32_t dst, uint32_t src, uint32_t &processedBytes);
+    uint32_t stringLength(uint32_t src, uint32_t &processedBytes);
+    uint32_t zeroMemory(uint32_t dst, uint32_t len, uint32_t &processedBytes);
+    uint32_t copyMemory(uint32_t dst, uint32_t src, uint32_t len, uint32_t &processedBytes);
+    uint32_t setMemory(uint32_t dst, uint32_t fillbyte, uint32_t len, uint32_t &processedBytes);
+public:
+    HighLevelBIOS(LogLevel logLevel, std::unique_ptr<CPU> &cpu);
+    ~HighLevelBIOS();
+
+    // Returns true when the function was run natively and the CPU already returned from it
+    bool call(uint32_t programCounter, uint32_t r9);
+    const std::vector<BIOSFunctionStatistics>& functionStatistics() const;
+};
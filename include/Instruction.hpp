@@ -79,10 +79,12 @@ union Instruction {
     uint32_t value;
 
     Instruction() : value(0) {}
-    Instruction(uint32_t value);
+    Instruction(uint32_t value) : value(value) {}
 
-    uint32_t imm() const;
-    uint32_t immSE() const;
-    uint32_t immjump() const;
-    uint32_t copcode() const;
+    uint32_t imm() const { return value & 0xFFFF; }
+    uint32_t immSE() const { return (uint32_t)(int16_t)(value & 0xFFFF); }
+    uint32_t immjump() const { return value & 0x3FFFFFF; }
+    uint32_t copcode() const { return rs & 0x1F; }
+    // J, JAL, JR, JALR, BcondZ, BEQ, BNE, BLEZ and BGTZ
+    bool isBranchOrJump() const;
 };
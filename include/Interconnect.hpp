@@ -1,6 +1,7 @@
 #pragma once
 #include <memory>
 #include <filesystem>
+#include <vector>
 #include "COP0.hpp"
 #include "BIOS.hpp"
 #include "RAM.hpp"
@@ -16,8 +17,13 @@
 #include "Controller.hpp"
 #include "Logger.hpp"
 #include "SPU.hpp"
+#include "Fastmem.hpp"
+#include "Debugger.hpp"
+#include "EmulationStatistics.hpp"
 
 const Range ramRange = Range(0x00000000, RAM_SIZE);
+// The 2MB of RAM are mirrored over the first 8MB
+const Range ramMirrorsRange = Range(0x00000000, RAM_SIZE * 4);
 const Range scratchpadRange = Range(0x1f800000, SCRATCHPAD_SIZE);
 const Range biosRange = Range(0x1fc00000, 512 * 1024);
 const Range memoryControlRange = Range(0x1f801000, 36);
@@ -34,6 +40,67 @@ const Range dmaRegisterRange = Range(0x1f801080, 0x80);
 const Range gpuRegisterRange = Range(0x1f801810, 8);
 const Range cdromRegisterRange = Range(0x1f801800, 4);
 const Range controllerRegisterRange = Range(0x1f801040, 16);
+const Range ioPortsRange = Range(0x1f801000, 8 * 1024);
+const uint32_t IO_PORT_COUNT = 8 * 1024 / 4;
+
+// Devices behind the I/O ports, anything else in the I/O range goes through the range checks
+enum IODevice : uint8_t {
+    IOUnmapped,
+    IOController,
+    IOInterruptController,
+    IODMA,
+    IOTimer0,
+    IOTimer1,
+    IOTimer2,
+    IOCDROM,
+    IOGPU,
+    IOSPU,
+};
+
+// A 32-bit I/O port and its offset within the registers of its device
+struct IOPort {
+    IODevice device;
+    uint16_t offset;
+};
+
+// Regions of the physical address space with their own bus timings
+enum MemoryRegion : uint8_t {
+    UnmappedRegion,
+    RAMRegion,
+    ScratchpadRegion,
+    BIOSRegion,
+    Expansion1Region,
+    IOPortsRegion,
+    CDROMRegion,
+    SPURegion,
+    MemoryRegionCount
+};
+
+// System clocks a CPU load waits for its data on top of the cycle the instruction takes,
+// close to what the delays the BIOS sets in the memory control registers amount to. The
+// 8 and 16 bit buses need several transfers for wider accesses. Stores go through the
+// write buffer and don't wait
+struct AccessCycles {
+    uint32_t byte;
+    uint32_t halfWord;
+    uint32_t word;
+};
+
+const AccessCycles regionAccessCycles[MemoryRegionCount] = {
+    { 0, 0, 0 },    // Unmapped
+    { 5, 5, 5 },    // RAM
+    { 0, 0, 0 },    // Scratchpad
+    { 6, 12, 24 },  // BIOS (8 bit)
+    { 6, 12, 24 },  // Expansion 1 (8 bit)
+    { 2, 2, 2 },    // I/O ports
+    { 8, 16, 32 },  // CD-ROM (8 bit)
+    { 18, 18, 36 }, // SPU (16 bit)
+};
+
+// Pages of the physical address space seen through KUSEG, KSEG0 and KSEG1, as small
+// as the scratchpad so it fills a whole page
+const uint32_t MEMORY_PAGE_SIZE = 1024;
+const uint32_t MEMORY_PAGE_COUNT = 0x20000000 / MEMORY_PAGE_SIZE;
 
 /*
 Memory Map
@@ -65,15 +132,52 @@ class Interconnect {
     std::unique_ptr<Timer2> &timer2;
     std::unique_ptr<Controller> &controller;
     std::unique_ptr<SPU> &spu;
-    uint32_t maskRegion(uint32_t address) const;
+    std::unique_ptr<Debugger> &debugger;
+
+    // Host memory backing each page for loads and stores, a null entry goes through the
+    // device dispatch. RAM code pages are left out of the store pages so writes to them
+    // still invalidate cached code, and isolating the cache swaps in store pages without RAM
+    std::vector<uint8_t*> loadPages;
+    std::vector<uint8_t*> storePages;
+    std::vector<uint8_t*> isolatedCacheStorePages;
+    uint8_t **currentStorePages;
+    std::unique_ptr<Fastmem> fastmem;
+    // Bus timings of each page, for the cycles a load costs the CPU
+    std::vector<MemoryRegion> pageRegions;
+
+    // Device behind every I/O port so reaching it is a table lookup instead of a range
+    // check per device, along with how many times each port was accessed
+    std::vector<IOPort> ioPorts;
+    mutable std::vector<uint64_t> ioPortLoads;
+    std::vector<uint64_t> ioPortStores;
+
+    template <typename T>
+    inline T loadIOPort(IOPort port, uint32_t offset) const;
+    template <typename T>
+    inline void storeIOPort(IOPort port, uint32_t offset, T value);
+    void mapPages(std::vector<uint8_t*> &pages, uint32_t address, uint8_t *data, uint32_t size);
+    void mapRAMCodePageForStores(uint32_t offset, bool isMapped);
 public:
-    Interconnect(LogLevel logLevel, std::unique_ptr<COP0> &cop0, std::unique_ptr<BIOS> &bios, std::unique_ptr<RAM> &ram, std::unique_ptr<GPU> &gpu, std::unique_ptr<DMA> &dma, std::unique_ptr<Scratchpad> &scratchpad, std::unique_ptr<CDROM> &cdrom, std::unique_ptr<InterruptController> &interruptController, std::unique_ptr<Expansion1> &expansion1, std::unique_ptr<Timer0> &timer0, std::unique_ptr<Timer1> &timer1, std::unique_ptr<Timer2> &timer2, std::unique_ptr<Controller> &controller, std::unique_ptr<SPU> &spu);
+    Interconnect(LogLevel logLevel, std::unique_ptr<COP0> &cop0, std::unique_ptr<BIOS> &bios, std::unique_ptr<RAM> &ram, std::unique_ptr<GPU> &gpu, std::unique_ptr<DMA> &dma, std::unique_ptr<Scratchpad> &scratchpad, std::unique_ptr<CDROM> &cdrom, std::unique_ptr<InterruptController> &interruptController, std::unique_ptr<Expansion1> &expansion1, std::unique_ptr<Timer0> &timer0, std::unique_ptr<Timer1> &timer1, std::unique_ptr<Timer2> &timer2, std::unique_ptr<Controller> &controller, std::unique_ptr<SPU> &spu, std::unique_ptr<Debugger> &debugger);
     ~Interconnect();
 
     template <typename T>
     inline T load(uint32_t address) const;
     template <typename T>
-    inline void store(uint32_t address, T value) const;
+    inline void store(uint32_t address, T value);
+
+    inline uint32_t maskRegion(uint32_t address) const;
+    template <typename T>
+    inline uint32_t loadCycles(uint32_t address) const;
+    inline uint32_t fetchCycles(uint32_t address) const;
+    bool hasSideEffectFreeLoads(uint32_t address) const;
+    // Has to be called whenever COP0 status changes
+    void updateCacheIsolation();
+    inline void markCodeInRAM(uint32_t offset);
+    inline uint32_t ramCodeGeneration(uint32_t offset) const;
+    void enableFastmem();
+    Fastmem* getFastmem() const;
+    std::vector<IOPortStatistics> ioPortStatistics(size_t count) const;
 
     void transferToRAM(std::filesystem::path filePath, uint32_t origin, uint32_t size, uint32_t destination);
     void dumpRAM();
@@ -12,64 +12,88 @@
 #include "Timer.tcc"
 #include "Controller.tcc"
 #include "SPU.tcc"
+#include "Helpers.hpp"
+
+const uint32_t regionMask[8] = {
+    // KUSEG: 2048MB
+    0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff,
+    // KSEG0: 512MB
+    0x7fffffff,
+    // KSEG1: 512MB
+    0x1fffffff,
+    // KSEG2: 1024MB
+    0xffffffff, 0xffffffff,
+};
+
+inline uint32_t Interconnect::maskRegion(uint32_t address) const {
+    uint8_t index = address >> 29;
+    return address & regionMask[index];
+}
 
 template <typename T>
-inline T Interconnect::load(uint32_t address) const {
-    static_assert(std::is_same<T, uint8_t>() || std::is_same<T, uint16_t>() || std::is_same<T, uint32_t>(), "Invalid type");
+inline uint32_t Interconnect::loadCycles(uint32_t address) const {
     uint32_t absoluteAddress = maskRegion(address);
-
-    std::optional<uint32_t> offset = biosRange.contains(absoluteAddress);
-    if (offset) {
-        return bios->load<T>(*offset);
+    if (absoluteAddress >= MEMORY_PAGE_COUNT * MEMORY_PAGE_SIZE) {
+        return 0;
     }
-    offset = ramRange.contains(absoluteAddress);
-    if (offset) {
-        return ram->load<T>(*offset);
+    MemoryRegion region = pageRegions[absoluteAddress / MEMORY_PAGE_SIZE];
+    // The CD-ROM shares its page with faster devices
+    if (region == IOPortsRegion && ioPorts[(absoluteAddress % (8 * 1024)) / 4].device == IOCDROM) {
+        region = CDROMRegion;
     }
-    offset = interruptRequestControlRange.contains(absoluteAddress);
-    if (offset) {
-        return interruptController->load<T>(*offset);
+    const AccessCycles &cycles = regionAccessCycles[region];
+    if (sizeof(T) == 1) {
+        return cycles.byte;
     }
-    offset = dmaRegisterRange.contains(absoluteAddress);
-    if (offset) {
-        return dma->load<T>(*offset);
+    if (sizeof(T) == 2) {
+        return cycles.halfWord;
     }
-    offset = gpuRegisterRange.contains(absoluteAddress);
-    if (offset) {
-        return gpu->load<T>(*offset);
+    return cycles.word;
+}
+
+// KUSEG and KSEG0 fetches go through the instruction cache, which is assumed to always hit
+inline uint32_t Interconnect::fetchCycles(uint32_t address) const {
+    if (address < 0xa0000000) {
+        return 0;
+    }
+    return loadCycles<uint32_t>(address);
+}
+
+template <typename T>
+inline T Interconnect::load(uint32_t address) const {
+    static_assert(std::is_same<T, uint8_t>() || std::is_same<T, uint16_t>() || std::is_same<T, uint32_t>(), "Invalid type");
+    uint32_t absoluteAddress = maskRegion(address);
+    if (absoluteAddress < MEMORY_PAGE_COUNT * MEMORY_PAGE_SIZE) {
+        const uint8_t *page = loadPages[absoluteAddress / MEMORY_PAGE_SIZE];
+        if (page != nullptr) {
+            return loadLittleEndian<T>(page + (absoluteAddress % MEMORY_PAGE_SIZE));
+        }
     }
-    offset = timer0RegisterRange.contains(absoluteAddress);
+
+    std::optional<uint32_t> offset = ioPortsRange.contains(absoluteAddress);
     if (offset) {
-        return timer0->load<T>(*offset);
+        uint32_t port = *offset / 4;
+        if (ioPorts[port].device != IOUnmapped) {
+            ioPortLoads[port]++;
+            return loadIOPort<T>(ioPorts[port], ioPorts[port].offset + *offset % 4);
+        }
     }
-    offset = timer1RegisterRange.contains(absoluteAddress);
+    offset = biosRange.contains(absoluteAddress);
     if (offset) {
-        return timer1->load<T>(*offset);
+        return bios->load<T>(*offset);
     }
-    offset = timer2RegisterRange.contains(absoluteAddress);
+    offset = ramMirrorsRange.contains(absoluteAddress);
     if (offset) {
-        return timer2->load<T>(*offset);
+        return ram->load<T>(*offset % RAM_SIZE);
     }
     offset = expansion1Range.contains(absoluteAddress);
     if (offset) {
         return expansion1->load<T>(*offset);
     }
-    offset = soundProcessingUnitRange.contains(absoluteAddress);
-    if (offset) {
-        return spu->load<T>(*offset);
-    }
     offset = scratchpadRange.contains(absoluteAddress);
     if (offset) {
         return scratchpad->load<T>(*offset);
     }
-    offset = cdromRegisterRange.contains(absoluteAddress);
-    if (offset) {
-        return cdrom->load<T>(*offset);
-    }
-    offset = controllerRegisterRange.contains(absoluteAddress);
-    if (offset) {
-        return controller->load<T>(*offset);
-    }
     offset = memoryControlRange.contains(absoluteAddress);
     if (offset) {
         logger.logWarning("Unhandled Memory Control read at offset: %#x", *offset);
@@ -80,7 +104,6 @@ inline T Interconnect::load(uint32_t address) const {
         logger.logWarning("Unhandled RAM Control read at offset: %#x", *offset);
         return 0;
     }
-    Debugger *debugger = Debugger::getInstance();
     if (debugger->isAttached()) {
         return 0;
     }
@@ -89,27 +112,42 @@ inline T Interconnect::load(uint32_t address) const {
 }
 
 template <typename T>
-inline void Interconnect::store(uint32_t address, T value) const {
+inline void Interconnect::store(uint32_t address, T value) {
     static_assert(std::is_same<T, uint8_t>() || std::is_same<T, uint16_t>() || std::is_same<T, uint32_t>(), "Invalid type");
     if (address % sizeof(T) != 0) {
         logger.logError("Unaligned memory store");
-        exit(1);
+        return;
     }
     uint32_t absoluteAddress = maskRegion(address);
-    std::optional<uint32_t> offset;
+    if (absoluteAddress < MEMORY_PAGE_COUNT * MEMORY_PAGE_SIZE) {
+        uint8_t *page = currentStorePages[absoluteAddress / MEMORY_PAGE_SIZE];
+        if (page != nullptr) {
+            storeLittleEndian<T>(page + (absoluteAddress % MEMORY_PAGE_SIZE), value);
+            return;
+        }
+    }
+    std::optional<uint32_t> offset = ioPortsRange.contains(absoluteAddress);
+    if (offset) {
+        uint32_t port = *offset / 4;
+        if (ioPorts[port].device != IOUnmapped) {
+            ioPortStores[port]++;
+            storeIOPort<T>(ioPorts[port], ioPorts[port].offset + *offset % 4, value);
+            return;
+        }
+    }
     offset = memoryControlRange.contains(absoluteAddress);
     if (offset) {
         // PlayStation BIOS should not set these to any different value
         switch (*offset) {
             case 0: {
                 if (value != 0x1f000000) {
-                    exit(1);
+                    logger.logError("Unexpected Expansion 1 base address: %#x", value);
                 }
                 break;
             }
             case 4: {
                 if (value != 0x1f802000) {
-                    exit(1);
+                    logger.logError("Unexpected Expansion 2 base address: %#x", value);
                 }
                 break;
             }
@@ -130,47 +168,14 @@ inline void Interconnect::store(uint32_t address, T value) const {
         logger.logWarning("Unhandled Cache Control write at offset: %#x", *offset);
         return;
     }
-    offset = ramRange.contains(absoluteAddress);
+    offset = ramMirrorsRange.contains(absoluteAddress);
     if (offset) {
         if (cop0->isCacheIsolated()) {
             return;
         }
-        ram->store<T>(*offset, value);
-        return;
-    }
-    offset = interruptRequestControlRange.contains(absoluteAddress);
-    if (offset) {
-        interruptController->store<T>(*offset, value);
-        return;
-    }
-    offset = dmaRegisterRange.contains(absoluteAddress);
-    if (offset) {
-        dma->store<T>(*offset, value);
-        return;
-    }
-    offset = gpuRegisterRange.contains(absoluteAddress);
-    if (offset) {
-        gpu->store<T>(*offset, value);
-        return;
-    }
-    offset = timer0RegisterRange.contains(absoluteAddress);
-    if (offset) {
-        timer0->store<T>(*offset, value);
-        return;
-    }
-    offset = timer1RegisterRange.contains(absoluteAddress);
-    if (offset) {
-        timer1->store<T>(*offset, value);
-        return;
-    }
-    offset = timer2RegisterRange.contains(absoluteAddress);
-    if (offset) {
-        timer2->store<T>(*offset, value);
-        return;
-    }
-    offset = soundProcessingUnitRange.contains(absoluteAddress);
-    if (offset) {
-        spu->store<T>(*offset, value);
+        // Only code pages get here, the store invalidates them so they can take the fast path again
+        ram->store<T>(*offset % RAM_SIZE, value);
+        mapRAMCodePageForStores(*offset % RAM_SIZE, true);
         return;
     }
     offset = expansion2Range.contains(absoluteAddress);
@@ -183,15 +188,99 @@ inline void Interconnect::store(uint32_t address, T value) const {
         scratchpad->store<T>(*offset, value);
         return;
     }
-    offset = cdromRegisterRange.contains(absoluteAddress);
-    if (offset) {
-        cdrom->store<T>(*offset, value);
-        return;
+    logger.logError("Unhandled write at: %#x", address);
+}
+
+template <typename T>
+inline T Interconnect::loadIOPort(IOPort port, uint32_t offset) const {
+    switch (port.device) {
+        case IOController: {
+            return controller->load<T>(offset);
+        }
+        case IOInterruptController: {
+            return interruptController->load<T>(offset);
+        }
+        case IODMA: {
+            return dma->load<T>(offset);
+        }
+        case IOTimer0: {
+            return timer0->load<T>(offset);
+        }
+        case IOTimer1: {
+            return timer1->load<T>(offset);
+        }
+        case IOTimer2: {
+            return timer2->load<T>(offset);
+        }
+        case IOCDROM: {
+            return cdrom->load<T>(offset);
+        }
+        case IOGPU: {
+            return gpu->load<T>(offset);
+        }
+        case IOSPU: {
+            return spu->load<T>(offset);
+        }
+        case IOUnmapped: {
+            break;
+        }
     }
-    offset = controllerRegisterRange.contains(absoluteAddress);
-    if (offset) {
-        controller->store<T>(*offset, value);
+    return 0;
+}
+
+template <typename T>
+inline void Interconnect::storeIOPort(IOPort port, uint32_t offset, T value) {
+    switch (port.device) {
+        case IOController: {
+            controller->store<T>(offset, value);
+            break;
+        }
+        case IOInterruptController: {
+            interruptController->store<T>(offset, value);
+            break;
+        }
+        case IODMA: {
+            dma->store<T>(offset, value);
+            break;
+        }
+        case IOTimer0: {
+            timer0->store<T>(offset, value);
+            break;
+        }
+        case IOTimer1: {
+            timer1->store<T>(offset, value);
+            break;
+        }
+        case IOTimer2: {
+            timer2->store<T>(offset, value);
+            break;
+        }
+        case IOCDROM: {
+            cdrom->store<T>(offset, value);
+            break;
+        }
+        case IOGPU: {
+            gpu->store<T>(offset, value);
+            break;
+        }
+        case IOSPU: {
+            spu->store<T>(offset, value);
+            break;
+        }
+        case IOUnmapped: {
+            break;
+        }
+    }
+}
+
+inline void Interconnect::markCodeInRAM(uint32_t offset) {
+    if (ram->isCodePage(offset)) {
         return;
     }
-    logger.logError("Unhandled write at: %#x", address);
+    ram->markCodePage(offset);
+    mapRAMCodePageForStores(offset, false);
+}
+
+inline uint32_t Interconnect::ramCodeGeneration(uint32_t offset) const {
+    return ram->codePageGeneration(offset);
 }
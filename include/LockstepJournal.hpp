@@ -0,0 +1,39 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <optional>
+
+struct MemoryAccess {
+    bool isStore;
+    uint32_t address;
+    uint32_t size;
+    uint32_t value;
+};
+
+// Records the data accesses done while a recompiled block runs, so the same
+// instructions can be replayed on the interpreter without touching memory or
+// devices a second time.
+class LockstepJournal {
+    std::vector<MemoryAccess> accesses;
+    uint32_t replayIndex;
+    bool replaying;
+    std::optional<std::string> divergence;
+
+    const MemoryAccess* nextReplayedAccess(bool isStore, uint32_t address, uint32_t size);
+public:
+    LockstepJournal();
+    ~LockstepJournal();
+
+    void startRecording();
+    void startReplaying();
+    bool isReplaying() const;
+
+    void recordLoad(uint32_t address, uint32_t size, uint32_t value);
+    void recordStore(uint32_t address, uint32_t size, uint32_t value);
+    uint32_t replayLoad(uint32_t address, uint32_t size);
+    void replayStore(uint32_t address, uint32_t size, uint32_t value);
+
+    // Returns a description of the first mismatch found while replaying, if any
+    std::optional<std::string> finishReplaying();
+};
@@ -2,6 +2,8 @@
 #include <sstream>
 #include <string>
 #include <limits>
+#include <mutex>
+#include <atomic>
 
 enum LogLevel : uint8_t {
     NoLog = 0,
@@ -11,6 +13,30 @@ enum LogLevel : uint8_t {
 
 LogLevel logLevelWithValue(std::string value);
 
+// Where the fatal errors of one emulated machine go instead of ending the process,
+// only the first one is kept
+class FatalErrorState {
+    mutable std::mutex messageMutex;
+    std::atomic<bool> failed;
+    std::string message;
+public:
+    FatalErrorState();
+    void fail(std::string message);
+    bool hasFailed() const;
+    std::string errorMessage() const;
+};
+
+// Sends the fatal errors logged on the current thread to a machine until it goes out
+// of scope. Outside of any scope a fatal error still exits
+class FatalErrorScope {
+    FatalErrorState *previousState;
+public:
+    FatalErrorScope(FatalErrorState *state);
+    ~FatalErrorScope();
+};
+
+FatalErrorState* currentFatalErrorState();
+
 class Logger {
     LogLevel level;
     std::string prefix;
@@ -0,0 +1,131 @@
+#pragma once
+#include <memory>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <deque>
+#include "CPU.hpp"
+#include "COP0.hpp"
+#include "Interconnect.hpp"
+#include "BIOS.hpp"
+#include "RAM.hpp"
+#include "GPU.hpp"
+#include "GPUBackend.hpp"
+#include "DMA.hpp"
+#include "Scratchpad.hpp"
+#include "CDROM.hpp"
+#include "InterruptController.hpp"
+#include "Expansion1.hpp"
+#include "Timer.hpp"
+#include "Controller.hpp"
+#include "DigitalController.hpp"
+#include "SPU.hpp"
+#include "Debugger.hpp"
+#include "HighLevelBIOS.hpp"
+#include "Scheduler.hpp"
+#include "Executable.hpp"
+#include "EmulationStatistics.hpp"
+#include "Logger.hpp"
+
+/*
+The emulated console without any host windows, audio or input devices
+
+This is what the ruby_core library provides to embed the emulator: create a
+machine with a BIOS, load an EXE or a CD image, run it for some cycles or
+frames and look at its RAM and VRAM. The picture is only drawn when a GPU
+backend is set, the controller switches come from whoever runs the machine.
+*/
+class Machine {
+    Logger logger;
+    // Declared before the devices, so it outlives the GPU thread
+    FatalErrorState fatalErrors;
+
+    std::unique_ptr<Scheduler> scheduler;
+    std::unique_ptr<Debugger> debugger;
+    std::unique_ptr<CPU> cpu;
+    std::unique_ptr<COP0> cop0;
+    std::unique_ptr<Interconnect> interconnect;
+    std::unique_ptr<BIOS> bios;
+    std::unique_ptr<RAM> ram;
+    std::unique_ptr<GPU> gpu;
+    std::unique_ptr<DMA> dma;
+    std::unique_ptr<Scratchpad> scratchpad;
+    std::unique_ptr<CDROM> cdrom;
+    std::unique_ptr<InterruptController> interruptController;
+    std::unique_ptr<Expansion1> expansion1;
+    std::unique_ptr<Timer0> timer0;
+    std::unique_ptr<Timer1> timer1;
+    std::unique_ptr<Timer2> timer2;
+    std::unique_ptr<Controller> controller;
+    std::unique_ptr<SPU> spu;
+    std::unique_ptr<HighLevelBIOS> highLevelBIOS;
+    // Sideloaded when the BIOS is done booting
+    std::unique_ptr<Executable> executable;
+
+    // Controller switches waiting for the system clock they were pressed at
+    std::deque<std::pair<uint64_t, DigitalControllerSwitches>> pendingControllerSwitches;
+
+    std::string ttyBuffer;
+    std::vector<std::string> biosFunctionsLog;
+
+    EmulationStatistics statistics;
+    uint32_t measuredFrames;
+    uint64_t measuredInstructions;
+    uint64_t measuredClocks;
+    std::chrono::steady_clock::duration measuredTime;
+
+    uint64_t emulatedFrames;
+    // Set when the guest calls the BIOS exit()
+    bool exitRequested;
+    uint32_t exitCode;
+
+    bool runSlice(uint64_t cycleBudget);
+    bool handleScheduledEvent(SchedulerEvent event);
+    void sideloadExecutable();
+    void checkBIOSFunctions();
+    void checkTTY(char c);
+    void updateStatistics(uint64_t executedInstructions, uint64_t emulatedClocks, std::chrono::steady_clock::duration frameTime);
+public:
+    Machine(std::filesystem::path biosFilePath);
+    ~Machine();
+
+    void loadExpansion(std::filesystem::path filePath);
+    void loadExecutable(std::filesystem::path filePath);
+    void loadCDROMImageFile(std::filesystem::path filePath);
+    void setRenderer(std::unique_ptr<GPUBackend> renderer);
+    void setControllerSwitches(DigitalControllerSwitches switches);
+    // Applies the switches once the machine reaches the given system clock
+    void queueControllerSwitches(DigitalControllerSwitches switches, uint64_t timestamp);
+    bool isGPUThreaded();
+    // The thread that emulates takes over the renderer, unless the GPU has its own
+    void attachRendererToCurrentThread();
+    void detachRendererFromCurrentThread();
+
+    // Runs until the next VBLANK
+    void emulateFrame();
+    // Runs for at least the given system clocks, stopping early if the program exits or the machine fails
+    void emulateCycles(uint64_t cycles);
+
+    // Copies guest RAM at a KUSEG, KSEG0 or KSEG1 address, false when it doesn't fit in RAM
+    bool readRAM(uint32_t address, uint32_t size, uint8_t *data);
+    bool readVRAM(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t *pixels);
+    void dumpRAM();
+
+    CPU* getCPU();
+    Debugger* getDebugger();
+    const EmulationStatistics& getStatistics();
+    const std::vector<std::string>& getBIOSFunctionsLog();
+    uint64_t emulatedFrameCount();
+    uint64_t executedInstructionCount();
+    uint64_t elapsedCycles();
+    bool hasExited();
+    uint32_t getExitCode();
+    // Set when a device logged an error it can't recover from, the machine doesn't run after that
+    bool hasFailed();
+    std::string getErrorMessage();
+
+    void cycleCPUExecutionMode();
+    void toggleCPULockstep();
+    void cycleCPUClock();
+};
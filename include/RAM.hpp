@@ -2,11 +2,22 @@
 #include <cstdint>
 #include <string>
 #include <filesystem>
+#include <array>
+#include "SharedMemory.hpp"
 
 const uint32_t RAM_SIZE = 2*1024*1024;
+const uint32_t RAM_CODE_PAGE_SIZE = 4*1024;
+const uint32_t RAM_CODE_PAGE_COUNT = RAM_SIZE / RAM_CODE_PAGE_SIZE;
 
 class RAM {
-    uint8_t data[RAM_SIZE];
+    SharedMemory memory;
+    uint8_t *data;
+    // Pages that hold decoded code, and a counter that is bumped every time
+    // one of those pages is written so stale cached blocks can be detected
+    std::array<bool, RAM_CODE_PAGE_COUNT> codePages;
+    std::array<uint32_t, RAM_CODE_PAGE_COUNT> codePageGenerations;
+
+    void invalidateCodePages(uint32_t offset, uint32_t size);
 public:
     RAM();
     ~RAM();
@@ -16,6 +27,13 @@ public:
     template <typename T>
     inline void store(uint32_t offset, T value);
 
+    inline void markCodePage(uint32_t offset);
+    inline bool isCodePage(uint32_t offset) const;
+    inline uint32_t codePageGeneration(uint32_t offset) const;
+
+    uint8_t* dataAtOffset(uint32_t offset);
+    const SharedMemory& getMemory() const;
+
     void receiveTransfer(std::filesystem::path filePath, uint32_t origin, uint32_t size, uint32_t destination);
     void dump();
 };
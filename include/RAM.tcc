@@ -1,20 +1,32 @@
 #pragma once
 #include "RAM.hpp"
+#include "Helpers.hpp"
 
 template <typename T>
 inline T RAM::load(uint32_t offset) const {
     static_assert(std::is_same<T, uint8_t>() || std::is_same<T, uint16_t>() || std::is_same<T, uint32_t>(), "Invalid type");
-    T value = 0;
-    for (uint8_t i = 0; i < sizeof(T); i++) {
-        value |= (((uint32_t)data[offset + i]) << (i * 8));
-    }
-    return value;
+    return loadLittleEndian<T>(&data[offset]);
 }
 
 template <typename T>
 inline void RAM::store(uint32_t offset, T value) {
     static_assert(std::is_same<T, uint8_t>() || std::is_same<T, uint16_t>() || std::is_same<T, uint32_t>(), "Invalid type");
-    for (uint8_t i = 0; i < sizeof(T); i++) {
-        data[offset + i] = ((uint8_t)(((uint32_t)value) >> (i * 8)));
+    uint32_t page = offset / RAM_CODE_PAGE_SIZE;
+    if (codePages[page]) {
+        codePages[page] = false;
+        codePageGenerations[page]++;
     }
+    storeLittleEndian<T>(&data[offset], value);
+}
+
+inline void RAM::markCodePage(uint32_t offset) {
+    codePages[offset / RAM_CODE_PAGE_SIZE] = true;
+}
+
+inline bool RAM::isCodePage(uint32_t offset) const {
+    return codePages[offset / RAM_CODE_PAGE_SIZE];
+}
+
+inline uint32_t RAM::codePageGeneration(uint32_t offset) const {
+    return codePageGenerations[offset / RAM_CODE_PAGE_SIZE];
 }
@@ -0,0 +1,84 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <array>
+#include <optional>
+#include "CPU.hpp"
+#include "Logger.hpp"
+
+// Native code is only generated on x86-64 hosts, everywhere else the
+// recompiler execution mode runs on the cached interpreter instead
+#if defined(__x86_64__) || defined(_M_X64)
+#define RUBY_RECOMPILER_SUPPORTED 1
+#else
+#define RUBY_RECOMPILER_SUPPORTED 0
+#endif
+
+const size_t RECOMPILER_CODE_CACHE_SIZE = 16*1024*1024;
+
+/*
+x86-64 dynamic recompiler
+
+Each BasicBlock is translated into a native function that runs every
+instruction of the block and returns how many were executed. Simple ALU
+instructions are emitted as native code working directly on CPU::registers,
+everything else (branches, multiplication, COP0, exceptions...) calls back into
+the interpreter handler with the program counter it expects.
+
+Loads and stores also call the interpreter, unless fastmem is enabled and the
+lockstep mode (which has to journal every access) is not. Then they are a
+single host instruction on the fastmem region, and MMIO gets to the
+Interconnect through Fastmem's fault handler. Accesses to an address known
+when translating that isn't backed by memory still call the interpreter, so
+I/O ports polled in a loop don't fault on every iteration.
+
+Load delay slots follow the interpreter: a native instruction only needs to
+touch loadSlots when the previous instruction could have filled one, which
+is known when the block is translated. Branch delay slots come for free since
+blocks end right after them.
+*/
+class Recompiler {
+    Logger logger;
+    CPU *cpu;
+    uint8_t *codeCache;
+    size_t codeCacheUsed;
+    bool full;
+    std::vector<uint8_t> code;
+    std::vector<size_t> exitJumps;
+    Fastmem *fastmem;
+
+    void emitByte(uint8_t value);
+    void emitWord(uint32_t value);
+    void emitQuad(uint64_t value);
+    void emitPrologue();
+    void emitEpilogue();
+    void emitCall(const void *function, uint64_t firstArgument, uint64_t secondArgument);
+    void emitExitIfTrue(uint32_t executedInstructions);
+    int32_t displacement(const void *address) const;
+    void emitLoadRegister(uint8_t hostRegister, uint32_t guestRegister);
+    void emitRegisterOperation(uint8_t opcode, uint32_t guestRegister);
+    void emitStoreRegister(uint32_t guestRegister);
+    void emitInvalidateLoadSlot(uint32_t guestRegister);
+    void emitMoveLoadDelaySlots();
+    void emitInstruction(Instruction instruction);
+    void emitMemoryAccess(const CachedInstruction &cachedInstruction, uint32_t programCounter, uint32_t executedInstructions, bool isLoadSlotPending, uint32_t accessCycles);
+    void patchJump(size_t jumpOffset);
+    bool isFastmemAccess(Instruction instruction, const std::array<std::optional<uint32_t>, 32> &constantRegisters) const;
+    uint32_t loadCycles(Instruction instruction, const std::array<std::optional<uint32_t>, 32> &constantRegisters) const;
+    void trackConstantRegisters(Instruction instruction, std::array<std::optional<uint32_t>, 32> &constantRegisters) const;
+
+    static bool executeInstruction(CPU *cpu, const CachedInstruction *cachedInstruction, uint32_t programCounter);
+    static void finishBlock(CPU *cpu, uint32_t nextProgramCounter, bool endsWithDelaySlot);
+public:
+    Recompiler(LogLevel logLevel, CPU *cpu);
+    ~Recompiler();
+
+    static bool isSupported();
+    static bool canEmitNatively(Instruction instruction);
+    static bool isMemoryAccess(Instruction instruction);
+
+    RecompiledCode compile(const BasicBlock &basicBlock, uint32_t address);
+    bool isFull();
+    void flush();
+    size_t codeCacheUsage();
+};
@@ -3,22 +3,63 @@
 #include <string>
 #include <memory>
 #include <vector>
+#include <array>
+#include <mutex>
 #include "RendererProgram.hpp"
 #include "RendererBuffer.hpp"
 #include "Vertex.hpp"
 #include "GPUImageBuffer.hpp"
+#include "GPUBackend.hpp"
 #include "Texture.hpp"
 #include "Window.hpp"
 #include "Logger.hpp"
 
 class GPU;
 
-class Renderer {
+// A finished picture waiting to be shown, with a fence for the last commands that used it
+struct RendererFrame {
+    std::unique_ptr<Texture> texture = nullptr;
+    GLsync fence = nullptr;
+    Point displayAreaStart = { 0, 0 };
+    Dimensions resolution = { 0, 0 };
+};
+
+// Run of consecutive indices drawn with the same primitive
+struct RendererBatch {
+    GLenum mode;
+    unsigned int count;
+};
+
+enum RendererFlushReason {
+    FlushBufferFull,
+    FlushFrameEnd,
+    FlushVRAMRead,
+    FlushImageLoad
+};
+
+/*
+OpenGL backend
+
+Drawing happens on a context of its own, shared with the main window, so the
+thread that emulates can draw while the main thread presents on the window
+context. Finished frames are copied into a triple buffer: the drawing side
+always has one to write, the presenting side one to show and the newest
+complete frame waits in between.
+
+Lines and triangles share the vertex buffer as runs kept in submission order,
+and the drawing offset is added to the positions as they come in, so neither
+forces the batch out. It is only drawn when the buffer fills up, at the end of
+the frame or before something else touches the framebuffer.
+*/
+class Renderer : public GPUBackend {
     Logger logger;
-    GLuint offsetUniform;
+    std::unique_ptr<Window> &mainWindow;
+    SDL_GLContext renderingContext;
+    Point drawingOffset;
 
     std::unique_ptr<RendererProgram> program;
     std::unique_ptr<RendererBuffer<Vertex>> buffer;
+    std::vector<RendererBatch> batches;
 
     std::unique_ptr<Texture> loadImageTexture;
     std::unique_ptr<RendererProgram> textureRendererProgram;
@@ -28,19 +69,39 @@ class Renderer {
     std::unique_ptr<RendererProgram> screenRendererProgram;
     std::unique_ptr<RendererBuffer<Pixel>> screenBuffer;
 
-    GLenum mode;
+    std::array<RendererFrame, 3> frames;
+    uint32_t drawingFrame;
+    uint32_t readyFrame;
+    uint32_t presentedFrame;
+    bool hasReadyFrame;
+    std::mutex framesMutex;
+
+    RendererStatistics frameStatistics;
+    RendererStatistics finishedFrameStatistics;
+
     bool resizeToFitFramebuffer;
 
-    void checkForceDraw(unsigned int verticesToRender, GLenum newMode);
+    void checkForceDraw(unsigned int verticesToRender);
+    // Indices count from the first of `vertices`, batches are counted in indices
+    void addVertices(const Vertex *vertices, unsigned int count, const uint16_t *indices, unsigned int indexCount, GLenum mode);
+    void flush(RendererFlushReason reason);
+    void waitForFrame(RendererFrame &frame);
 public:
     Renderer(std::unique_ptr<Window> &mainWindow);
     ~Renderer();
 
-    void pushLine(std::vector<Vertex> vertices);
-    void pushPolygon(std::vector<Vertex> vertices);
-    void setDrawingOffset(int16_t x, int16_t y);
-    void prepareFrame();
-    void renderFrame();
-    void finalizeFrame(GPU *gpu);
-    void loadImage(std::unique_ptr<GPUImageBuffer> &imageBuffer);
+    void pushLine(const Vertex *vertices, unsigned int count) override;
+    void pushPolygon(const Vertex *vertices, unsigned int count) override;
+    void setDrawingOffset(int16_t x, int16_t y) override;
+    void prepareFrame() override;
+    void renderFrame() override;
+    void finalizeFrame(GPU *gpu) override;
+    void loadImage(std::unique_ptr<GPUImageBuffer> &imageBuffer) override;
+    bool readVRAM(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t *pixels) override;
+    void attachToCurrentThread() override;
+    void detachFromCurrentThread() override;
+    RendererStatistics lastFrameStatistics() override;
+
+    // Main thread, with the main window current. False when no new frame was finished
+    bool presentFrame();
 };
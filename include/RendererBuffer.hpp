@@ -6,24 +6,53 @@
 #include "RendererProgram.hpp"
 
 const uint32_t RENDERER_BUFFER_SIZE = 64*1024;
+const uint32_t RENDERER_BUFFER_REGIONS = 3;
 
+/*
+Vertex ring in a persistently mapped buffer
+
+The buffer is split in regions of `capacity` vertices. Vertices are copied
+straight into the mapped memory and draw() only submits the ones added since
+the last draw, so nothing waits for the GPU while a region fills up. When a
+region runs out the buffer fences it and moves on to the next one, waiting
+only if the GPU still hasn't finished drawing from that one.
+
+Buffers created with an index capacity stream indices next to the vertices,
+in regions that follow the vertex ones, and draw through them instead. Each
+index is relative to the start of its vertex region.
+*/
 template <class T>
 class RendererBuffer {
     std::unique_ptr<VertexArrayObject> vao;
     GLuint vbo;
+    GLuint ibo;
+    T *mappedVertices;
+    uint16_t *mappedIndices;
     std::unique_ptr<RendererProgram> &program;
     unsigned int capacity;
+    unsigned int indexCapacity;
+    GLsync regionFences[RENDERER_BUFFER_REGIONS];
+    unsigned int region;
+    // Vertices and indices added to the current region, and how many of them were drawn
     unsigned int size;
+    unsigned int drawnSize;
+    unsigned int indexCount;
+    unsigned int drawnIndexCount;
 
     void enableAttributes() const;
+    void nextRegion();
+    bool isIndexed() const;
 public:
-    RendererBuffer(std::unique_ptr<RendererProgram> &program, unsigned int capacity);
+    RendererBuffer(std::unique_ptr<RendererProgram> &program, unsigned int capacity, unsigned int indexCapacity = 0);
     ~RendererBuffer();
 
     void bind() const;
-    void clean();
     void draw(GLenum mode);
-    void addData(std::vector<T> data);
+    // Submits the next `count` pending vertices, or indices, without checking for errors
+    void draw(GLenum mode, unsigned int count);
+    void addData(const T *data, unsigned int count);
+    // Indices start at 0 for the first of `data`
+    void addData(const T *data, unsigned int count, const uint16_t *indices, unsigned int indexCount);
+    // Vertices that can be added before the next draw
     unsigned int remainingCapacity();
 };
-
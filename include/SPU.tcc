@@ -3,7 +3,7 @@
 template <typename T>
 inline T SPU::load(uint32_t offset) const {
     static_assert(std::is_same<T, uint8_t>() || std::is_same<T, uint16_t>() || std::is_same<T, uint32_t>(), "Invalid type");
-    if (offset >= 0 && offset <= 0x17f) {
+    if (offset <= 0x17f) {
         logger.logMessage("Unhandled Sound Processing Unit voice register read");
         return 0;
     }
@@ -94,7 +94,7 @@ inline T SPU::load(uint32_t offset) const {
 template <typename T>
 inline void SPU::store(uint32_t offset, T value) {
     static_assert(std::is_same<T, uint8_t>() || std::is_same<T, uint16_t>() || std::is_same<T, uint32_t>(), "Invalid type");
-    if (offset >= 0 && offset <= 0x17f) {
+    if (offset <= 0x17f) {
         logger.logMessage("Unhandled Sound Processing Unit voice register write");
         return;
     }
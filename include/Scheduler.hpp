@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+#include <array>
+#include <vector>
+#include <optional>
+
+enum SchedulerEvent : uint8_t {
+    VBlankEvent,
+    Timer0Event,
+    Timer1Event,
+    Timer2Event,
+    CDROMInterruptEvent,
+    CDROMSectorEvent,
+    ControllerEvent,
+    InputEvent,
+    SchedulerEventCount
+};
+
+struct ScheduledEvent {
+    uint64_t timestamp;
+    SchedulerEvent event;
+};
+
+/*
+Timeline of the emulated machine in system clocks
+
+Devices register when something happens next (a timer reaching its target, the
+next VBLANK, a CD-ROM sector, a controller ACK) and the CPU runs until the
+earliest of them, so nothing gets polled while the CPU makes progress.
+Each event is pending at most once, scheduling it again moves its deadline,
+the entries left behind in the heap are dropped when they reach the top.
+*/
+class Scheduler {
+    uint64_t timestamp;
+    uint64_t nextDeadline;
+    std::array<uint64_t, SchedulerEventCount> deadlines;
+    std::vector<ScheduledEvent> heap;
+
+    void updateNextDeadline();
+    void rebuildHeap();
+public:
+    Scheduler();
+    ~Scheduler();
+
+    uint64_t currentTimestamp() const;
+    void schedule(SchedulerEvent event, uint64_t delay);
+    void cancel(SchedulerEvent event);
+    bool isScheduled(SchedulerEvent event) const;
+    uint64_t cyclesUntilNextEvent() const;
+    std::optional<SchedulerEvent> popDueEvent();
+
+    inline void advance(uint32_t cycles);
+    inline bool isEventDue() const;
+};
@@ -0,0 +1,10 @@
+#pragma once
+#include "Scheduler.hpp"
+
+inline void Scheduler::advance(uint32_t cycles) {
+    timestamp += cycles;
+}
+
+inline bool Scheduler::isEventDue() const {
+    return timestamp >= nextDeadline;
+}
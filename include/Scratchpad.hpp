@@ -1,14 +1,19 @@
 #pragma once
 #include <cstdint>
+#include "SharedMemory.hpp"
 
 const uint32_t SCRATCHPAD_SIZE = 1024;
 
 class Scratchpad {
-    uint8_t data[SCRATCHPAD_SIZE];
+    SharedMemory memory;
+    uint8_t *data;
 public:
     Scratchpad();
     ~Scratchpad();
 
+    uint8_t* dataAtOffset(uint32_t offset);
+    const SharedMemory& getMemory() const;
+
     template <typename T>
     inline T load(uint32_t offset) const;
     template <typename T>
@@ -0,0 +1,24 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+/*
+Zero initialized host memory that can be mapped more than once, so the same
+bytes are visible at several addresses. On Linux it is backed by a memfd and
+the size is rounded up to whole host pages, everywhere else it is a plain
+allocation that can't be mapped again (getFileDescriptor returns -1).
+*/
+class SharedMemory {
+    uint8_t *data;
+    size_t size;
+    int fileDescriptor;
+public:
+    SharedMemory(size_t size);
+    ~SharedMemory();
+    SharedMemory(const SharedMemory&) = delete;
+    SharedMemory& operator=(const SharedMemory&) = delete;
+
+    uint8_t* getData() const;
+    size_t getSize() const;
+    int getFileDescriptor() const;
+};
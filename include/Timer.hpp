@@ -1,6 +1,8 @@
 #pragma once
 #include <cstdint>
+#include <memory>
 #include "Logger.hpp"
+#include "Scheduler.hpp"
 
 enum Timer0SyncMode {
     PauseDuringHblank = 0,
@@ -158,27 +160,47 @@ union TimerCounterTarget {
     TimerCounterTarget() : _value(0) {}
 };
 
+// Ticks counted by a clock source by a given timestamp are timestamp * numerator / denominator
+struct TimerClockRate {
+    uint64_t numerator;
+    uint64_t denominator;
+};
+
+/*
+Counters aren't stepped, the value register holds the count at baseTimestamp
+and reads work it out from the ticks of the clock source since then. An event
+is only scheduled when an interrupt is armed for the target or FFFFh.
+*/
 class Timer {
     Logger logger;
+    std::unique_ptr<Scheduler> &scheduler;
+    SchedulerEvent event;
+    uint64_t baseTimestamp;
+
+    uint64_t ticksAt(uint64_t timestamp);
+    uint64_t ticksUntil(uint32_t value);
+    uint32_t valueAfter(uint64_t ticks);
+    void count(uint64_t ticks);
 protected:
     uint8_t identity;
     TimerCounterValue counterValue;
     TimerCounterMode counterMode;
     TimerCounterTarget counterTarget;
 
-    uint32_t counter;
+    virtual TimerClockRate clockRate() = 0;
+    void synchronize();
+    void scheduleNextEvent();
 public:
-    Timer(uint8_t identity);
+    Timer(uint8_t identity, std::unique_ptr<Scheduler> &scheduler);
     ~Timer();
 
-    virtual void step(uint32_t cycles) = 0;
+    void update();
     uint32_t counterValueRegister() const;
     uint32_t counterModeRegister() const;
     uint32_t counterTargetRegister() const;
     void setCounterValueRegister(uint32_t value);
     virtual void setCounterModeRegister(uint32_t value) = 0;
     void setCounterTargetRegister(uint32_t value);
-    void checkTargetsAndOverflows();
     void checkInterruptRequest();
 
     template <typename T>
@@ -188,20 +210,23 @@ public:
 };
 
 class Timer0 : public Timer {
+protected:
+    TimerClockRate clockRate() override;
 public:
-    Timer0() : Timer(0) {}
-    void step(uint32_t cycles) override;
+    Timer0(std::unique_ptr<Scheduler> &scheduler) : Timer(0, scheduler) {}
     void setCounterModeRegister(uint32_t value) override;
 };
 class Timer1 : public Timer {
+protected:
+    TimerClockRate clockRate() override;
 public:
-    Timer1() : Timer(1) {}
-    void step(uint32_t cycles) override;
+    Timer1(std::unique_ptr<Scheduler> &scheduler) : Timer(1, scheduler) {}
     void setCounterModeRegister(uint32_t value) override;
 };
 class Timer2 : public Timer {
+protected:
+    TimerClockRate clockRate() override;
 public:
-    Timer2() : Timer(2) {}
-    void step(uint32_t cycles) override;
+    Timer2(std::unique_ptr<Scheduler> &scheduler) : Timer(2, scheduler) {}
     void setCounterModeRegister(uint32_t value) override;
 };
@@ -5,6 +5,7 @@ template <typename T>
 inline T Timer::load(uint32_t offset) {
     static_assert(std::is_same<T, uint8_t>() || std::is_same<T, uint16_t>() || std::is_same<T, uint32_t>(), "Invalid type");
 
+    synchronize();
     switch (offset) {
         case 0: {
             return counterValueRegister();
@@ -26,22 +27,24 @@ template <typename T>
 inline void Timer::store(uint32_t offset, T value) {
     static_assert(std::is_same<T, uint8_t>() || std::is_same<T, uint16_t>() || std::is_same<T, uint32_t>(), "Invalid type");
 
+    synchronize();
     switch (offset) {
         case 0: {
             setCounterValueRegister(value);
-            return;
+            break;
         }
         case 4: {
             setCounterModeRegister(value);
-            return;
+            break;
         }
         case 8: {
             setCounterTargetRegister(value);
-            return;
+            break;
         }
         default: {
             logger.logError("Unhandled Timer load at offset: %#x", offset);
             return;
         }
     }
+    scheduleNextEvent();
 }
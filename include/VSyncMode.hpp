@@ -0,0 +1,14 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+enum VSyncMode : uint8_t {
+    // Presents as soon as a frame is ready, it may tear
+    VSyncOff = 0,
+    // Waits for the display refresh on every present
+    VSyncOn = 1,
+    // Waits for the refresh unless the frame is already late, then tears instead of stuttering
+    AdaptiveVSync = 2,
+};
+
+VSyncMode vsyncModeWithValue(std::string value);
@@ -1,5 +1,5 @@
 #pragma once
-#include <glad/glad.h>
+#include <cstdint>
 
 union Dimensions {
     struct {
@@ -13,10 +13,10 @@ union Dimensions {
 };
 
 struct Point {
-    GLshort x, y;
+    int16_t x, y;
 
     Point();
-    Point(GLshort x, GLshort y);
+    Point(int16_t x, int16_t y);
     Point(uint32_t position);
     static Point forTexturePosition(uint16_t position);
     static Point forTexturePage(uint32_t texturePage);
@@ -24,7 +24,7 @@ struct Point {
 };
 
 struct Color {
-    GLubyte r, g, b;
+    uint8_t r, g, b;
 
     Color(uint32_t color);
 };
@@ -35,26 +35,35 @@ enum TextureBlendMode {
     TextureBlendModeTextureBlend
 };
 
+/*
+Vertex attributes:
+0-5      CLUT X        (in 16-halfword steps)
+6-14     CLUT Y
+16-19    Texture page X (in 64-halfword steps)
+20       Texture page Y (in 256-line steps)
+21-22    Texture blend mode
+23-24    Texture depth shift
+*/
 struct Vertex {
     Point point;
     Color color;
     Point texturePosition;
-    GLuint textureBlendMode;
-    Point texturePage;
-    GLuint textureDepthShift;
-    Point clut;
+    uint32_t attributes;
 
+    Vertex();
     Vertex(Point point, Color color);
-    Vertex(Point point, Color color, Point texturePosition, TextureBlendMode textureBlendMode, Point texturePage, GLuint textureDepthShift, Point clut);
+    Vertex(Point point, Color color, Point texturePosition, TextureBlendMode textureBlendMode, Point texturePage, uint32_t textureDepthShift, Point clut);
     ~Vertex();
 };
 
+static_assert(sizeof(Vertex) == 16, "Vertices are uploaded as they are laid out");
+
 struct Pixel {
-    GLfloat pointX;
-    GLfloat pointY;
-    GLfloat framebufferPositionX;
-    GLfloat framebufferPositionY;
+    float pointX;
+    float pointY;
+    float framebufferPositionX;
+    float framebufferPositionY;
 
-    Pixel(GLfloat pointX, GLfloat pointY, GLfloat framebufferPositionX, GLfloat framebufferPositionY);
+    Pixel(float pointX, float pointY, float framebufferPositionX, float framebufferPositionY);
     ~Pixel();
 };
@@ -3,6 +3,7 @@
 #include <string>
 #include <cstdint>
 #include <Vertex.hpp>
+#include "VSyncMode.hpp"
 #include "Logger.hpp"
 
 class Window {
@@ -22,6 +23,9 @@ public:
     SDL_Window* getWindowRef();
     SDL_GLContext getGLContext();
     void makeCurrent();
+    SDL_GLContext createSharedContext();
+    // Applies to the window context, which has to be current
+    void setVSync(VSyncMode mode);
     Dimensions getDimensions();
     void handleSDLEvent(SDL_Event event);
     bool isHidden();
@@ -8,7 +8,7 @@ const uint32_t BIOS_C_FUNCTIONS_STEP = 0xC0;
 
 using namespace std;
 
-BIOS::BIOS(LogLevel logLevel) : data(), logger(logLevel, "  BIOS: ") {
+BIOS::BIOS(LogLevel logLevel) : memory(BIOS_SIZE), data(memory.getData()), logger(logLevel, "  BIOS: ") {
 
 }
 
@@ -20,9 +20,18 @@ void BIOS::loadBin(const std::filesystem::path& filePath) {
     readBinary(filePath, data);
 }
 
+uint8_t* BIOS::dataAtOffset(uint32_t offset) {
+    return &data[offset];
+}
+
+const SharedMemory& BIOS::getMemory() const {
+    return memory;
+}
+
 std::string BIOS::formatBIOSFunction(std::string function, unsigned int argc, std::array<uint32_t, 4> subroutineArguments) {
     if (argc > 4) {
         logger.logError("BIOS formatting incorrect function with argc: %d", argc);
+        return function;
     }
 
     stringstream ss;
@@ -1016,6 +1025,10 @@ optional<string> BIOS::checkCFunctions(uint32_t r9, array<uint32_t, 4> subroutin
     }
 }
 
+array<uint32_t, 3> BIOS::functionsStepAddresses() const {
+    return { BIOS_A_FUNCTIONS_STEP, BIOS_B_FUNCTIONS_STEP, BIOS_C_FUNCTIONS_STEP };
+}
+
 optional<string> BIOS::checkFunctions(uint32_t programCounter, uint32_t r9, array<uint32_t, 4> subroutineArguments) {
     optional<string> result;
     switch (programCounter) {
@@ -1,6 +1,7 @@
 #include "CDROM.hpp"
 #include "Helpers.hpp"
 #include "ConfigurationManager.hpp"
+#include "Constants.h"
 
 using namespace std;
 
@@ -13,10 +14,19 @@ The INT1 rate needs to be precise for CD-DA and CD-XA Audio streaming, exact clo
 should be: SystemClock*930h/4/44100Hz for Single Speed (and half as much for Double Speed)
 (the "Average" values are AVERAGE values, not exact values).
 */
-const uint32_t SystemClocksPerCDROMInt1SingleSpeed=2352;
-const uint32_t SystemClocksPerCDROMInt1DoubleSpeed=2352/2;
+const uint32_t SystemClocksPerCDROMInt1SingleSpeed=SystemClocksPerSecond*0x930/4/44100;
+const uint32_t SystemClocksPerCDROMInt1DoubleSpeed=SystemClocksPerCDROMInt1SingleSpeed/2;
 
-CDROM::CDROM(LogLevel logLevel, unique_ptr<InterruptController> &interruptController) : logger(logLevel, "  CD-ROM: "), interruptController(interruptController), image(), status(), interrupt(), statusCode(), mode(), parameters(), response(), interruptQueue(), seekSector(), readSector(), counter(), currentSector(), readBuffer(), readBufferIndex(), leftCDToLeftSPUVolume(), leftCDToRightSPUVolume(), rightCDToLeftSPUVolume() {
+/*
+1st Response Delay
+Command                Average   Min       Max
+GetStat (normal)       000c4e1h  0004a73h..003115bh
+Responses (and the next one after acknowledging) are delivered after the
+average delay of the most common command.
+*/
+const uint32_t SystemClocksPerCDROMResponse=0xc4e1;
+
+CDROM::CDROM(LogLevel logLevel, unique_ptr<InterruptController> &interruptController, unique_ptr<Scheduler> &scheduler) : logger(logLevel, "  CD-ROM: "), interruptController(interruptController), scheduler(scheduler), image(), status(), interrupt(), statusCode(), mode(), parameters(), response(), interruptQueue(), seekSector(), readSector(), currentSector(), readBuffer(), readBufferIndex(), leftCDToLeftSPUVolume(), leftCDToRightSPUVolume(), rightCDToLeftSPUVolume() {
 
 }
 
@@ -24,23 +34,37 @@ CDROM::~CDROM() {
 
 }
 
-void CDROM::step() {
+void CDROM::triggerInterrupt() {
     if (!interruptQueue.empty()) {
         if ((interrupt.enable & 0x7) & (interruptQueue.front() & 0x7)) {
             interruptController->trigger(InterruptRequestNumber::CDROMIRQ);
         }
     }
-    if ((statusCode.play || statusCode.read)) {
-        counter++;
-        if (counter >= SystemClocksPerCDROMInt1DoubleSpeed) {
-            interruptQueue.push(INT1);
-            pushResponse(statusCode._value);
-            counter = 0;
-
-            currentSector = image.readSector(readSector);
-            readSector++;
-        }
+}
+
+void CDROM::readNextSector() {
+    if (!(statusCode.play || statusCode.read)) {
+        return;
+    }
+    interruptQueue.push(INT1);
+    pushResponse(statusCode._value);
+
+    currentSector = image.readSector(readSector);
+    readSector++;
+
+    // Otherwise it gets delivered once the pending interrupts are acknowledged
+    if (interruptQueue.size() == 1) {
+        scheduler->schedule(CDROMInterruptEvent, 0);
+    }
+    scheduleNextSector();
+}
+
+void CDROM::scheduleNextSector() {
+    uint32_t cycles = SystemClocksPerCDROMInt1SingleSpeed;
+    if (mode.speed() == Double) {
+        cycles = SystemClocksPerCDROMInt1DoubleSpeed;
     }
+    scheduler->schedule(CDROMSectorEvent, cycles);
 }
 
 void CDROM::setStatusRegister(uint8_t value) {
@@ -51,6 +75,9 @@ void CDROM::setStatusRegister(uint8_t value) {
 void CDROM::setInterruptRegister(uint8_t value) {
     logger.logMessage("INTE [W]: %#x", value);
     interrupt.enable = value;
+    if (!interruptQueue.empty() && !scheduler->isScheduled(CDROMInterruptEvent)) {
+        scheduler->schedule(CDROMInterruptEvent, 0);
+    }
 }
 
 void CDROM::setInterruptFlagRegister(uint8_t value) {
@@ -62,6 +89,9 @@ void CDROM::setInterruptFlagRegister(uint8_t value) {
     if (!interruptQueue.empty()) {
         interruptQueue.pop();
     }
+    if (!interruptQueue.empty()) {
+        scheduler->schedule(CDROMInterruptEvent, SystemClocksPerCDROMResponse);
+    }
 }
 
 void CDROM::setRequestRegister(uint8_t value) {
@@ -146,6 +176,12 @@ void CDROM::execute(uint8_t value) {
     }
     clearParameters();
     updateStatusRegister();
+    if (!interruptQueue.empty() && !scheduler->isScheduled(CDROMInterruptEvent)) {
+        scheduler->schedule(CDROMInterruptEvent, SystemClocksPerCDROMResponse);
+    }
+    if ((statusCode.play || statusCode.read) && !scheduler->isScheduled(CDROMSectorEvent)) {
+        scheduleNextSector();
+    }
 }
 
 uint8_t CDROM::getStatusRegister() const {
@@ -4,10 +4,17 @@
 #include <iomanip>
 #include "CPU.tcc"
 #include "ConfigurationManager.hpp"
+#include "Recompiler.hpp"
+#include "Output.hpp"
 
 using namespace std;
 
-CPU::CPU(LogLevel logLevel, unique_ptr<Interconnect> &interconnect, unique_ptr<COP0> &cop0, bool logBiosFunctionCalls) : logger(logLevel),
+// Idle loops are short polling loops, longer blocks are not worth analyzing
+const size_t IDLE_LOOP_MAXIMUM_INSTRUCTIONS = 8;
+// Instructions are word aligned so this never matches a block address
+const uint32_t IDLE_LOOP_NONE = 0x1;
+
+CPU::CPU(LogLevel logLevel, unique_ptr<Interconnect> &interconnect, unique_ptr<COP0> &cop0, unique_ptr<Scheduler> &scheduler, unique_ptr<Debugger> &debugger, bool logBiosFunctionCalls) : logger(logLevel),
              programCounter(0xbfc00000),
              jumpDestination(0),
              isBranching(false),
@@ -17,8 +24,32 @@ CPU::CPU(LogLevel logLevel, unique_ptr<Interconnect> &interconnect, unique_ptr<C
              lowRegister(0),
              interconnect(interconnect),
              cop0(cop0),
+             scheduler(scheduler),
+             debugger(debugger),
              currentInstruction(Instruction(0x0)),
-             logBiosFunctionCalls(logBiosFunctionCalls)
+             logBiosFunctionCalls(logBiosFunctionCalls),
+             executionMode(CPUExecutionMode::Interpreter),
+             basicBlocks(),
+             currentBasicBlock(nullptr),
+             currentBasicBlockIndex(0),
+             currentBasicBlockProgramCounter(0),
+             invalidatedBasicBlocks(0),
+             recompiler(nullptr),
+             lockstep(false),
+             lockstepJournal(nullptr),
+             journal(make_unique<LockstepJournal>()),
+             recompiledBasicBlocks(0),
+             executionHooks(),
+             idleLoopSkipping(false),
+             idleLoopAddress(IDLE_LOOP_NONE),
+             idleLoopRegisters(),
+             skippedIdleCycles(0),
+             stallCycles(0),
+             multiplyDivideReadyCycle(0),
+             cycleCount(0),
+             blockElapsedCycles(0),
+             clockPercentage(100),
+             clockRemainder(0)
 {
     fill_n(registers, 32, 0);
 }
@@ -105,20 +136,33 @@ bool CPU::executeNextInstruction() {
         return false;
     }
 
-    Debugger *debugger = Debugger::getInstance();
     debugger->inspectCPU();
 
-    currentInstruction = Instruction(load<uint32_t>(programCounter));
+    const CachedInstruction *cachedInstruction = nullptr;
+    if (executionMode != CPUExecutionMode::Interpreter) {
+        cachedInstruction = nextCachedInstruction();
+    }
+    executeInstruction(cachedInstruction);
 
+    return true;
+}
+
+void CPU::executeInstruction(const CachedInstruction *cachedInstruction) {
     bool isBranchingCycle = isBranching;
 
-    decodeAndExecuteInstruction(currentInstruction);
+    if (cachedInstruction != nullptr) {
+        currentInstruction = cachedInstruction->instruction;
+        (this->*cachedInstruction->handler)(currentInstruction);
+    } else {
+        currentInstruction = Instruction(interconnect->load<uint32_t>(programCounter));
+        decodeAndExecuteInstruction(currentInstruction);
+    }
 
     moveLoadDelaySlots();
 
     if (runningException) {
         runningException = false;
-        return true;
+        return;
     }
 
     if (isBranchingCycle) {
@@ -128,10 +172,475 @@ bool CPU::executeNextInstruction() {
     } else {
         programCounter += 4;
     }
+}
+
+bool CPU::run(uint32_t cycleBudget, uint32_t &executedInstructions) {
+    executedInstructions = 0;
+    uint64_t start = scheduler->currentTimestamp();
+    // The debugger can only get attached in between batches
+    bool isDebuggerAttached = debugger->isAttached();
+    bool isIdle = false;
+    // Devices can schedule an earlier event while the CPU runs, so the deadline is checked every time
+    while (scheduler->currentTimestamp() - start < cycleBudget && !scheduler->isEventDue()) {
+        if (executedInstructions > 0 && isExecutionHook(programCounter)) {
+            break;
+        }
+        // Anything that has to be observed between two instructions goes through the step by step path
+        bool isBreakpointArmed = cop0->breakPointControl & (1 << 24);
+        if (isBreakpointArmed || isDebuggerAttached) {
+            idleLoopAddress = IDLE_LOOP_NONE;
+            uint32_t fetchCycles = interconnect->fetchCycles(programCounter);
+            if (!executeNextInstruction()) {
+                return false;
+            }
+            executedInstructions++;
+            advanceCycles(1 + fetchCycles + stallCycles);
+            stallCycles = 0;
+            continue;
+        }
+        // Delay slots left behind by a block split at a page boundary are interpreted
+        if (executionMode == CPUExecutionMode::DynamicRecompiler && !isBranching) {
+            if (cop0->areInterruptsPending()) {
+                triggerException(ExceptionType::Interrupt);
+                runningException = false;
+            }
+            uint32_t address = programCounter;
+            BasicBlock *basicBlock = lookupBasicBlock(address);
+            uint32_t executedBlockInstructions = 0;
+            if (basicBlock != nullptr) {
+                executedBlockInstructions = executeRecompiledBasicBlock(*basicBlock, address);
+            }
+            if (executedBlockInstructions > 0) {
+                executedInstructions += executedBlockInstructions;
+                // A block never crosses a page, so all its instructions come from the same region
+                advanceCycles(executedBlockInstructions * (1 + interconnect->fetchCycles(address)) + stallCycles);
+                stallCycles = 0;
+                if (isIdleLoopIteration(*basicBlock, address)) {
+                    isIdle = true;
+                    break;
+                }
+                continue;
+            }
+        }
+        if (cop0->areInterruptsPending()) {
+            triggerException(ExceptionType::Interrupt);
+        }
+        const CachedInstruction *cachedInstruction = nullptr;
+        if (executionMode != CPUExecutionMode::Interpreter) {
+            cachedInstruction = nextCachedInstruction();
+        }
+        uint32_t fetchCycles = interconnect->fetchCycles(programCounter);
+        executeInstruction(cachedInstruction);
+        executedInstructions++;
+        advanceCycles(1 + fetchCycles + stallCycles);
+        stallCycles = 0;
+        if (cachedInstruction == nullptr) {
+            idleLoopAddress = IDLE_LOOP_NONE;
+            continue;
+        }
+        size_t basicBlockSize = currentBasicBlock->instructions.size();
+        if (currentBasicBlockIndex == basicBlockSize) {
+            uint32_t address = currentBasicBlockProgramCounter - basicBlockSize * 4;
+            if (isIdleLoopIteration(*currentBasicBlock, address)) {
+                isIdle = true;
+                break;
+            }
+        }
+    }
+    uint64_t elapsedCycles = scheduler->currentTimestamp() - start;
+    if (isIdle && elapsedCycles < cycleBudget) {
+        // Nothing but a device can break the loop, so skip ahead to the next scheduled event
+        uint32_t skippedCycles = min<uint64_t>(cycleBudget - elapsedCycles, scheduler->cyclesUntilNextEvent());
+        scheduler->advance(skippedCycles);
+        skippedIdleCycles += skippedCycles;
+        cycleCount += static_cast<uint64_t>(skippedCycles) * clockPercentage / 100;
+    }
+    return true;
+}
+
+uint32_t CPU::executeRecompiledBasicBlock(BasicBlock &basicBlock, uint32_t address) {
+    RecompiledCode recompiledCode = recompiledCodeForBasicBlock(basicBlock, address);
+    if (recompiledCode == nullptr) {
+        return 0;
+    }
+    uint32_t executedInstructions = lockstep ? executeInLockstep(recompiledCode) : recompiledCode();
+    blockElapsedCycles = 0;
+    return executedInstructions;
+}
+
+// A loop that only computes registers out of loads and branches back, e.g. polling I_STAT for VBLANK
+bool CPU::isIdleLoopCandidate(const BasicBlock &basicBlock, uint32_t address) const {
+    size_t size = basicBlock.instructions.size();
+    if (size < 2 || size > IDLE_LOOP_MAXIMUM_INSTRUCTIONS) {
+        return false;
+    }
+    for (const CachedInstruction &cachedInstruction : basicBlock.instructions) {
+        Instruction instruction = cachedInstruction.instruction;
+        switch (instruction.funct) {
+            case 0b000000: {
+                switch (instruction.subfunct) {
+                    case 0b000000: case 0b000010: case 0b000011:
+                    case 0b000100: case 0b000110: case 0b000111:
+                    case 0b100001: case 0b100011: case 0b100100: case 0b100101:
+                    case 0b100110: case 0b100111: case 0b101010: case 0b101011: {
+                        break;
+                    }
+                    default: {
+                        return false;
+                    }
+                }
+                break;
+            }
+            case 0b000001: {
+                // BLTZAL and BGEZAL write the return address
+                if ((instruction.rt & 0x1e) == 0x10) {
+                    return false;
+                }
+                break;
+            }
+            case 0b000010: case 0b000100: case 0b000101: case 0b000110: case 0b000111:
+            case 0b001001: case 0b001010: case 0b001011: case 0b001100: case 0b001101: case 0b001110: case 0b001111:
+            case 0b100000: case 0b100001: case 0b100011: case 0b100100: case 0b100101: {
+                break;
+            }
+            default: {
+                return false;
+            }
+        }
+    }
+    uint32_t branchAddress = address + (size - 2) * 4;
+    Instruction branch = basicBlock.instructions[size - 2].instruction;
+    if (!branch.isBranchOrJump()) {
+        return false;
+    }
+    uint32_t destination;
+    if (branch.funct == 0b000010) {
+        destination = ((branchAddress + 4) & 0xf0000000) | (branch.immjump() << 2);
+    } else {
+        destination = branchAddress + 4 + (branch.immSE() << 2);
+    }
+    return destination == address;
+}
 
+// An iteration that leaves the registers exactly as the previous one did will keep doing so
+// until something else than the CPU changes what the loop reads
+bool CPU::isIdleLoopIteration(const BasicBlock &basicBlock, uint32_t address) {
+    if (!idleLoopSkipping || !basicBlock.isIdleLoopCandidate || programCounter != address || isBranching) {
+        idleLoopAddress = IDLE_LOOP_NONE;
+        return false;
+    }
+    bool areLoadSlotsEmpty = loadSlots[0].registerIndex == 0 && loadSlots[1].registerIndex == 0;
+    bool isSameState = idleLoopAddress == address && areLoadSlotsEmpty && equal(idleLoopRegisters.begin(), idleLoopRegisters.end(), registers);
+    if (!isSameState) {
+        idleLoopAddress = address;
+        copy(registers, registers + 32, idleLoopRegisters.begin());
+        return false;
+    }
+    if (!hasSideEffectFreeLoads(basicBlock)) {
+        idleLoopAddress = IDLE_LOOP_NONE;
+        return false;
+    }
     return true;
 }
 
+// Load addresses are known since the registers are the same on every iteration, except
+// for base registers written inside the loop, which are only followed through LUI
+bool CPU::hasSideEffectFreeLoads(const BasicBlock &basicBlock) const {
+    array<optional<uint32_t>, 32> writtenRegisters = {};
+    array<bool, 32> isWrittenRegister = {};
+    for (const CachedInstruction &cachedInstruction : basicBlock.instructions) {
+        Instruction instruction = cachedInstruction.instruction;
+        if (instruction.funct >= 0b100000) {
+            uint32_t base;
+            if (!isWrittenRegister[instruction.rs]) {
+                base = registers[instruction.rs];
+            } else if (writtenRegisters[instruction.rs]) {
+                base = *writtenRegisters[instruction.rs];
+            } else {
+                return false;
+            }
+            if (!interconnect->hasSideEffectFreeLoads(base + instruction.immSE())) {
+                return false;
+            }
+            isWrittenRegister[instruction.rt] = true;
+            writtenRegisters[instruction.rt] = nullopt;
+        } else if (instruction.funct == 0b001111) {
+            isWrittenRegister[instruction.rt] = true;
+            writtenRegisters[instruction.rt] = instruction.imm() << 16;
+        } else if (instruction.funct == 0b000000) {
+            isWrittenRegister[instruction.rd] = true;
+            writtenRegisters[instruction.rd] = nullopt;
+        } else if (instruction.funct >= 0b001000) {
+            isWrittenRegister[instruction.rt] = true;
+            writtenRegisters[instruction.rt] = nullopt;
+        }
+        isWrittenRegister[0] = false;
+    }
+    return true;
+}
+
+void CPU::addExecutionHook(uint32_t address) {
+    if (find(executionHooks.begin(), executionHooks.end(), address) == executionHooks.end()) {
+        executionHooks.push_back(address);
+    }
+}
+
+bool CPU::isExecutionHook(uint32_t address) const {
+    if (executionHooks.empty()) {
+        return false;
+    }
+    return find(executionHooks.begin(), executionHooks.end(), address) != executionHooks.end();
+}
+
+RecompiledCode CPU::recompiledCodeForBasicBlock(BasicBlock &basicBlock, uint32_t address) {
+    if (basicBlock.recompiledCode != nullptr || !basicBlock.isRecompilable) {
+        return basicBlock.recompiledCode;
+    }
+    RecompiledCode recompiledCode = recompiler->compile(basicBlock, address);
+    if (recompiledCode == nullptr && recompiler->isFull()) {
+        logger.logMessage("Recompiler code cache full, flushing");
+        flushRecompiledCode();
+        recompiledCode = recompiler->compile(basicBlock, address);
+    }
+    basicBlock.recompiledCode = recompiledCode;
+    basicBlock.isRecompilable = recompiledCode != nullptr;
+    if (recompiledCode != nullptr) {
+        recompiledBasicBlocks++;
+    }
+    return recompiledCode;
+}
+
+void CPU::flushRecompiledCode() {
+    recompiler->flush();
+    for (auto &entry : basicBlocks) {
+        entry.second.recompiledCode = nullptr;
+        entry.second.isRecompilable = true;
+    }
+}
+
+// Runs the recompiled block, then rewinds and runs the same number of instructions
+// on the interpreter, replaying the memory accesses recorded on the first run
+uint32_t CPU::executeInLockstep(RecompiledCode recompiledCode) {
+    CPUSnapshot initialState = snapshot();
+    lockstepJournal = journal.get();
+    lockstepJournal->startRecording();
+    uint32_t executedInstructions = recompiledCode();
+    CPUSnapshot recompiledState = snapshot();
+
+    restore(initialState);
+    lockstepJournal->startReplaying();
+    // Replayed like the recompiled code ran it, without advancing the clock in between
+    uint32_t instructionCycles = 1 + interconnect->fetchCycles(initialState.programCounter);
+    for (uint32_t i = 0; i < executedInstructions; i++) {
+        blockElapsedCycles = i * instructionCycles;
+        executeInstruction(nullptr);
+    }
+    optional<string> divergence = lockstepJournal->finishReplaying();
+    lockstepJournal = nullptr;
+    CPUSnapshot interpretedState = snapshot();
+
+    if (!divergence) {
+        divergence = compare(recompiledState, interpretedState);
+    }
+    if (divergence) {
+        logger.logError("Lockstep divergence in block at %#x (%d instructions): %s", initialState.programCounter, executedInstructions, (*divergence).c_str());
+    }
+    return executedInstructions;
+}
+
+CPUSnapshot CPU::snapshot() const {
+    CPUSnapshot snapshot = { {}, programCounter, jumpDestination, isBranching, loadSlots, highRegister, lowRegister, stallCycles, multiplyDivideReadyCycle, *cop0 };
+    copy(begin(registers), end(registers), begin(snapshot.registers));
+    return snapshot;
+}
+
+void CPU::restore(const CPUSnapshot &snapshot) {
+    copy(snapshot.registers.begin(), snapshot.registers.end(), begin(registers));
+    programCounter = snapshot.programCounter;
+    jumpDestination = snapshot.jumpDestination;
+    isBranching = snapshot.isBranching;
+    loadSlots = snapshot.loadSlots;
+    highRegister = snapshot.highRegister;
+    lowRegister = snapshot.lowRegister;
+    stallCycles = snapshot.stallCycles;
+    multiplyDivideReadyCycle = snapshot.multiplyDivideReadyCycle;
+    *cop0 = snapshot.cop0;
+    interconnect->updateCacheIsolation();
+}
+
+optional<string> CPU::compare(const CPUSnapshot &recompiled, const CPUSnapshot &interpreted) const {
+    for (uint32_t i = 0; i < 32; i++) {
+        if (recompiled.registers[i] != interpreted.registers[i]) {
+            return format("r%d is %#x, expected %#x", i, recompiled.registers[i], interpreted.registers[i]);
+        }
+    }
+    if (recompiled.programCounter != interpreted.programCounter) {
+        return format("pc is %#x, expected %#x", recompiled.programCounter, interpreted.programCounter);
+    }
+    if (recompiled.isBranching != interpreted.isBranching || recompiled.jumpDestination != interpreted.jumpDestination) {
+        return format("branch to %#x (%d), expected %#x (%d)", recompiled.jumpDestination, recompiled.isBranching, interpreted.jumpDestination, interpreted.isBranching);
+    }
+    for (uint32_t i = 0; i < 2; i++) {
+        const LoadSlot &recompiledSlot = recompiled.loadSlots[i];
+        const LoadSlot &interpretedSlot = interpreted.loadSlots[i];
+        if (recompiledSlot.registerIndex != interpretedSlot.registerIndex) {
+            return format("load slot %d targets r%d, expected r%d", i, recompiledSlot.registerIndex, interpretedSlot.registerIndex);
+        }
+        if (recompiledSlot.registerIndex != 0 && (recompiledSlot.value != interpretedSlot.value || recompiledSlot.previousValue != interpretedSlot.previousValue)) {
+            return format("load slot %d holds %#x, expected %#x", i, recompiledSlot.value, interpretedSlot.value);
+        }
+    }
+    if (recompiled.highRegister != interpreted.highRegister || recompiled.lowRegister != interpreted.lowRegister) {
+        return format("hi/lo are %#x/%#x, expected %#x/%#x", recompiled.highRegister, recompiled.lowRegister, interpreted.highRegister, interpreted.lowRegister);
+    }
+    if (recompiled.cop0.status.value != interpreted.cop0.status.value || recompiled.cop0.cause.value != interpreted.cop0.cause.value || recompiled.cop0.returnAddressFromTrap != interpreted.cop0.returnAddressFromTrap) {
+        return format("cop0 sr/cause/epc are %#x/%#x/%#x, expected %#x/%#x/%#x", recompiled.cop0.status.value, recompiled.cop0.cause.value, recompiled.cop0.returnAddressFromTrap, interpreted.cop0.status.value, interpreted.cop0.cause.value, interpreted.cop0.returnAddressFromTrap);
+    }
+    return nullopt;
+}
+
+void CPU::setExecutionMode(CPUExecutionMode mode) {
+    if (mode == CPUExecutionMode::DynamicRecompiler && !Recompiler::isSupported()) {
+        logger.logWarning("The recompiler isn't supported on this host, using the cached interpreter");
+        mode = CPUExecutionMode::CachedInterpreter;
+    }
+    if (mode == CPUExecutionMode::DynamicRecompiler && recompiler == nullptr) {
+        recompiler = make_unique<Recompiler>(LogLevel::Warning, this);
+    }
+    executionMode = mode;
+    currentBasicBlock = nullptr;
+}
+
+CPUExecutionMode CPU::getExecutionMode() {
+    return executionMode;
+}
+
+void CPU::setLockstep(bool enabled) {
+    // Recompiled memory accesses depend on the lockstep mode
+    if (enabled != lockstep && recompiler != nullptr) {
+        flushRecompiledCode();
+    }
+    lockstep = enabled;
+}
+
+bool CPU::isLockstepEnabled() {
+    return lockstep;
+}
+
+size_t CPU::basicBlockCount() {
+    return basicBlocks.size();
+}
+
+uint64_t CPU::invalidatedBasicBlockCount() {
+    return invalidatedBasicBlocks;
+}
+
+uint64_t CPU::recompiledBasicBlockCount() {
+    return recompiledBasicBlocks;
+}
+
+void CPU::setIdleLoopSkipping(bool enabled) {
+    idleLoopSkipping = enabled;
+    idleLoopAddress = IDLE_LOOP_NONE;
+}
+
+void CPU::setClockPercentage(uint32_t percentage) {
+    clockPercentage = clamp(percentage, CPU_MINIMUM_CLOCK_PERCENTAGE, CPU_MAXIMUM_CLOCK_PERCENTAGE);
+    clockRemainder = 0;
+}
+
+uint32_t CPU::getClockPercentage() {
+    return clockPercentage;
+}
+
+uint64_t CPU::skippedIdleCycleCount() {
+    return skippedIdleCycles;
+}
+
+bool CPU::hasPendingDelaySlot() {
+    return isBranching || loadSlots[0].registerIndex != 0 || loadSlots[1].registerIndex != 0;
+}
+
+void CPU::returnFromSubroutine(uint32_t returnValue) {
+    setRegisterAtIndex(2, returnValue);
+    programCounter = registers[31];
+}
+
+const CachedInstruction* CPU::nextCachedInstruction() {
+    bool isCursorValid = currentBasicBlock != nullptr &&
+                         programCounter == currentBasicBlockProgramCounter &&
+                         currentBasicBlockIndex < currentBasicBlock->instructions.size() &&
+                         isBasicBlockValid(*currentBasicBlock);
+    if (!isCursorValid) {
+        currentBasicBlock = lookupBasicBlock(programCounter);
+        currentBasicBlockIndex = 0;
+        currentBasicBlockProgramCounter = programCounter;
+        if (currentBasicBlock == nullptr) {
+            return nullptr;
+        }
+    }
+    const CachedInstruction *cachedInstruction = &currentBasicBlock->instructions[currentBasicBlockIndex];
+    currentBasicBlockIndex++;
+    currentBasicBlockProgramCounter += 4;
+    return cachedInstruction;
+}
+
+BasicBlock* CPU::lookupBasicBlock(uint32_t address) {
+    uint32_t physicalAddress = interconnect->maskRegion(address);
+    // Only memory without side effects on reads can be decoded ahead of time
+    bool isCacheable = ramRange.contains(physicalAddress) || biosRange.contains(physicalAddress) || expansion1Range.contains(physicalAddress);
+    if (!isCacheable) {
+        return nullptr;
+    }
+    auto iterator = basicBlocks.find(physicalAddress);
+    if (iterator != basicBlocks.end()) {
+        if (isBasicBlockValid(iterator->second)) {
+            return &iterator->second;
+        }
+        invalidatedBasicBlocks++;
+    }
+    BasicBlock &basicBlock = basicBlocks[physicalAddress];
+    compileBasicBlock(basicBlock, address);
+    return &basicBlock;
+}
+
+void CPU::compileBasicBlock(BasicBlock &basicBlock, uint32_t address) {
+    uint32_t physicalAddress = interconnect->maskRegion(address);
+    optional<uint32_t> ramOffset = ramRange.contains(physicalAddress);
+    basicBlock.instructions.clear();
+    basicBlock.recompiledCode = nullptr;
+    basicBlock.isRecompilable = true;
+    basicBlock.isIdleLoopCandidate = false;
+    basicBlock.isInRAM = ramOffset.has_value();
+    basicBlock.ramOffset = ramOffset.value_or(0);
+    if (basicBlock.isInRAM) {
+        interconnect->markCodeInRAM(basicBlock.ramOffset);
+        basicBlock.generation = interconnect->ramCodeGeneration(basicBlock.ramOffset);
+    } else {
+        basicBlock.generation = 0;
+    }
+
+    // Never cross a code page so a single generation covers the whole block
+    uint32_t instructionsUntilPageEnd = (RAM_CODE_PAGE_SIZE - (physicalAddress % RAM_CODE_PAGE_SIZE)) / 4;
+    bool isDelaySlot = false;
+    for (uint32_t i = 0; i < instructionsUntilPageEnd; i++) {
+        Instruction instruction = Instruction(interconnect->load<uint32_t>(address + i * 4));
+        basicBlock.instructions.push_back({ decodeInstruction(instruction), instruction });
+        if (isDelaySlot) {
+            break;
+        }
+        isDelaySlot = instruction.isBranchOrJump();
+    }
+    basicBlock.isIdleLoopCandidate = isIdleLoopCandidate(basicBlock, address);
+}
+
+bool CPU::isBasicBlockValid(const BasicBlock &basicBlock) const {
+    if (!basicBlock.isInRAM) {
+        return true;
+    }
+    return interconnect->ramCodeGeneration(basicBlock.ramOffset) == basicBlock.generation;
+}
+
 void CPU::loadDelaySlot(uint32_t registerIndex, uint32_t value) {
     if (registerIndex == 0) {
         return;
@@ -176,343 +685,106 @@ void CPU::setRegisterAtIndex(uint32_t index, uint32_t value) {
 }
 
 void CPU::decodeAndExecuteInstruction(Instruction instruction) {
-    switch (instruction.funct) {
-        case 0b000000: {
-            switch (instruction.subfunct) {
-                case 0b000000: {
-                    operationShiftLeftLogical(instruction);
-                    break;
-                }
-                case 0b000010: {
-                    operationShiftRightLogical(instruction);
-                    break;
-                }
-                case 0b000011: {
-                    operationShiftRightArithmetic(instruction);
-                    break;
-                }
-                case 0b000100: {
-                    operationShiftLeftLogicalVariable(instruction);
-                    break;
-                }
-                case 0b000110: {
-                    operationShiftRightLogicalVariable(instruction);
-                    break;
-                }
-                case 0b000111: {
-                    operationShiftRightArithmeticVariable(instruction);
-                    break;
-                }
-                case 0b001000: {
-                    operationJumpRegister(instruction);
-                    break;
-                }
-                case 0b001001: {
-                    operationJumpAndLinkRegister(instruction);
-                    break;
-                }
-                case 0b001100: {
-                    operationSystemCall(instruction);
-                    break;
-                }
-                case 0b001101: {
-                    operationBreak(instruction);
-                    break;
-                }
-                case 0b010000: {
-                    operationMoveFromHighRegister(instruction);
-                    break;
-                }
-                case 0b010001: {
-                    operationMoveToHighRegister(instruction);
-                    break;
-                }
-                case 0b010010: {
-                    operationMoveFromLowRegister(instruction);
-                    break;
-                }
-                case 0b010011: {
-                    operationMoveToLowRegister(instruction);
-                    break;
-                }
-                case 0b011000: {
-                    operationMultiply(instruction);
-                    break;
-                }
-                case 0b011001: {
-                    operationMultiplyUnsigned(instruction);
-                    break;
-                }
-                case 0b011010: {
-                    operationDivision(instruction);
-                    break;
-                }
-                case 0b011011: {
-                    operationDivisionUnsigned(instruction);
-                    break;
-                }
-                case 0b100000: {
-                    operationAdd(instruction);
-                    break;
-                }
-                case 0b100001: {
-                    operationAddUnsigned(instruction);
-                    break;
-                }
-                case 0b100010: {
-                    operationSubstract(instruction);
-                    break;
-                }
-                case 0b100011: {
-                    operationSubstractUnsigned(instruction);
-                    break;
-                }
-                case 0b100100: {
-                    operationBitwiseAnd(instruction);
-                    break;
-                }
-                case 0b100101: {
-                    operationBitwiseOr(instruction);
-                    break;
-                }
-                case 0b100110: {
-                    operationBitwiseExclusiveOr(instruction);
-                    break;
-                }
-                case 0b100111: {
-                    operationBitwiseNotOr(instruction);
-                    break;
-                }
-                case 0b101010: {
-                    operationSetOnLessThan(instruction);
-                    break;
-                }
-                case 0b101011: {
-                    operationSetOnLessThanUnsigned(instruction);
-                    break;
-                }
-                default: {
-                    operationIllegal(instruction);
-                    break;
-                }
-            }
-            break;
-        }
-        case 0b000001: {
-            operationsMultipleBranchIf(instruction);
-            break;
-        }
-        case 0b000010: {
-            operationJump(instruction);
-            break;
-        }
-        case 0b000011: {
-            operationJumpAndLink(instruction);
-            break;
-        }
-        case 0b000100: {
-            operationBranchIfEqual(instruction);
-            break;
-        }
-        case 0b000101: {
-            operationBranchIfNotEqual(instruction);
-            break;
-        }
-        case 0b000110: {
-            operationBranchIfLessThanOrEqualToZero(instruction);
-            break;
-        }
-        case 0b000111: {
-            operationBranchIfGreaterThanZero(instruction);
-            break;
-        }
-        case 0b001000: {
-            operationAddImmediate(instruction);
-            break;
-        }
-        case 0b01001: {
-            operationAddImmediateUnsigned(instruction);
-            break;
-        }
-        case 0b001010: {
-            operationSetIfLessThanImmediate(instruction);
-            break;
-        }
-        case 0b001011: {
-            operationSetIfLessThanImmediateUnsigned(instruction);
-            break;
-        }
-        case 0b001100: {
-            operationBitwiseAndImmediate(instruction);
-            break;
-        }
-        case 0b001101: {
-            operationBitwiseOrImmediate(instruction);
-            break;
-        }
-        case 0b001110: {
-            operationBitwiseExclusiveOrImmediate(instruction);
-            break;
-        }
-        case 0b001111: {
-            operationLoadUpperImmediate(instruction);
-            break;
-        }
-        case 0b010000: {
-            operationCoprocessor0(instruction);
-            break;
-        }
-        case 0b010001: {
-            operationCoprocessor1(instruction);
-            break;
-        }
-        case 0b010010: {
-            operationCoprocessor2(instruction);
-            break;
-        }
-        case 0b010011: {
-            operationCoprocessor3(instruction);
-            break;
-        }
-        case 0b100000: {
-            operationLoadByte(instruction);
-            break;
-        }
-        case 0b100001: {
-            operationLoadHalfWord(instruction);
-            break;
-        }
-        case 0b100010: {
-            operationLoadWordLeft(instruction);
-            break;
-        }
-        case 0b100011: {
-            operationLoadWord(instruction);
-            break;
-        }
-        case 0b100100: {
-            operationLoadByteUnsigned(instruction);
-            break;
-        }
-        case 0b100101: {
-            operationLoadHalfWordUnsigned(instruction);
-            break;
-        }
-        case 0b100110: {
-            operationLoadWordRight(instruction);
-            break;
-        }
-        case 0b101000: {
-            operationStoreByte(instruction);
-            break;
-        }
-        case 0b101001: {
-            operationStoreHalfWord(instruction);
-            break;
-        }
-        case 0b101010: {
-            operationStoreWordLeft(instruction);
-            break;
-        }
-        case 0b101011: {
-            operationStoreWord(instruction);
-            break;
-        }
-        case 0b101110: {
-            operationStoreWordRight(instruction);
-            break;
-        }
-        case 0b110000: {
-            operationLoadWordCoprocessor0(instruction);
-            break;
-        }
-        case 0b110001: {
-            operationLoadWordCoprocessor1(instruction);
-            break;
-        }
-        case 0b110010: {
-            operationLoadWordCoprocessor2(instruction);
-            break;
-        }
-        case 0b110011: {
-            operationLoadWordCoprocessor3(instruction);
-            break;
-        }
-        case 0b111000: {
-            operationStoreWordCoprocessor0(instruction);
-            break;
-        }
-        case 0b111001: {
-            operationStoreWordCoprocessor1(instruction);
-            break;
-        }
-        case 0b111010: {
-            operationStoreWordCoprocessor2(instruction);
-            break;
-        }
-        case 0b111011: {
-            operationStoreWordCoprocessor3(instruction);
-            break;
-        }
-        default: {
-            operationIllegal(instruction);
-            break;
-        }
-    }
+    InstructionHandler handler = decodeInstruction(instruction);
+    (this->*handler)(instruction);
 }
 
-void CPU::operationShiftLeftLogical(Instruction instruction) {
-    uint32_t imm = instruction.shiftimm;
-    uint32_t rt = instruction.rt;
-    uint32_t rd = instruction.rd;
-
-    uint32_t value = registerAtIndex(rt) << imm;
-    setRegisterAtIndex(rd, value);
-}
-
-void CPU::operationShiftRightLogical(Instruction instruction) {
-    uint32_t imm = instruction.shiftimm;
-    uint32_t rt = instruction.rt;
-    uint32_t rd = instruction.rd;
-
-    uint32_t value = registerAtIndex(rt) >> imm;
-    setRegisterAtIndex(rd, value);
-}
-
-void CPU::operationShiftRightArithmetic(Instruction instruction) {
-    uint32_t imm = instruction.shiftimm;
-    uint32_t rt = instruction.rt;
-    uint32_t rd = instruction.rd;
-
-    uint32_t value = ((int32_t)registerAtIndex(rt)) >> imm;
-    setRegisterAtIndex(rd, value);
-}
-
-void CPU::operationShiftLeftLogicalVariable(Instruction instruction) {
-    uint32_t rd = instruction.rd;
-    uint32_t rs = instruction.rs;
-    uint32_t rt = instruction.rt;
-
-    uint32_t value = registerAtIndex(rt) << (registerAtIndex(rs) & 0x1f);
-    setRegisterAtIndex(rd, value);
+constexpr array<InstructionHandler, 64> CPU::makePrimaryOpcodeHandlers() {
+    array<InstructionHandler, 64> handlers = {};
+    for (InstructionHandler &handler : handlers) {
+        handler = &CPU::operationIllegal;
+    }
+    handlers[0b000000] = &CPU::operationSpecial;
+    handlers[0b000001] = &CPU::operationsMultipleBranchIf;
+    handlers[0b000010] = &CPU::operationJump;
+    handlers[0b000011] = &CPU::operationJumpAndLink;
+    handlers[0b000100] = &CPU::operationBranchIfEqual;
+    handlers[0b000101] = &CPU::operationBranchIfNotEqual;
+    handlers[0b000110] = &CPU::operationBranchIfLessThanOrEqualToZero;
+    handlers[0b000111] = &CPU::operationBranchIfGreaterThanZero;
+    handlers[0b001000] = &CPU::operationAddImmediate;
+    handlers[0b001001] = &CPU::operationImmediate<AddOperation, true>;
+    handlers[0b001010] = &CPU::operationImmediate<SetOnLessThanOperation, true>;
+    handlers[0b001011] = &CPU::operationImmediate<SetOnLessThanUnsignedOperation, true>;
+    handlers[0b001100] = &CPU::operationImmediate<AndOperation, false>;
+    handlers[0b001101] = &CPU::operationImmediate<OrOperation, false>;
+    handlers[0b001110] = &CPU::operationImmediate<ExclusiveOrOperation, false>;
+    handlers[0b001111] = &CPU::operationLoadUpperImmediate;
+    handlers[0b010000] = &CPU::operationCoprocessor0;
+    handlers[0b010001] = &CPU::operationCoprocessor1;
+    handlers[0b010010] = &CPU::operationCoprocessor2;
+    handlers[0b010011] = &CPU::operationCoprocessor3;
+    handlers[0b100000] = &CPU::operationLoadByte;
+    handlers[0b100001] = &CPU::operationLoadHalfWord;
+    handlers[0b100010] = &CPU::operationLoadWordLeft;
+    handlers[0b100011] = &CPU::operationLoadWord;
+    handlers[0b100100] = &CPU::operationLoadByteUnsigned;
+    handlers[0b100101] = &CPU::operationLoadHalfWordUnsigned;
+    handlers[0b100110] = &CPU::operationLoadWordRight;
+    handlers[0b101000] = &CPU::operationStoreByte;
+    handlers[0b101001] = &CPU::operationStoreHalfWord;
+    handlers[0b101010] = &CPU::operationStoreWordLeft;
+    handlers[0b101011] = &CPU::operationStoreWord;
+    handlers[0b101110] = &CPU::operationStoreWordRight;
+    handlers[0b110000] = &CPU::operationLoadWordCoprocessor0;
+    handlers[0b110001] = &CPU::operationLoadWordCoprocessor1;
+    handlers[0b110010] = &CPU::operationLoadWordCoprocessor2;
+    handlers[0b110011] = &CPU::operationLoadWordCoprocessor3;
+    handlers[0b111000] = &CPU::operationStoreWordCoprocessor0;
+    handlers[0b111001] = &CPU::operationStoreWordCoprocessor1;
+    handlers[0b111010] = &CPU::operationStoreWordCoprocessor2;
+    handlers[0b111011] = &CPU::operationStoreWordCoprocessor3;
+    return handlers;
+}
+
+constexpr array<InstructionHandler, 64> CPU::makeSecondaryOpcodeHandlers() {
+    array<InstructionHandler, 64> handlers = {};
+    for (InstructionHandler &handler : handlers) {
+        handler = &CPU::operationIllegal;
+    }
+    handlers[0b000000] = &CPU::operationShiftImmediate<ShiftLeftLogicalOperation>;
+    handlers[0b000010] = &CPU::operationShiftImmediate<ShiftRightLogicalOperation>;
+    handlers[0b000011] = &CPU::operationShiftImmediate<ShiftRightArithmeticOperation>;
+    handlers[0b000100] = &CPU::operationShiftVariable<ShiftLeftLogicalOperation>;
+    handlers[0b000110] = &CPU::operationShiftVariable<ShiftRightLogicalOperation>;
+    handlers[0b000111] = &CPU::operationShiftVariable<ShiftRightArithmeticOperation>;
+    handlers[0b001000] = &CPU::operationJumpRegister;
+    handlers[0b001001] = &CPU::operationJumpAndLinkRegister;
+    handlers[0b001100] = &CPU::operationSystemCall;
+    handlers[0b001101] = &CPU::operationBreak;
+    handlers[0b010000] = &CPU::operationMoveFromHighRegister;
+    handlers[0b010001] = &CPU::operationMoveToHighRegister;
+    handlers[0b010010] = &CPU::operationMoveFromLowRegister;
+    handlers[0b010011] = &CPU::operationMoveToLowRegister;
+    handlers[0b011000] = &CPU::operationMultiply;
+    handlers[0b011001] = &CPU::operationMultiplyUnsigned;
+    handlers[0b011010] = &CPU::operationDivision;
+    handlers[0b011011] = &CPU::operationDivisionUnsigned;
+    handlers[0b100000] = &CPU::operationAdd;
+    handlers[0b100001] = &CPU::operationRegister<AddOperation>;
+    handlers[0b100010] = &CPU::operationSubstract;
+    handlers[0b100011] = &CPU::operationRegister<SubtractOperation>;
+    handlers[0b100100] = &CPU::operationRegister<AndOperation>;
+    handlers[0b100101] = &CPU::operationRegister<OrOperation>;
+    handlers[0b100110] = &CPU::operationRegister<ExclusiveOrOperation>;
+    handlers[0b100111] = &CPU::operationRegister<NotOrOperation>;
+    handlers[0b101010] = &CPU::operationRegister<SetOnLessThanOperation>;
+    handlers[0b101011] = &CPU::operationRegister<SetOnLessThanUnsignedOperation>;
+    return handlers;
+}
+
+const array<InstructionHandler, 64> CPU::primaryOpcodeHandlers = CPU::makePrimaryOpcodeHandlers();
+const array<InstructionHandler, 64> CPU::secondaryOpcodeHandlers = CPU::makeSecondaryOpcodeHandlers();
+
+InstructionHandler CPU::decodeInstruction(Instruction instruction) const {
+    if (instruction.funct == 0b000000) {
+        return secondaryOpcodeHandlers[instruction.subfunct];
+    }
+    return primaryOpcodeHandlers[instruction.funct];
 }
 
-void CPU::operationShiftRightLogicalVariable(Instruction instruction) {
-    uint32_t rd = instruction.rd;
-    uint32_t rs = instruction.rs;
-    uint32_t rt = instruction.rt;
-
-    uint32_t value = registerAtIndex(rt) >> (registerAtIndex(rs) & 0x1f);
-    setRegisterAtIndex(rd, value);
-}
-
-void CPU::operationShiftRightArithmeticVariable(Instruction instruction) {
-    uint32_t rd = instruction.rd;
-    uint32_t rs = instruction.rs;
-    uint32_t rt = instruction.rt;
-
-    uint32_t value = ((int32_t)registerAtIndex(rt)) >> (registerAtIndex(rs) & 0x1f);
-    setRegisterAtIndex(rd, value);
+void CPU::operationSpecial(Instruction instruction) {
+    (this->*secondaryOpcodeHandlers[instruction.subfunct])(instruction);
 }
 
 void CPU::operationJumpRegister(Instruction instruction) {
@@ -559,8 +831,28 @@ void CPU::operationBreak(Instruction instruction) {
     triggerException(ExceptionType::Breakpoint);
 }
 
+// A new MULT or DIV also waits for the one in progress
+void CPU::startMultiplyDivide(uint32_t cycles) {
+    waitForMultiplyDivide();
+    multiplyDivideReadyCycle = currentCycle() + cycles;
+}
+
+// Reading hi/lo stalls the pipeline until the result is there
+void CPU::waitForMultiplyDivide() {
+    uint64_t cycle = currentCycle();
+    if (multiplyDivideReadyCycle > cycle) {
+        stallCycles += multiplyDivideReadyCycle - cycle;
+    }
+}
+
+// Latencies are in CPU cycles, so they're measured on the CPU's own count and not in system clocks
+uint64_t CPU::currentCycle() const {
+    return cycleCount + blockElapsedCycles + stallCycles;
+}
+
 void CPU::operationMoveFromHighRegister(Instruction instruction) {
     uint32_t rd = instruction.rd;
+    waitForMultiplyDivide();
     uint32_t high = highRegister;
 
     setRegisterAtIndex(rd, high);
@@ -574,6 +866,7 @@ void CPU::operationMoveToHighRegister(Instruction instruction) {
 
 void CPU::operationMoveFromLowRegister(Instruction instruction) {
     uint32_t rd = instruction.rd;
+    waitForMultiplyDivide();
     uint32_t low = lowRegister;
 
     setRegisterAtIndex(rd, low);
@@ -592,6 +885,9 @@ void CPU::operationMultiply(Instruction instruction) {
     int64_t s = ((int32_t)registerAtIndex(rs));
     int64_t t = ((int32_t)registerAtIndex(rt));
 
+    // The multiplier finishes early when rs has few significant bits
+    uint32_t magnitude = s < 0 ? ~((uint32_t)s) : (uint32_t)s;
+    startMultiplyDivide(magnitude < 0x800 ? 6 : magnitude < 0x100000 ? 9 : 13);
     uint64_t result = s * t;
     highRegister = ((uint32_t)(result >> 32));
     lowRegister = ((uint32_t)result & 0xFFFFFFFF);
@@ -604,6 +900,7 @@ void CPU::operationMultiplyUnsigned(Instruction instruction) {
     uint64_t s = registerAtIndex(rs);
     uint64_t t = registerAtIndex(rt);
 
+    startMultiplyDivide(s < 0x800 ? 6 : s < 0x100000 ? 9 : 13);
     uint64_t result = s * t;
     highRegister = ((uint32_t)(result >> 32));
     lowRegister = ((uint32_t)result & 0xFFFFFFFF);
@@ -616,6 +913,7 @@ void CPU::operationDivision(Instruction instruction) {
     int32_t n = registerAtIndex(rs);
     int32_t d = registerAtIndex(rt);
 
+    startMultiplyDivide(36);
     if (d == 0) {
         highRegister = (uint32_t)n;
         if (n >= 0) {
@@ -639,6 +937,7 @@ void CPU::operationDivisionUnsigned(Instruction instruction) {
     uint32_t n = registerAtIndex(rs);
     uint32_t d = registerAtIndex(rt);
 
+    startMultiplyDivide(36);
     if (d == 0) {
         highRegister = n;
         lowRegister = 0xffffffff;
@@ -665,15 +964,6 @@ void CPU::operationAdd(Instruction instruction) {
     setRegisterAtIndex(rd, result);
 }
 
-void CPU::operationAddUnsigned(Instruction instruction) {
-    uint32_t rs = instruction.rs;
-    uint32_t rt = instruction.rt;
-    uint32_t rd = instruction.rd;
-
-    uint32_t value = registerAtIndex(rs) + registerAtIndex(rt);
-    setRegisterAtIndex(rd, value);
-}
-
 void CPU::operationSubstract(Instruction instruction) {
     uint32_t rs = instruction.rs;
     uint32_t rt = instruction.rt;
@@ -690,71 +980,6 @@ void CPU::operationSubstract(Instruction instruction) {
     }
 }
 
-void CPU::operationSubstractUnsigned(Instruction instruction) {
-    uint32_t rs = instruction.rs;
-    uint32_t rt = instruction.rt;
-    uint32_t rd = instruction.rd;
-
-    uint32_t value = registerAtIndex(rs) - registerAtIndex(rt);
-    setRegisterAtIndex(rd, value);
-}
-
-void CPU::operationBitwiseAnd(Instruction instruction) {
-    uint32_t rd = instruction.rd;
-    uint32_t rs = instruction.rs;
-    uint32_t rt = instruction.rt;
-
-    uint32_t value = registerAtIndex(rs) & registerAtIndex(rt);
-    setRegisterAtIndex(rd, value);
-}
-
-void CPU::operationBitwiseOr(Instruction instruction) {
-    uint32_t rd = instruction.rd;
-    uint32_t rs = instruction.rs;
-    uint32_t rt = instruction.rt;
-
-    uint32_t value = registerAtIndex(rs) | registerAtIndex(rt);
-    setRegisterAtIndex(rd, value);
-}
-
-void CPU::operationBitwiseExclusiveOr(Instruction instruction) {
-    uint32_t rd = instruction.rd;
-    uint32_t rs = instruction.rs;
-    uint32_t rt = instruction.rt;
-
-    uint32_t value = registerAtIndex(rs) ^ registerAtIndex(rt);
-    setRegisterAtIndex(rd, value);
-}
-
-void CPU::operationBitwiseNotOr(Instruction instruction) {
-    uint32_t rd = instruction.rd;
-    uint32_t rs = instruction.rs;
-    uint32_t rt = instruction.rt;
-
-    uint32_t value = ~(registerAtIndex(rs) | registerAtIndex(rt));
-    setRegisterAtIndex(rd, value);
-}
-
-void CPU::operationSetOnLessThan(Instruction instruction) {
-    uint32_t rd = instruction.rd;
-    uint32_t rs = instruction.rs;
-    uint32_t rt = instruction.rt;
-
-    int32_t s = (int32_t)registerAtIndex(rs);
-    int32_t t = (int32_t)registerAtIndex(rt);
-    uint32_t value = s < t;
-    setRegisterAtIndex(rd, value);
-}
-
-void CPU::operationSetOnLessThanUnsigned(Instruction instruction) {
-    uint32_t rd = instruction.rd;
-    uint32_t rs = instruction.rs;
-    uint32_t rt = instruction.rt;
-
-    uint32_t value = registerAtIndex(rs) < registerAtIndex(rt);
-    setRegisterAtIndex(rd, value);
-}
-
 void CPU::operationIllegal(Instruction instruction) {
     // TODO: unused
     (void)instruction;
@@ -856,62 +1081,6 @@ void CPU::operationAddImmediate(Instruction instruction) {
     }
 }
 
-void CPU::operationAddImmediateUnsigned(Instruction instruction) {
-    uint32_t imm = instruction.immSE();
-    uint32_t rt = instruction.rt;
-    uint32_t rs = instruction.rs;
-
-    uint32_t value = registerAtIndex(rs) + imm;
-    setRegisterAtIndex(rt, value);
-}
-
-void CPU::operationSetIfLessThanImmediate(Instruction instruction) {
-    int32_t imm = instruction.immSE();
-    uint32_t rs = instruction.rs;
-    uint32_t rt = instruction.rt;
-
-    uint32_t value = ((int32_t)registerAtIndex(rs)) < imm;
-    setRegisterAtIndex(rt, value);
-}
-
-void CPU::operationSetIfLessThanImmediateUnsigned(Instruction instruction) {
-    uint32_t imm = instruction.immSE();
-    uint32_t rs = instruction.rs;
-    uint32_t rt = instruction.rt;
-
-    uint32_t value = registerAtIndex(rs) < imm;
-    setRegisterAtIndex(rt, value);
-}
-
-void CPU::operationBitwiseAndImmediate(Instruction instruction) {
-    uint32_t imm = instruction.imm();
-    uint32_t rt = instruction.rt;
-    uint32_t rs = instruction.rs;
-
-    uint32_t value = registerAtIndex(rs) & imm;
-
-    setRegisterAtIndex(rt, value);
-}
-
-void CPU::operationBitwiseOrImmediate(Instruction instruction) {
-    uint32_t imm = instruction.imm();
-    uint32_t rt = instruction.rt;
-    uint32_t rs = instruction.rs;
-
-    uint32_t value = registerAtIndex(rs) | imm;
-
-    setRegisterAtIndex(rt, value);
-}
-
-void CPU::operationBitwiseExclusiveOrImmediate(Instruction instruction) {
-    uint32_t imm = instruction.imm();
-    uint32_t rt = instruction.rt;
-    uint32_t rs = instruction.rs;
-
-    uint32_t value = registerAtIndex(rs) ^ imm;
-    setRegisterAtIndex(rt, value);
-}
-
 void CPU::operationLoadUpperImmediate(Instruction instruction) {
     uint32_t imm = instruction.imm();
     uint32_t rt = instruction.rt;
@@ -1039,6 +1208,7 @@ void CPU::operationMoveToCoprocessor0(Instruction instruction) {
         }
         case 12: {
             cop0->status.value = value;
+            interconnect->updateCacheIsolation();
             break;
         }
         case 13: {
@@ -1088,7 +1258,7 @@ void CPU::operationLoadByte(Instruction instruction) {
     uint32_t rs = instruction.rs;
 
     uint32_t address = registerAtIndex(rs) + imm;
-    uint32_t value = ((int32_t)(load<uint8_t>(address) << 24)) >> 24;
+    uint32_t value = ((int32_t)(loadData<uint8_t>(address) << 24)) >> 24;
     loadDelaySlot(rt, value);
 }
 
@@ -1103,7 +1273,7 @@ void CPU::operationLoadHalfWord(Instruction instruction) {
         triggerException(ExceptionType::LoadAddress);
         return;
     }
-    uint32_t value = ((int16_t)load<uint16_t>(address));
+    uint32_t value = ((int16_t)loadData<uint16_t>(address));
     loadDelaySlot(rt, value);
 }
 
@@ -1121,7 +1291,7 @@ void CPU::operationLoadWordLeft(Instruction instruction) {
     }
 
     uint32_t alignedAddress = address & 0xfffffffc;
-    uint32_t alignedWord = load<uint32_t>(alignedAddress);
+    uint32_t alignedWord = loadData<uint32_t>(alignedAddress);
 
     uint32_t value;
     switch (address & 3) {
@@ -1157,7 +1327,7 @@ void CPU::operationLoadWord(Instruction instruction) {
         triggerException(ExceptionType::LoadAddress);
         return;
     }
-    uint32_t value = load<uint32_t>(address);
+    uint32_t value = loadData<uint32_t>(address);
     loadDelaySlot(rt, value);
 }
 
@@ -1167,7 +1337,7 @@ void CPU::operationLoadByteUnsigned(Instruction instruction) {
     uint32_t rs = instruction.rs;
 
     uint32_t address = registerAtIndex(rs) + imm;
-    uint32_t value = load<uint8_t>(address);
+    uint32_t value = loadData<uint8_t>(address);
     loadDelaySlot(rt, value);
 }
 
@@ -1182,7 +1352,7 @@ void CPU::operationLoadHalfWordUnsigned(Instruction instruction) {
         triggerException(ExceptionType::LoadAddress);
         return;
     }
-    uint32_t value = load<uint16_t>(address);
+    uint32_t value = loadData<uint16_t>(address);
     loadDelaySlot(rt, value);
 }
 
@@ -1200,7 +1370,7 @@ void CPU::operationLoadWordRight(Instruction instruction) {
     }
 
     uint32_t alignedAddress = address & 0xfffffffc;
-    uint32_t alignedWord = load<uint32_t>(alignedAddress);
+    uint32_t alignedWord = loadData<uint32_t>(alignedAddress);
 
     uint32_t value;
     switch (address & 3) {
@@ -1225,7 +1395,7 @@ void CPU::operationLoadWordRight(Instruction instruction) {
     loadDelaySlot(rt, value);
 }
 
-void CPU::operationStoreByte(Instruction instruction) const {
+void CPU::operationStoreByte(Instruction instruction) {
     uint32_t imm = instruction.immSE();
     uint32_t rt = instruction.rt;
     uint32_t rs = instruction.rs;
@@ -0,0 +1,29 @@
+#include "CPUExecutionMode.hpp"
+
+using namespace std;
+
+CPUExecutionMode cpuExecutionModeWithValue(string value) {
+    if (value.compare("INTERPRETER") == 0) {
+        return CPUExecutionMode::Interpreter;
+    } else if (value.compare("CACHED") == 0) {
+        return CPUExecutionMode::CachedInterpreter;
+    } else if (value.compare("RECOMPILER") == 0) {
+        return CPUExecutionMode::DynamicRecompiler;
+    }
+    return CPUExecutionMode::Interpreter;
+}
+
+string cpuExecutionModeName(CPUExecutionMode mode) {
+    switch (mode) {
+        case CPUExecutionMode::Interpreter: {
+            return "Interpreter";
+        }
+        case CPUExecutionMode::CachedInterpreter: {
+            return "Cached interpreter";
+        }
+        case CPUExecutionMode::DynamicRecompiler: {
+            return "Recompiler";
+        }
+    }
+    return "Unknown";
+}
@@ -5,7 +5,7 @@ using namespace std;
 
 const string configurationFile = "config.yaml";
 
-ConfigurationManager::ConfigurationManager() : logger(LogLevel::Warning, "", false), filePath(filesystem::current_path() / configurationFile), ctrllerName(""), resizeWindowToFitFramefuffer(false), showDebugInfoWindow(false),  bios(NoLog), cdrom(NoLog), interconnect(NoLog), cpu(NoLog), gpu(NoLog), opengl(NoLog), dma(NoLog), controller(NoLog), interrupt(NoLog), trace(false) {}
+ConfigurationManager::ConfigurationManager() : logger(LogLevel::Warning, "", false), filePath(filesystem::current_path() / configurationFile), ctrllerName(""), resizeWindowToFitFramefuffer(false), showDebugInfoWindow(false), cpuMode(Interpreter), cpuLockstep(false), cpuIdleLoopSkipping(false), cpuClock(100), biosHighLevelEmulation(false), fastmem(false), gpuThread(false), throttle(true), vsync(AdaptiveVSync), bios(NoLog), cdrom(NoLog), interconnect(NoLog), cpu(NoLog), gpu(NoLog), opengl(NoLog), dma(NoLog), controller(NoLog), interrupt(NoLog), trace(false) {}
 
 ConfigurationManager* ConfigurationManager::instance = nullptr;
 
@@ -41,6 +41,15 @@ void ConfigurationManager::setupConfigurationFile() {
     configurationRef["controllerName"] = "Sony Interactive Entertainment Controller";
     configurationRef["debugInfoWindow"] = "false";
     configurationRef["showFramebuffer"] = "false";
+    configurationRef["cpuExecutionMode"] = "INTERPRETER";
+    configurationRef["cpuLockstep"] = "false";
+    configurationRef["cpuIdleLoopSkipping"] = "true";
+    configurationRef["cpuClockPercentage"] = "100";
+    configurationRef["biosHighLevelEmulation"] = "false";
+    configurationRef["fastmem"] = "false";
+    configurationRef["gpuThread"] = "false";
+    configurationRef["throttle"] = "true";
+    configurationRef["vsync"] = "ADAPTIVE";
     Yaml::Serialize(configuration, filePath.string().c_str());
 }
 
@@ -50,6 +59,15 @@ void ConfigurationManager::loadConfiguration() {
     ctrllerName = configuration["controllerName"].As<string>();
     resizeWindowToFitFramefuffer = configuration["showFramebuffer"].As<bool>();
     showDebugInfoWindow = configuration["debugInfoWindow"].As<bool>();
+    cpuMode = cpuExecutionModeWithValue(configuration["cpuExecutionMode"].As<string>());
+    cpuLockstep = configuration["cpuLockstep"].As<bool>();
+    cpuIdleLoopSkipping = configuration["cpuIdleLoopSkipping"].As<bool>();
+    cpuClock = configuration["cpuClockPercentage"].As<uint32_t>(100);
+    biosHighLevelEmulation = configuration["biosHighLevelEmulation"].As<bool>();
+    fastmem = configuration["fastmem"].As<bool>();
+    gpuThread = configuration["gpuThread"].As<bool>();
+    throttle = configuration["throttle"].As<bool>(true);
+    vsync = vsyncModeWithValue(configuration["vsync"].As<string>());
     bios = logLevelWithValue(configuration["log"]["bios"].As<string>());
     cdrom = logLevelWithValue(configuration["log"]["cdrom"].As<string>());
     interconnect = logLevelWithValue(configuration["log"]["interconnect"].As<string>());
@@ -78,6 +96,42 @@ bool ConfigurationManager::shouldShowDebugInfoWindow() {
     return showDebugInfoWindow;
 }
 
+CPUExecutionMode ConfigurationManager::cpuExecutionMode() {
+    return cpuMode;
+}
+
+bool ConfigurationManager::shouldRunCPUInLockstep() {
+    return cpuLockstep;
+}
+
+bool ConfigurationManager::shouldSkipCPUIdleLoops() {
+    return cpuIdleLoopSkipping;
+}
+
+uint32_t ConfigurationManager::cpuClockPercentage() {
+    return cpuClock;
+}
+
+bool ConfigurationManager::shouldEmulateBIOSFunctions() {
+    return biosHighLevelEmulation;
+}
+
+bool ConfigurationManager::shouldUseFastmem() {
+    return fastmem;
+}
+
+bool ConfigurationManager::shouldRunGPUOnThread() {
+    return gpuThread;
+}
+
+bool ConfigurationManager::shouldThrottleFrames() {
+    return throttle;
+}
+
+VSyncMode ConfigurationManager::vsyncMode() {
+    return vsync;
+}
+
 LogLevel ConfigurationManager::biosLogLevel() {
     return bios;
 }
@@ -11,7 +11,7 @@ manufacturers).
 */
 const uint32_t SystemClocksPerControllerInt7 = 1500;
 
-Controller::Controller(LogLevel logLevel, std::unique_ptr<InterruptController> &interruptController) : logger(logLevel, "  CONTROLLER: "), interruptController(interruptController), digitalController(make_unique<DigitalController>(logLevel)), currentDevice(NoDevice), control(), joypadBaud(), mode(), rxData(), status(), txData() {
+Controller::Controller(LogLevel logLevel, std::unique_ptr<InterruptController> &interruptController, std::unique_ptr<Scheduler> &scheduler) : logger(logLevel, "  CONTROLLER: "), interruptController(interruptController), scheduler(scheduler), digitalController(make_unique<DigitalController>(logLevel)), currentDevice(NoDevice), control(), joypadBaud(), mode(), rxData(), status(), txData() {
 
 }
 
@@ -63,8 +63,7 @@ void Controller::setTxDataRegister(uint8_t value) {
             rxData.receivedData = digitalController->getResponse(value);
             status.ackInputLevel = digitalController->getAcknowledge();
             if (status.ackInputLevel) {
-                shouldCount = true;
-                counter = 0;
+                scheduler->schedule(ControllerEvent, SystemClocksPerControllerInt7);
             }
             if (digitalController->getCurrentStage() == CommunicationSequenceStage::ControllerAccess) {
                 currentDevice = NoDevice;
@@ -93,21 +92,12 @@ uint16_t Controller::getControlRegister() {
     return control._value;
 }
 
-void Controller::step(uint32_t steps) {
-    if (shouldCount) {
-        counter += steps;
-        if (counter >= SystemClocksPerControllerInt7) {
-            status.interruptRequest = true;
-            status.ackInputLevel = false;
-            shouldCount = false;
-            counter = 0;
-        }
-    }
-    if (status.interruptRequest) {
-        interruptController->trigger(InterruptRequestNumber::CONTROLLER);
-    }
+void Controller::triggerAcknowledgeInterrupt() {
+    status.interruptRequest = true;
+    status.ackInputLevel = false;
+    interruptController->trigger(InterruptRequestNumber::CONTROLLER);
 }
 
-void Controller::updateInput() {
-    digitalController->updateInput();
+void Controller::setSwitches(DigitalControllerSwitches switches) {
+    digitalController->setSwitches(switches);
 }
@@ -1,5 +1,6 @@
 #include "DMA.hpp"
 #include "RAM.tcc"
+#include "GPU.tcc"
 #include <iostream>
 
 using namespace std;
@@ -33,13 +34,6 @@ void DMA::triggerInterrupt(DMAPort port) {
     interrupt._IRQFlags = flags.value;
     uint8_t interruptValue =  calculateInterruptRegister() >> 31 & 1;
     if (interruptValue) {
-        shouldTriggerInterrupt = true;
-    }
-}
-
-void DMA::step() {
-    if (shouldTriggerInterrupt) {
-        shouldTriggerInterrupt = false;
         interruptController->trigger(InterruptRequestNumber::DMAIRQ);
     }
 }
@@ -113,7 +107,7 @@ void DMA::executeLinkedList(DMAPort port, Channel& channel) {
         while (remainingTransferSize > 0) {
             address = (address + 4) & 0x1ffffc;
             uint32_t command = ram->load<uint32_t>(address);
-            gpu->executeGp0(command);
+            gpu->writeGp0(command);
             remainingTransferSize -= 1;
         }
         if ((header & 0x800000) != 0) {
@@ -134,6 +128,7 @@ void DMA::executeBlock(DMAPort port, Channel& channel) {
     optional<uint32_t> transferSize = channel.transferSize();
     if (!transferSize) {
         logger.logError("Unknown DMA transfer size");
+        return;
     }
     uint32_t remainingTransferSize = *transferSize;
     logger.logWarning("Block for port: %s with base address: %#x and transfer size: %#x", portDescription(port).c_str(), address, remainingTransferSize);
@@ -144,7 +139,7 @@ void DMA::executeBlock(DMAPort port, Channel& channel) {
                 uint32_t source = ram->load<uint32_t>(currentAddress);
                 switch (port) {
                     case DMAPort::GPUP: {
-                        gpu->executeGp0(source);
+                        gpu->writeGp0(source);
                         break;
                     }
                     case DMAPort::SPUP: {
@@ -199,6 +194,7 @@ unhandled:
 DMAPort DMA::portWithIndex(uint32_t index) {
     if (index > DMAPort::OTC) {
         logger.logError("Attempting to get port with out-of-bounds index: %d", index);
+        return DMAPort::OTC;
     }
     return DMAPort(index);
 }
@@ -22,11 +22,13 @@ DebugInfoRenderer::~DebugInfoRenderer() {
     ImGui::DestroyContext();
 }
 
-void DebugInfoRenderer::update(vector<string> biosFunctionsLog) {
+void DebugInfoRenderer::update(vector<string> biosFunctionsLog, const EmulationStatistics &statistics) {
     ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplSDL2_NewFrame(debugWindow->getWindowRef());
     Dimensions windowDimensions = debugWindow->getDimensions();
     ImVec2 syscallWindowSize = ImVec2(static_cast<float>(((windowDimensions.width / 3) * 2) - 20), static_cast<float>(windowDimensions.height - 20));
+    ImVec2 statisticsWindowPosition = ImVec2(static_cast<float>((windowDimensions.width / 3) * 2), 10);
+    ImVec2 statisticsWindowSize = ImVec2(static_cast<float>((windowDimensions.width / 3) - 10), static_cast<float>(windowDimensions.height - 20));
     ImGui::NewFrame();
     {
         ImGui::SetNextWindowPos(ImVec2(10, 10), ImGuiCond_Always);
@@ -42,6 +44,48 @@ void DebugInfoRenderer::update(vector<string> biosFunctionsLog) {
             ImGui::EndChild();
         }
         ImGui::End();
+        ImGui::SetNextWindowPos(statisticsWindowPosition, ImGuiCond_Always);
+        ImGui::SetNextWindowSize(statisticsWindowSize, ImGuiCond_Always);
+        ImGui::Begin("Emulation", NULL, ImGuiWindowFlags_NoResize);
+        {
+            ImGui::Text("CPU: %s%s", statistics.cpuExecutionMode.c_str(), statistics.cpuLockstep ? " (lockstep)" : "");
+            ImGui::Text("Emulated: %.2f MHz", statistics.emulatedMHz);
+            ImGui::Text("Clock: %u%% (%.2f MIPS guest)", statistics.cpuClockPercentage, statistics.guestMIPS);
+            ImGui::Text("Instructions: %llu", (unsigned long long)statistics.executedInstructions);
+            ImGui::Separator();
+            const FramePacingStatistics &framePacing = statistics.framePacing;
+            ImGui::Text("Frame time: %.2f ms (target %.2f ms%s)", framePacing.averageFrameTime, framePacing.targetFrameTime, framePacing.throttled ? "" : ", unthrottled");
+            ImGui::Text("Jitter: %.3f ms (worst %.3f ms)", framePacing.frameTimeJitter, framePacing.maximumFrameTimeDeviation);
+            ImGui::Text("Late frames: %llu", (unsigned long long)framePacing.lateFrames);
+            ImGui::Separator();
+            ImGui::Text("Cached blocks: %llu", (unsigned long long)statistics.cachedBasicBlocks);
+            ImGui::Text("Invalidated blocks: %llu", (unsigned long long)statistics.invalidatedBasicBlocks);
+            ImGui::Text("Recompiled blocks: %llu", (unsigned long long)statistics.recompiledBasicBlocks);
+            ImGui::Separator();
+            const RendererStatistics &renderer = statistics.renderer;
+            ImGui::Text("Draw calls: %llu in %llu flushes / frame", (unsigned long long)renderer.drawCalls, (unsigned long long)renderer.flushes);
+            ImGui::Text("  buffer full %llu, frame end %llu, VRAM read %llu, image load %llu", (unsigned long long)renderer.bufferFullFlushes, (unsigned long long)renderer.frameEndFlushes, (unsigned long long)renderer.vramReadFlushes, (unsigned long long)renderer.imageLoadFlushes);
+            ImGui::Separator();
+            ImGui::Text("Idle cycles skipped: %llu / frame", (unsigned long long)statistics.skippedIdleCycles);
+            if (statistics.biosHighLevelEmulation) {
+                ImGui::Separator();
+                ImGui::Text("BIOS HLE calls (est. instructions saved):");
+                for (const BIOSFunctionStatistics &function : statistics.biosFunctions) {
+                    // Time saved is estimated at the current emulation speed
+                    double savedMilliseconds = 0;
+                    if (statistics.emulatedMHz > 0) {
+                        savedMilliseconds = function.skippedInstructions / (statistics.emulatedMHz * 1000.0);
+                    }
+                    ImGui::Text("  %s: %llu (%llu, %.1f ms)", function.name.c_str(), (unsigned long long)function.calls, (unsigned long long)function.skippedInstructions, savedMilliseconds);
+                }
+            }
+            ImGui::Separator();
+            ImGui::Text("Hottest I/O ports (loads/stores):");
+            for (const IOPortStatistics &port : statistics.ioPorts) {
+                ImGui::Text("  %s %#x: %llu/%llu", port.device.c_str(), port.address, (unsigned long long)port.loads, (unsigned long long)port.stores);
+            }
+        }
+        ImGui::End();
     }
     ImGui::Render();
     glViewport(0, 0, (int)io->DisplaySize.x, (int)io->DisplaySize.y);
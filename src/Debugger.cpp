@@ -8,16 +8,16 @@
 
 using namespace std;
 
-Debugger::Debugger() : breakpoints(), loadWatchpoints(), storeWatchpoints(), stopped(false), attached(false) {
-}
+// The GDB server callbacks carry no context, so they reach the debugger attached to it
+static Debugger *attachedDebugger = nullptr;
 
-Debugger* Debugger::instance = nullptr;
+Debugger::Debugger() : breakpoints(), loadWatchpoints(), storeWatchpoints(), cpu(nullptr), stopped(false), attached(false), step(false) {
+}
 
-Debugger* Debugger::getInstance() {
-    if (instance == nullptr) {
-        instance = new Debugger();
+Debugger::~Debugger() {
+    if (attachedDebugger == this) {
+        attachedDebugger = nullptr;
     }
-    return instance;
 }
 
 void Debugger::setCPU(CPU *cpu) {
@@ -102,9 +102,9 @@ void Debugger::doStep() {
 }
 
 extern "C" uint32_t* globalRegisters() {
-    Debugger *debugger = Debugger::getInstance();
+    Debugger *debugger = attachedDebugger;
     debugger->getCPU()->printAllRegisters();
-    uint32_t *regs = (uint32_t *) malloc(sizeof(uint32_t) * 37);
+    uint32_t *regs = (uint32_t *) malloc(sizeof(uint32_t) * 38);
     array<uint32_t, 32> cpuRegisters = debugger->getCPU()->getRegisters();
     for (uint8_t i = 0; i < cpuRegisters.size(); i++) {
         regs[i] = cpuRegisters[i];
@@ -119,7 +119,7 @@ extern "C" uint32_t* globalRegisters() {
 }
 
 extern "C" uint8_t* readMemory(uint32_t address, uint32_t length) {
-    Debugger *debugger = Debugger::getInstance();
+    Debugger *debugger = attachedDebugger;
     uint8_t *memory = (uint8_t *) malloc(sizeof(uint8_t) * length);
     for (uint8_t i = 0; i < length; i++) {
         memory[0] = debugger->getCPU()->load<uint8_t>(address + i);
@@ -128,55 +128,59 @@ extern "C" uint8_t* readMemory(uint32_t address, uint32_t length) {
 }
 
 extern "C" void addBreakpointC(uint32_t address) {
-    Debugger *debugger = Debugger::getInstance();
+    Debugger *debugger = attachedDebugger;
     debugger->addBreakpoint(address);
     return;
 }
 
 extern "C" void continueProgramC() {
-    Debugger *debugger = Debugger::getInstance();
+    Debugger *debugger = attachedDebugger;
     debugger->continueProgram();
 }
 
 extern "C" void addLoadWatchpointC(uint32_t address) {
-    Debugger *debugger = Debugger::getInstance();
+    Debugger *debugger = attachedDebugger;
     debugger->addLoadWatchpoint(address);
     return;
 }
 
 extern "C" void addStoreWatchpointC(uint32_t address) {
-    Debugger *debugger = Debugger::getInstance();
+    Debugger *debugger = attachedDebugger;
     debugger->addStoreWatchpoint(address);
     return;
 }
 
 extern "C" void removeBreakpointC(uint32_t address) {
-    Debugger *debugger = Debugger::getInstance();
+    Debugger *debugger = attachedDebugger;
     debugger->removeBreakpoint(address);
     return;
 }
 
 
 extern "C" void removeLoadWatchpointC(uint32_t address) {
-    Debugger *debugger = Debugger::getInstance();
+    Debugger *debugger = attachedDebugger;
     debugger->removeLoadWatchpoint(address);
     return;
 }
 
 extern "C" void removeStoreWatchpointC(uint32_t address) {
-    Debugger *debugger = Debugger::getInstance();
+    Debugger *debugger = attachedDebugger;
     debugger->removeStoreWatchpoint(address);
     return;
 }
 
 void Debugger::debug() {
 #ifdef HANA
+    if (attachedDebugger != nullptr && attachedDebugger != this) {
+        return;
+    }
     stopped = true;
     if (attached) {
         NotifyStopped();
         return;
     } else {
         attached = true;
+        attachedDebugger = this;
     }
     SetGlobalRegistersCallback(&globalRegisters);
     SetReadMemoryCallback(&readMemory);
@@ -1,111 +1,244 @@
 #include "Emulator.hpp"
 #include "EmulatorRunner.hpp"
 #include "ConfigurationManager.hpp"
+#include "Renderer.hpp"
 #include "Constants.h"
 #include <SDL2/SDL.h>
 #include <glad/glad.h>
+#include <algorithm>
 
 using namespace std;
 
 const uint32_t SCREEN_WIDTH = 1024;
 const uint32_t SCREEN_HEIGHT = 768;
 
-Emulator::Emulator() : logger(LogLevel::NoLog), ttyBuffer(), biosFunctionsLog() {
-    setupSDL();
-    uint32_t screenHeight = SCREEN_HEIGHT;
+Emulator::Emulator(EmulatorRunner *emulatorRunner) : logger(LogLevel::NoLog), emulatorRunner(emulatorRunner), renderer(nullptr), stopRequested(false), emulationFinished(false), completedFrames(0), presentedFrames(0) {
+    headless = emulatorRunner->isHeadless();
+    frameLimit = emulatorRunner->maximumFrames();
     ConfigurationManager *configurationManager = ConfigurationManager::getInstance();
-    if (configurationManager->shouldResizeWindowToFitFramebuffer()) {
-        screenHeight = 512;
-    }
-    showDebugInfoWindow = configurationManager->shouldShowDebugInfoWindow();
-    if (showDebugInfoWindow) {
-        debugWindow = make_unique<Window>(false, "ルビィ - dbginfo", SCREEN_WIDTH, SCREEN_HEIGHT);
+    framePacer.setThrottled(configurationManager->shouldThrottleFrames() && !emulatorRunner->isUnthrottled());
+    // Headless runs only need the machine, without SDL, windows, a renderer or input
+    showDebugInfoWindow = !headless && configurationManager->shouldShowDebugInfoWindow();
+    if (!headless) {
+        setupSDL();
+        uint32_t screenHeight = SCREEN_HEIGHT;
+        if (configurationManager->shouldResizeWindowToFitFramebuffer()) {
+            screenHeight = 512;
+        }
+        if (showDebugInfoWindow) {
+            debugWindow = make_unique<Window>(false, "ルビィ - dbginfo", SCREEN_WIDTH, SCREEN_HEIGHT);
+        }
+        mainWindow = make_unique<Window>(true, "ルビィ", SCREEN_WIDTH, screenHeight);
+        mainWindow->makeCurrent();
+        mainWindow->setVSync(configurationManager->vsyncMode());
+        setupOpenGL();
+        controllerInput = make_unique<ControllerInput>(configurationManager->controllerLogLevel());
     }
-    mainWindow = make_unique<Window>(true, "ルビィ", SCREEN_WIDTH, screenHeight);
-    mainWindow->makeCurrent();
-    setupOpenGL();
     if (showDebugInfoWindow) {
         debugInfoRenderer = make_unique<DebugInfoRenderer>(debugWindow);
     }
-    cop0 = make_unique<COP0>();
-    bios = make_unique<BIOS>(configurationManager->biosLogLevel());
-    ram = make_unique<RAM>();
-    gpu = make_unique<GPU>(configurationManager->gpuLogLevel(), mainWindow);
-    scratchpad = make_unique<Scratchpad>();
-    interruptController = make_unique<InterruptController>(configurationManager->interruptLogLevel(), cop0);
-    LogLevel cdromLogLevel = configurationManager->cdromLogLevel();
-    cdrom = make_unique<CDROM>(cdromLogLevel, interruptController);
-    dma = make_unique<DMA>(configurationManager->dmaLogLevel(), ram, gpu, cdrom, interruptController);
-    expansion1 = make_unique<Expansion1>();
-    timer0 = make_unique<Timer0>();
-    timer1 = make_unique<Timer1>();
-    timer2 = make_unique<Timer2>();
-    controller = make_unique<Controller>(configurationManager->controllerLogLevel(), interruptController);
-    spu = make_unique<SPU>(configurationManager->spuLogLevel());
-    interconnect = make_unique<Interconnect>(configurationManager->interconnectLogLevel(), cop0, bios, ram, gpu, dma, scratchpad, cdrom, interruptController, expansion1, timer0, timer1, timer2, controller, spu);
-    cpu = make_unique<CPU>(configurationManager->cpuLogLevel(), interconnect, cop0, logBiosFunctionCalls);
-}
-
-Emulator::~Emulator() {}
+    machine = make_unique<Machine>(filesystem::current_path() / "SCPH1001.BIN");
+    if (!headless) {
+        unique_ptr<Renderer> renderer = make_unique<Renderer>(mainWindow);
+        this->renderer = renderer.get();
+        machine->setRenderer(move(renderer));
+    }
+    if (emulatorRunner->shouldRunTests()) {
+        filesystem::path expansionFilePath = filesystem::current_path() / "expansion" / "EXPNSION.BIN";
+        machine->loadExpansion(expansionFilePath);
+    }
+}
+
+Emulator::~Emulator() {
+    stopEmulationThread();
+}
+
+Machine* Emulator::getMachine() {
+    return machine.get();
+}
 
 CPU* Emulator::getCPU() {
-    return cpu.get();
+    return machine->getCPU();
+}
+
+Debugger* Emulator::getDebugger() {
+    return machine->getDebugger();
 }
 
 void Emulator::emulateFrame() {
-    controller->updateInput();
-    // Emulate cpu for given time slice (21 * magicNumber cycles),
-    // then check what events occured during that time slice,
-    // finally simulate rest of hardware to accommodate for that
-    uint32_t emulationMagicNumber = 4;
-    uint32_t systemClockStep = 21 * emulationMagicNumber;
-    uint32_t videoSystemClockStep = systemClockStep*11/7;
-    uint32_t totalSystemClocksThisFrame = 0;
-    uint32_t videoSystemClocksScanlineCounter = 0;
-    uint32_t totalScanlines = 0;
-    while (totalSystemClocksThisFrame < SystemClocksPerFrame) {
-        for (uint32_t i = 0; i < systemClockStep / 3; i++) {
-            checkBIOSFunctions();
-            if (!cpu->executeNextInstruction()) {
-                EmulatorRunner *emulatorRunner = EmulatorRunner::getInstance();
-                emulatorRunner->setup();
-            }
-            totalSystemClocksThisFrame++;
+    machine->emulateFrame();
+}
+
+void Emulator::startEmulationThread() {
+    stopRequested = false;
+    emulationFinished = false;
+    // The main thread keeps the window context, the renderer's moves to the emulation thread
+    if (!headless) {
+        mainWindow->makeCurrent();
+    }
+    emulationThread = thread(&Emulator::runEmulationThread, this);
+}
+
+void Emulator::stopEmulationThread() {
+    if (!emulationThread.joinable()) {
+        return;
+    }
+    stopRequested = true;
+    emulationThread.join();
+}
+
+void Emulator::runEmulationThread() {
+    machine->attachRendererToCurrentThread();
+    Debugger *debugger = machine->getDebugger();
+    framePacer.reset();
+    while (!stopRequested) {
+        runPendingCommands();
+        if (debugger->isAttached() && debugger->shouldStep()) {
+            debugger->doStep();
+            continue;
         }
-        dma->step();
-        cdrom->step();
-        controller->step(systemClockStep);
-        timer0->step(systemClockStep);
-        timer1->step(systemClockStep);
-        timer2->step(systemClockStep);
-        videoSystemClocksScanlineCounter += videoSystemClockStep;
-        if (videoSystemClocksScanlineCounter >= VideoSystemClocksPerScanline) {
-            totalScanlines++;
-            videoSystemClocksScanlineCounter = 0;
+        if (debugger->isAttached() && debugger->isStopped()) {
+            this_thread::sleep_for(chrono::milliseconds(1));
+            framePacer.reset();
+            continue;
         }
-        if (totalScanlines >= ScanlinesPerFrame) {
-            interruptController->trigger(VBLANK);
-            totalScanlines = 0;
-            gpu->render();
-            SDL_GL_SwapWindow(mainWindow->getWindowRef());
-            if (showDebugInfoWindow) {
-                debugWindow->makeCurrent();
-                debugInfoRenderer->update(biosFunctionsLog);
-                SDL_GL_SwapWindow(debugWindow->getWindowRef());
-                // This application makes most of the OpenGL work on the main window, so after
-                // we are doine with the debug window we forget about it until the next time to update
-                mainWindow->makeCurrent();
-            }
+        if (machine->hasExited() || machine->hasFailed() || (frameLimit > 0 && machine->emulatedFrameCount() >= frameLimit)) {
+            break;
+        }
+        // This frame shows what happened during the previous interval
+        queueControllerSwitches(framePacer.frameIntervalStart(), framePacer.frameIntervalEnd());
+        uint64_t frameStartCycles = machine->elapsedCycles();
+        machine->emulateFrame();
+        publishFrame();
+        framePacer.waitForNextFrame(machine->elapsedCycles() - frameStartCycles);
+    }
+    machine->detachRendererFromCurrentThread();
+    emulationFinished = true;
+    frameCondition.notify_all();
+}
+
+void Emulator::runCommand(EmulatorCommand command) {
+    switch (command) {
+        case DebugCommand: {
+            machine->getDebugger()->debug();
+            break;
+        }
+        case CycleCPUExecutionModeCommand: {
+            machine->cycleCPUExecutionMode();
+            break;
+        }
+        case ToggleCPULockstepCommand: {
+            machine->toggleCPULockstep();
+            break;
+        }
+        case CycleCPUClockCommand: {
+            machine->cycleCPUClock();
+            break;
+        }
+        case ToggleThrottleCommand: {
+            framePacer.setThrottled(!framePacer.isThrottled());
+            break;
+        }
+    }
+}
+
+// Without the emulation thread commands run right away
+void Emulator::postCommand(EmulatorCommand command) {
+    if (!emulationThread.joinable()) {
+        runCommand(command);
+        return;
+    }
+    lock_guard<mutex> lock(inputMutex);
+    pendingCommands.push_back(command);
+}
+
+void Emulator::runPendingCommands() {
+    deque<EmulatorCommand> commands;
+    {
+        lock_guard<mutex> lock(inputMutex);
+        commands.swap(pendingCommands);
+    }
+    for (EmulatorCommand command : commands) {
+        runCommand(command);
+    }
+}
+
+// Places the switches sampled during the interval on the frame about to run,
+// as far from its start as they were from the start of the interval
+void Emulator::queueControllerSwitches(chrono::steady_clock::time_point intervalStart, chrono::steady_clock::time_point intervalEnd) {
+    chrono::steady_clock::duration interval = max(intervalEnd - intervalStart, chrono::steady_clock::duration(1));
+    uint64_t frameTimestamp = machine->elapsedCycles();
+    lock_guard<mutex> lock(inputMutex);
+    while (!pendingControllerSwitches.empty() && pendingControllerSwitches.front().time < intervalEnd) {
+        TimedControllerSwitches &timedSwitches = pendingControllerSwitches.front();
+        double position = chrono::duration<double>(timedSwitches.time - intervalStart) / chrono::duration<double>(interval);
+        position = clamp(position, 0.0, 1.0);
+        machine->queueControllerSwitches(timedSwitches.switches, frameTimestamp + (uint64_t)(position * SystemClocksPerVideoFrame));
+        pendingControllerSwitches.pop_front();
+    }
+}
+
+void Emulator::publishFrame() {
+    {
+        lock_guard<mutex> lock(frameMutex);
+        completedFrames++;
+        if (showDebugInfoWindow) {
+            statistics = machine->getStatistics();
+            statistics.framePacing = framePacer.getStatistics();
+            biosFunctionsLog = machine->getBIOSFunctionsLog();
         }
     }
+    frameCondition.notify_all();
+}
+
+void Emulator::pollInput() {
+    if (!controllerInput) {
+        return;
+    }
+    DigitalControllerSwitches switches = controllerInput->updateInput();
+    if (switches._value == lastControllerSwitches._value) {
+        return;
+    }
+    lastControllerSwitches = switches;
+    lock_guard<mutex> lock(inputMutex);
+    pendingControllerSwitches.push_back({ chrono::steady_clock::now(), switches });
 }
 
-void Emulator::transferToRAM(filesystem::path filePath, uint32_t origin, uint32_t size, uint32_t destination) {
-    interconnect->transferToRAM(filePath, origin, size, destination);
+// Returns true when a frame was finished since the last one presented
+bool Emulator::waitForFrame(chrono::steady_clock::duration timeout) {
+    unique_lock<mutex> lock(frameMutex);
+    return frameCondition.wait_for(lock, timeout, [&]() {
+        return completedFrames != presentedFrames || emulationFinished;
+    }) && completedFrames != presentedFrames;
+}
+
+void Emulator::presentFrame() {
+    {
+        lock_guard<mutex> lock(frameMutex);
+        presentedFrames = completedFrames;
+    }
+    if (headless) {
+        return;
+    }
+    mainWindow->makeCurrent();
+    if (renderer) {
+        renderer->presentFrame();
+    }
+    if (showDebugInfoWindow) {
+        debugWindow->makeCurrent();
+        {
+            lock_guard<mutex> lock(frameMutex);
+            debugInfoRenderer->update(biosFunctionsLog, statistics);
+        }
+        SDL_GL_SwapWindow(debugWindow->getWindowRef());
+        // This application makes most of the OpenGL work on the main window, so after
+        // we are doine with the debug window we forget about it until the next time to update
+        mainWindow->makeCurrent();
+    }
 }
 
 void Emulator::dumpRAM() {
-    interconnect->dumpRAM();
+    machine->dumpRAM();
 }
 
 void Emulator::setupSDL() {
@@ -124,6 +257,9 @@ void Emulator::setupOpenGL() {
 }
 
 void Emulator::handleSDLEvent(SDL_Event event) {
+    if (headless) {
+        return;
+    }
     mainWindow->handleSDLEvent(event);
     if (showDebugInfoWindow) {
         debugWindow->handleSDLEvent(event);
@@ -132,7 +268,32 @@ void Emulator::handleSDLEvent(SDL_Event event) {
 }
 
 bool Emulator::shouldTerminate() {
-    return mainWindow->isHidden();
+    if (emulationThread.joinable()) {
+        return emulationFinished || (!headless && mainWindow->isHidden());
+    }
+    if (machine->hasExited() || machine->hasFailed() || (frameLimit > 0 && machine->emulatedFrameCount() >= frameLimit)) {
+        return true;
+    }
+    return !headless && mainWindow->isHidden();
+}
+
+bool Emulator::isHeadless() {
+    return headless;
+}
+
+uint64_t Emulator::emulatedFrameCount() {
+    return machine->emulatedFrameCount();
+}
+
+uint64_t Emulator::executedInstructionCount() {
+    return machine->executedInstructionCount();
+}
+
+uint32_t Emulator::getExitCode() {
+    if (machine->hasFailed()) {
+        return 1;
+    }
+    return machine->getExitCode();
 }
 
 void Emulator::toggleDebugInfoWindow() {
@@ -142,30 +303,30 @@ void Emulator::toggleDebugInfoWindow() {
     debugWindow->toggleHidden();
 }
 
-void Emulator::loadCDROMImageFile(std::filesystem::path filePath) {
-    cdrom->loadCDROMImageFile(filePath);
+void Emulator::debug() {
+    postCommand(DebugCommand);
 }
 
-void Emulator::checkTTY(char c) {
-    if (c == '\n') {
-        logger.logDebug("%s", ttyBuffer.c_str());
-        ttyBuffer.clear();
-        return;
-    }
-    ttyBuffer.append(1, c);
+void Emulator::cycleCPUExecutionMode() {
+    postCommand(CycleCPUExecutionModeCommand);
 }
 
-void Emulator::checkBIOSFunctions() {
-    array<uint32_t, 32> registers = cpu->getRegisters();
-    uint32_t function = registers[9];
-    array<uint32_t, 4> subroutineArguments = cpu->getSubroutineArguments();
-    optional<string> result = bios->checkFunctions(cpu->getProgramCounter(), function, subroutineArguments);
-    if (!result) {
-        return;
-    }
-    string functionCallLog = (*result);
-    if (functionCallLog.find("std_out_putchar(char)") == 0) {
-        checkTTY(registers[4]);
-    }
-    biosFunctionsLog.push_back(functionCallLog);
+void Emulator::toggleCPULockstep() {
+    postCommand(ToggleCPULockstepCommand);
+}
+
+void Emulator::cycleCPUClock() {
+    postCommand(CycleCPUClockCommand);
+}
+
+void Emulator::toggleThrottle() {
+    postCommand(ToggleThrottleCommand);
+}
+
+void Emulator::loadCDROMImageFile(std::filesystem::path filePath) {
+    machine->loadCDROMImageFile(filePath);
+}
+
+void Emulator::loadExecutable(std::filesystem::path filePath) {
+    machine->loadExecutable(filePath);
 }
@@ -1,20 +1,12 @@
 #include "EmulatorRunner.hpp"
-#include <fstream>
 #include <algorithm>
-#include "CPU.hpp"
+#include <cstdlib>
 
 using namespace std;
 
-EmulatorRunner::EmulatorRunner() : logger(LogLevel::NoLog), emulator(nullptr), runTests(false), exeFile(), binFile(), header() {}
+EmulatorRunner::EmulatorRunner() : logger(LogLevel::NoLog), emulator(nullptr), runTests(false), headless(false), unthrottled(false), frameLimit(0), exeFile(), binFile() {}
 
-EmulatorRunner* EmulatorRunner::instance = nullptr;
-
-EmulatorRunner* EmulatorRunner::getInstance() {
-    if (instance == nullptr) {
-        instance = new EmulatorRunner();
-    }
-    return instance;
-}
+EmulatorRunner::~EmulatorRunner() {}
 
 bool EmulatorRunner::checkOption(char** begin, char** end, const std::string &option) {
     return find(begin, end, option) != end;
@@ -56,6 +48,25 @@ void EmulatorRunner::configure(int argc, char* argv[]) {
         }
         argumentFound = true;
     }
+    if (checkOption(argv, argv + argc, "--headless")) {
+        headless = true;
+        argumentFound = true;
+    }
+    if (checkOption(argv, argv + argc, "--unthrottled")) {
+        unthrottled = true;
+        argumentFound = true;
+    }
+    if (checkOption(argv, argv + argc, "--frames")) {
+        char *frames = getOptionValue(argv, argv + argc, "--frames");
+        if (frames == NULL) {
+            logger.logError("Incorrect argument passed. See README.md for usage.");
+        }
+        frameLimit = strtoul(frames, nullptr, 10);
+        if (frameLimit == 0) {
+            logger.logError("The provided --frames count has to be a positive number.");
+        }
+        argumentFound = true;
+    }
     if (!argumentFound) {
         logger.logError("Incorrect argument passed. See README.md for usage.");
     }
@@ -64,77 +75,23 @@ void EmulatorRunner::configure(int argc, char* argv[]) {
 void EmulatorRunner::setEmulator(Emulator *emulator) {
     this->emulator = emulator;
     this->emulator->loadCDROMImageFile(binFile);
-}
-
-void EmulatorRunner::readHeader() {
-    ifstream file = ifstream(exeFile, ios::in|ios::binary|ios::ate);
-    if (!file.is_open()) {
-        logger.logError("Unable to tests.exe binary");
-    }
-    file.seekg(0, ios::beg);
-    file.read(reinterpret_cast<char *>(header), TEST_HEADER_SIZE);
-    file.close();
-}
-
-string EmulatorRunner::id() {
-    return string(reinterpret_cast<char *>(header), 8);
-}
-
-uint32_t EmulatorRunner::loadWord(uint32_t offset) {
-    uint32_t value = 0;
-    for (uint8_t i = 0; i < 4; i++) {
-        value |= (((uint32_t)header[offset + i]) << (i * 8));
+    if (runTests) {
+        this->emulator->loadExecutable(exeFile);
     }
-    return value;
 }
 
 bool EmulatorRunner::shouldRunTests() {
     return runTests;
 }
 
-uint32_t EmulatorRunner::programCounter() {
-    return loadWord(0x10);
-}
-
-uint32_t EmulatorRunner::globalPointer() {
-    return loadWord(0x14);
-}
-
-uint32_t EmulatorRunner::initialStackFramePointerBase() {
-    return loadWord(0x30);
-}
-
-uint32_t EmulatorRunner::initialStackFramePointeroffset() {
-    return loadWord(0x34);
-}
-
-uint32_t EmulatorRunner::destinationAddress() {
-    return loadWord(0x18);
+bool EmulatorRunner::isHeadless() {
+    return headless;
 }
 
-uint32_t EmulatorRunner::fileSize() {
-    return loadWord(0x1C);
+bool EmulatorRunner::isUnthrottled() {
+    return unthrottled;
 }
 
-void EmulatorRunner::setup() {
-    if (!shouldRunTests()) {
-        return;
-    }
-    readHeader();
-    string identifier = id();
-    if (identifier.compare("PS-X EXE") != 0) {
-        logger.logError("Invalid identifier found in file header");
-    }
-    uint32_t destinationAddress = this->destinationAddress();
-    uint32_t fileSize = this->fileSize();
-    if (fileSize % 0x800 != 0) {
-        logger.logError("Invalid file size found in file header");
-    }
-    emulator->transferToRAM(exeFile, 0x800, fileSize, destinationAddress);
-
-    CPU *cpu = emulator->getCPU();
-    cpu->setProgramCounter(programCounter());
-    cpu->setGlobalPointer(globalPointer());
-    cpu->setStackPointer(initialStackFramePointerBase() + initialStackFramePointeroffset());
-    cpu->setFramePointer(initialStackFramePointerBase() + initialStackFramePointeroffset());
+uint32_t EmulatorRunner::maximumFrames() {
+    return frameLimit;
 }
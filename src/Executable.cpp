@@ -0,0 +1,68 @@
+#include "Executable.hpp"
+#include <fstream>
+
+using namespace std;
+
+Executable::Executable(LogLevel logLevel, filesystem::path filePath) : logger(logLevel), filePath(filePath), header() {
+    readHeader();
+    string identifier = id();
+    if (identifier.compare("PS-X EXE") != 0) {
+        logger.logError("Invalid identifier found in file header");
+    }
+    if (fileSize() % 0x800 != 0) {
+        logger.logError("Invalid file size found in file header");
+    }
+}
+
+Executable::~Executable() {}
+
+void Executable::readHeader() {
+    ifstream file = ifstream(filePath, ios::in|ios::binary|ios::ate);
+    if (!file.is_open()) {
+        logger.logError("Unable to open the executable");
+        return;
+    }
+    file.seekg(0, ios::beg);
+    file.read(reinterpret_cast<char *>(header), EXECUTABLE_HEADER_SIZE);
+    file.close();
+}
+
+string Executable::id() {
+    return string(reinterpret_cast<char *>(header), 8);
+}
+
+uint32_t Executable::loadWord(uint32_t offset) {
+    uint32_t value = 0;
+    for (uint8_t i = 0; i < 4; i++) {
+        value |= (((uint32_t)header[offset + i]) << (i * 8));
+    }
+    return value;
+}
+
+filesystem::path Executable::getFilePath() {
+    return filePath;
+}
+
+uint32_t Executable::programCounter() {
+    return loadWord(0x10);
+}
+
+uint32_t Executable::globalPointer() {
+    return loadWord(0x14);
+}
+
+uint32_t Executable::destinationAddress() {
+    return loadWord(0x18);
+}
+
+uint32_t Executable::fileSize() {
+    return loadWord(0x1C);
+}
+
+uint32_t Executable::initialStackFramePointerBase() {
+    return loadWord(0x30);
+}
+
+uint32_t Executable::initialStackFramePointeroffset() {
+    return loadWord(0x34);
+}
@@ -0,0 +1,300 @@
+#include "Fastmem.hpp"
+#include <optional>
+#include "Interconnect.tcc"
+#if RUBY_FASTMEM_SUPPORTED
+#include <atomic>
+#include <mutex>
+#include <csignal>
+#include <sys/mman.h>
+#include <ucontext.h>
+#endif
+
+using namespace std;
+
+// Guest segments the physical address space is visible through
+const uint32_t fastmemSegments[3] = { 0x00000000, 0x80000000, 0xa0000000 };
+
+// A guest access made by recompiled code, always between eax and [rdx + rcx]
+struct FastmemAccess {
+    uint8_t size;
+    bool isStore;
+    bool isSignExtended;
+    uint8_t length;
+};
+
+static optional<FastmemAccess> decodeAccess(const uint8_t *instruction) {
+    bool hasOperandSizePrefix = instruction[0] == 0x66;
+    if (hasOperandSizePrefix) {
+        instruction++;
+    }
+    bool isTwoByteOpcode = instruction[0] == 0x0f;
+    uint8_t opcode = isTwoByteOpcode ? instruction[1] : instruction[0];
+    const uint8_t *operands = isTwoByteOpcode ? &instruction[2] : &instruction[1];
+    // ModRM [SIB] eax with SIB rdx + rcx
+    if (operands[0] != 0x04 || operands[1] != 0x0a) {
+        return nullopt;
+    }
+    uint8_t length = hasOperandSizePrefix + (isTwoByteOpcode ? 2 : 1) + 2;
+    if (isTwoByteOpcode && !hasOperandSizePrefix) {
+        switch (opcode) {
+            // movzx eax, byte
+            case 0xb6: return FastmemAccess { 1, false, false, length };
+            // movzx eax, word
+            case 0xb7: return FastmemAccess { 2, false, false, length };
+            // movsx eax, byte
+            case 0xbe: return FastmemAccess { 1, false, true, length };
+            // movsx eax, word
+            case 0xbf: return FastmemAccess { 2, false, true, length };
+        }
+        return nullopt;
+    }
+    if (isTwoByteOpcode) {
+        return nullopt;
+    }
+    if (hasOperandSizePrefix) {
+        // mov word, ax
+        if (opcode == 0x89) {
+            return FastmemAccess { 2, true, false, length };
+        }
+        return nullopt;
+    }
+    switch (opcode) {
+        // mov eax, dword
+        case 0x8b: return FastmemAccess { 4, false, false, length };
+        // mov dword, eax
+        case 0x89: return FastmemAccess { 4, true, false, length };
+        // mov byte, al
+        case 0x88: return FastmemAccess { 1, true, false, length };
+    }
+    return nullopt;
+}
+
+#if RUBY_FASTMEM_SUPPORTED
+// Every emulator has its own region, the fault handler is shared and finds the one
+// the faulting address belongs to. Slots are only written while holding the mutex
+const size_t MAX_ACTIVE_FASTMEMS = 64;
+static atomic<Fastmem *> activeFastmems[MAX_ACTIVE_FASTMEMS];
+static size_t activeFastmemCount = 0;
+static mutex activeFastmemsMutex;
+static struct sigaction previousAction;
+
+static void handleSegmentationFault(int signal, siginfo_t *info, void *context) {
+    ucontext_t *userContext = static_cast<ucontext_t *>(context);
+    greg_t *registers = userContext->uc_mcontext.gregs;
+    uint64_t accumulator = registers[REG_RAX];
+    uint64_t instructionPointer = registers[REG_RIP];
+    for (atomic<Fastmem *> &activeFastmem : activeFastmems) {
+        Fastmem *fastmem = activeFastmem.load(memory_order_acquire);
+        if (fastmem != nullptr && fastmem->handleFault(reinterpret_cast<uintptr_t>(info->si_addr), accumulator, instructionPointer)) {
+            registers[REG_RAX] = accumulator;
+            registers[REG_RIP] = instructionPointer;
+            return;
+        }
+    }
+    // Not a guest access, the faulting instruction runs again with the previous handler
+    sigaction(signal, &previousAction, nullptr);
+}
+#endif
+
+Fastmem::Fastmem(LogLevel logLevel, Interconnect *interconnect, const RAM &ram, const Scratchpad &scratchpad, const BIOS &bios) : logger(logLevel, "  FASTMEM: "), interconnect(interconnect), base(nullptr), writeProtectedRAMPages(), isCacheIsolated(false) {
+    if (!RUBY_FASTMEM_SUPPORTED) {
+        logger.logWarning("Fastmem isn't supported on this host");
+        return;
+    }
+#if RUBY_FASTMEM_SUPPORTED
+    lock_guard<mutex> lock(activeFastmemsMutex);
+    if (activeFastmemCount == MAX_ACTIVE_FASTMEMS) {
+        logger.logWarning("Too many fastmem regions in use");
+        return;
+    }
+    void *region = mmap(nullptr, FASTMEM_REGION_SIZE, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (region == MAP_FAILED) {
+        logger.logWarning("Unable to reserve the fastmem region");
+        return;
+    }
+    base = static_cast<uint8_t *>(region);
+    bool isMapped = true;
+    for (uint32_t segment : fastmemSegments) {
+        for (uint32_t mirror = 0; mirror < 4; mirror++) {
+            isMapped = isMapped && mapMemory(segment + mirror * RAM_SIZE, ram.getMemory(), RAM_SIZE, true);
+        }
+        isMapped = isMapped && mapMemory(segment + 0x1f800000, scratchpad.getMemory(), scratchpad.getMemory().getSize(), true);
+        isMapped = isMapped && mapMemory(segment + 0x1fc00000, bios.getMemory(), BIOS_SIZE, false);
+    }
+    if (!isMapped) {
+        logger.logWarning("Unable to map guest memory into the fastmem region");
+        munmap(base, FASTMEM_REGION_SIZE);
+        base = nullptr;
+        return;
+    }
+    for (atomic<Fastmem *> &activeFastmem : activeFastmems) {
+        if (activeFastmem.load(memory_order_relaxed) == nullptr) {
+            activeFastmem.store(this, memory_order_release);
+            break;
+        }
+    }
+    if (activeFastmemCount++ > 0) {
+        return;
+    }
+    struct sigaction action = {};
+    action.sa_sigaction = handleSegmentationFault;
+    action.sa_flags = SA_SIGINFO;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGSEGV, &action, &previousAction);
+#endif
+}
+
+Fastmem::~Fastmem() {
+#if RUBY_FASTMEM_SUPPORTED
+    if (base == nullptr) {
+        return;
+    }
+    lock_guard<mutex> lock(activeFastmemsMutex);
+    for (atomic<Fastmem *> &activeFastmem : activeFastmems) {
+        if (activeFastmem.load(memory_order_relaxed) == this) {
+            activeFastmem.store(nullptr, memory_order_release);
+        }
+    }
+    if (--activeFastmemCount == 0) {
+        sigaction(SIGSEGV, &previousAction, nullptr);
+    }
+    munmap(base, FASTMEM_REGION_SIZE);
+#endif
+}
+
+bool Fastmem::isSupported() {
+    return RUBY_FASTMEM_SUPPORTED;
+}
+
+bool Fastmem::isEnabled() const {
+    return base != nullptr;
+}
+
+uint8_t* Fastmem::getBase() const {
+    return base;
+}
+
+// Whether guest accesses to this address go straight to host memory
+bool Fastmem::isMapped(uint32_t address) const {
+    uint8_t segment = address >> 29;
+    if (segment != 0 && segment != 4 && segment != 5) {
+        return false;
+    }
+    uint32_t physicalAddress = address & 0x1fffffff;
+    if (physicalAddress < RAM_SIZE * 4) {
+        return true;
+    }
+    if (physicalAddress >= 0x1f800000 && physicalAddress < 0x1f800000 + SCRATCHPAD_SIZE) {
+        return true;
+    }
+    return physicalAddress >= 0x1fc00000 && physicalAddress < 0x1fc00000 + BIOS_SIZE;
+}
+
+bool Fastmem::mapMemory(uint32_t address, const SharedMemory &memory, uint32_t size, bool isWritable) {
+#if RUBY_FASTMEM_SUPPORTED
+    if (memory.getFileDescriptor() == -1) {
+        return false;
+    }
+    int protection = isWritable ? PROT_READ | PROT_WRITE : PROT_READ;
+    void *view = mmap(base + address, size, protection, MAP_SHARED | MAP_FIXED, memory.getFileDescriptor(), 0);
+    return view != MAP_FAILED;
+#else
+    return false;
+#endif
+}
+
+void Fastmem::protectRAM(uint32_t offset, uint32_t size, bool isWritable) {
+#if RUBY_FASTMEM_SUPPORTED
+    int protection = isWritable ? PROT_READ | PROT_WRITE : PROT_READ;
+    for (uint32_t segment : fastmemSegments) {
+        for (uint32_t mirror = 0; mirror < 4; mirror++) {
+            mprotect(base + segment + mirror * RAM_SIZE + offset, size, protection);
+        }
+    }
+#endif
+}
+
+// Stores to RAM code pages have to invalidate cached code, so they are made to fault
+void Fastmem::setRAMCodePageWriteProtected(uint32_t offset, bool isWriteProtected) {
+    uint32_t page = offset / RAM_CODE_PAGE_SIZE;
+    if (base == nullptr || writeProtectedRAMPages[page] == isWriteProtected) {
+        return;
+    }
+    writeProtectedRAMPages[page] = isWriteProtected;
+    if (!isCacheIsolated) {
+        protectRAM(page * RAM_CODE_PAGE_SIZE, RAM_CODE_PAGE_SIZE, !isWriteProtected);
+    }
+}
+
+// Stores to RAM are dropped while the cache is isolated
+void Fastmem::setCacheIsolated(bool isIsolated) {
+    if (base == nullptr || isCacheIsolated == isIsolated) {
+        return;
+    }
+    isCacheIsolated = isIsolated;
+    protectRAM(0, RAM_SIZE, !isIsolated);
+    if (isIsolated) {
+        return;
+    }
+    for (uint32_t page = 0; page < RAM_CODE_PAGE_COUNT; page++) {
+        if (writeProtectedRAMPages[page]) {
+            protectRAM(page * RAM_CODE_PAGE_SIZE, RAM_CODE_PAGE_SIZE, false);
+        }
+    }
+}
+
+// Runs a faulting access from recompiled code through the Interconnect, returns
+// false when the fault didn't come from one
+bool Fastmem::handleFault(uintptr_t faultAddress, uint64_t &accumulator, uint64_t &instructionPointer) {
+    uintptr_t regionStart = reinterpret_cast<uintptr_t>(base);
+    if (base == nullptr || faultAddress < regionStart || faultAddress - regionStart >= FASTMEM_REGION_SIZE) {
+        return false;
+    }
+    optional<FastmemAccess> access = decodeAccess(reinterpret_cast<const uint8_t *>(instructionPointer));
+    if (!access) {
+        return false;
+    }
+    uint32_t address = faultAddress - regionStart;
+    if ((*access).isStore) {
+        switch ((*access).size) {
+            case 1: {
+                interconnect->store<uint8_t>(address, accumulator);
+                break;
+            }
+            case 2: {
+                interconnect->store<uint16_t>(address, accumulator);
+                break;
+            }
+            case 4: {
+                interconnect->store<uint32_t>(address, accumulator);
+                break;
+            }
+        }
+    } else {
+        uint32_t value = 0;
+        switch ((*access).size) {
+            case 1: {
+                value = interconnect->load<uint8_t>(address);
+                if ((*access).isSignExtended) {
+                    value = (int8_t)value;
+                }
+                break;
+            }
+            case 2: {
+                value = interconnect->load<uint16_t>(address);
+                if ((*access).isSignExtended) {
+                    value = (int16_t)value;
+                }
+                break;
+            }
+            case 4: {
+                value = interconnect->load<uint32_t>(address);
+                break;
+            }
+        }
+        // Like any 32 bits host operation, this clears the upper half of rax
+        accumulator = value;
+    }
+    instructionPointer += (*access).length;
+    return true;
+}
@@ -0,0 +1,108 @@
+#include "FramePacer.hpp"
+#include "Constants.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+using namespace std;
+
+// Sleeping ends this long before the deadline at first, then follows the measured oversleep
+const chrono::steady_clock::duration INITIAL_SPIN_MARGIN = chrono::microseconds(500);
+const chrono::steady_clock::duration MINIMUM_SPIN_MARGIN = chrono::microseconds(50);
+const chrono::steady_clock::duration MAXIMUM_SPIN_MARGIN = chrono::milliseconds(2);
+// Frames further behind than this are given up on
+const uint32_t MAXIMUM_LATE_FRAMES = 3;
+// A frame is counted late when it ends this long after its deadline
+const chrono::steady_clock::duration LATE_FRAME_TOLERANCE = chrono::milliseconds(1);
+
+FramePacer::FramePacer() : throttled(true), spinMargin(INITIAL_SPIN_MARGIN), statistics(), measuredFrames(0), measuredFrameTime(0), measuredSquaredDeviation(0), measuredMaximumDeviation(0) {
+    reset();
+}
+
+FramePacer::~FramePacer() {}
+
+void FramePacer::setThrottled(bool throttled) {
+    if (this->throttled == throttled) {
+        return;
+    }
+    this->throttled = throttled;
+    reset();
+}
+
+bool FramePacer::isThrottled() const {
+    return throttled;
+}
+
+void FramePacer::reset() {
+    chrono::steady_clock::time_point now = chrono::steady_clock::now();
+    previousDeadline = now;
+    deadline = now;
+    lastFrameEnd = now;
+}
+
+void FramePacer::waitForNextFrame(uint64_t emulatedClocks) {
+    chrono::steady_clock::duration frameDuration = chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>((double)emulatedClocks / SystemClocksPerSecond));
+    previousDeadline = deadline;
+    deadline += frameDuration;
+    chrono::steady_clock::time_point now = chrono::steady_clock::now();
+    if (!throttled) {
+        deadline = now;
+    } else if (now > deadline + frameDuration * MAXIMUM_LATE_FRAMES) {
+        deadline = now;
+    } else {
+        sleepUntil(deadline);
+    }
+    chrono::steady_clock::time_point frameEnd = chrono::steady_clock::now();
+    if (throttled && frameEnd > deadline + LATE_FRAME_TOLERANCE) {
+        statistics.lateFrames++;
+    }
+    measureFrame(frameEnd - lastFrameEnd, frameDuration);
+    lastFrameEnd = frameEnd;
+}
+
+void FramePacer::sleepUntil(chrono::steady_clock::time_point time) {
+    chrono::steady_clock::time_point wakeUp = time - spinMargin;
+    if (chrono::steady_clock::now() < wakeUp) {
+        this_thread::sleep_until(wakeUp);
+        chrono::steady_clock::duration oversleep = chrono::steady_clock::now() - wakeUp;
+        // Grows right away when the host wakes us late, shrinks slowly when it doesn't
+        spinMargin = clamp(max(oversleep + oversleep / 2, spinMargin - spinMargin / 16), MINIMUM_SPIN_MARGIN, MAXIMUM_SPIN_MARGIN);
+    }
+    while (chrono::steady_clock::now() < time) {
+    }
+}
+
+chrono::steady_clock::time_point FramePacer::frameIntervalStart() const {
+    return previousDeadline;
+}
+
+chrono::steady_clock::time_point FramePacer::frameIntervalEnd() const {
+    return deadline;
+}
+
+// Averaged over a second worth of frames
+void FramePacer::measureFrame(chrono::steady_clock::duration frameTime, chrono::steady_clock::duration targetFrameTime) {
+    double milliseconds = chrono::duration<double, milli>(frameTime).count();
+    double targetMilliseconds = chrono::duration<double, milli>(targetFrameTime).count();
+    double deviation = milliseconds - targetMilliseconds;
+    measuredFrames++;
+    measuredFrameTime += milliseconds;
+    measuredSquaredDeviation += deviation * deviation;
+    measuredMaximumDeviation = max(measuredMaximumDeviation, abs(deviation));
+    if (measuredFrames < FrameRateTarget) {
+        return;
+    }
+    statistics.throttled = throttled;
+    statistics.targetFrameTime = targetMilliseconds;
+    statistics.averageFrameTime = measuredFrameTime / measuredFrames;
+    statistics.frameTimeJitter = sqrt(measuredSquaredDeviation / measuredFrames);
+    statistics.maximumFrameTimeDeviation = measuredMaximumDeviation;
+    measuredFrames = 0;
+    measuredFrameTime = 0;
+    measuredSquaredDeviation = 0;
+    measuredMaximumDeviation = 0;
+}
+
+const FramePacingStatistics& FramePacer::getStatistics() const {
+    return statistics;
+}
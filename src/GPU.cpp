@@ -1,4 +1,4 @@
-#include "GPU.hpp"
+#include "GPU.tcc"
 #include "Vertex.hpp"
 #include <iostream>
 
@@ -6,7 +6,7 @@ using namespace std;
 
 const uint32_t GP0_COMMAND_TERMINATION_CODE = 0x55555555;
 
-GPU::GPU(LogLevel logLevel, std::unique_ptr<Window> &mainWindow) : logger(logLevel),
+GPU::GPU(LogLevel logLevel) : logger(logLevel),
              texturePageBaseX(0),
              texturePageBaseY(0),
              semiTransparency(0),
@@ -48,12 +48,125 @@ GPU::GPU(LogLevel logLevel, std::unique_ptr<Window> &mainWindow) : logger(logLev
              gp0WordsRead(0),
              gp0InstructionMethod(nullptr),
              gp0Mode(GP0Mode::Command),
-             imageBuffer(make_unique<GPUImageBuffer>())
+             renderer(nullptr),
+             imageBuffer(make_unique<GPUImageBuffer>()),
+             commandRing(nullptr),
+             thread(),
+             threadCall(nullptr),
+             publishedStatus(0),
+             statusCommandCount(0)
 {
-    renderer = make_unique<Renderer>(mainWindow);
 }
 
 GPU::~GPU() {
+    setThreaded(false);
+}
+
+// Without a renderer (headless) draw commands are decoded but never rendered
+void GPU::setRenderer(unique_ptr<GPUBackend> renderer) {
+    bool threaded = isThreaded();
+    setThreaded(false);
+    this->renderer = move(renderer);
+    setThreaded(threaded);
+}
+
+void GPU::setThreaded(bool threaded) {
+    if (threaded == isThreaded()) {
+        return;
+    }
+    if (threaded) {
+        if (renderer) {
+            renderer->detachFromCurrentThread();
+        }
+        commandRing = make_unique<GPUCommandRing>();
+        publishedStatus.store(statusRegister(), memory_order_relaxed);
+        statusCommandCount = 0;
+        // Fatal errors on the GPU thread stop the machine that started it
+        thread = std::thread(&GPU::runThread, this, currentFatalErrorState());
+    } else {
+        commandRing->push(GPUCommandKind::StopCommand, 0);
+        thread.join();
+        commandRing = nullptr;
+        if (renderer) {
+            renderer->attachToCurrentThread();
+        }
+    }
+}
+
+bool GPU::isThreaded() const {
+    return commandRing != nullptr;
+}
+
+// A threaded GPU keeps the renderer on its own thread
+void GPU::attachRendererToCurrentThread() {
+    if (renderer && !isThreaded()) {
+        renderer->attachToCurrentThread();
+    }
+}
+
+void GPU::detachRendererFromCurrentThread() {
+    if (renderer && !isThreaded()) {
+        renderer->detachFromCurrentThread();
+    }
+}
+
+void GPU::runThread(FatalErrorState *fatalErrorState) {
+    FatalErrorScope fatalErrorScope(fatalErrorState);
+    if (renderer) {
+        renderer->attachToCurrentThread();
+    }
+    while (true) {
+        GPUCommand command = commandRing->front();
+        switch (command.kind) {
+            case GPUCommandKind::GP0Command: {
+                executeGp0(command.value);
+                if (isStatusGp0Word(command.value)) {
+                    publishedStatus.store(statusRegister(), memory_order_release);
+                }
+                break;
+            }
+            case GPUCommandKind::GP1Command: {
+                executeGp1(command.value);
+                publishedStatus.store(statusRegister(), memory_order_release);
+                break;
+            }
+            case GPUCommandKind::RenderCommand: {
+                renderFrame();
+                break;
+            }
+            case GPUCommandKind::CallCommand: {
+                threadCall();
+                break;
+            }
+            case GPUCommandKind::StopCommand: {
+                if (renderer) {
+                    renderer->detachFromCurrentThread();
+                }
+                commandRing->pop();
+                return;
+            }
+        }
+        commandRing->pop();
+    }
+}
+
+// Runs on the thread that owns the GPU state, waiting for it to finish
+void GPU::runOnThread(function<void(void)> call) {
+    if (!commandRing) {
+        call();
+        return;
+    }
+    threadCall = call;
+    commandRing->push(GPUCommandKind::CallCommand, 0);
+    synchronize();
+    threadCall = nullptr;
+}
+
+void GPU::synchronize() {
+    if (!commandRing) {
+        return;
+    }
+    commandRing->waitUntilPopped(commandRing->pushedCount());
 }
 
 uint32_t GPU::statusRegister() const {
@@ -105,456 +218,15 @@ uint32_t GPU::statusRegister() const {
     return value;
 }
 
+constexpr array<GP0Operation, 256> GPU::gp0Operations = GPU::makeGp0Operations(make_index_sequence<256>());
+
 void GPU::executeGp0(uint32_t value) {
     if (gp0WordsRemaining == 0) {
         gp0WordsRead = 0;
         uint32_t opCode = (value >> 24) & 0xff;
-        switch (opCode) {
-            case 0x00: {
-                gp0WordsRemaining = 1;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0Nop();
-                };
-                break;
-            }
-            case 0x01: {
-                gp0WordsRemaining = 1;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0ClearCache();
-                };
-                break;
-            }
-            case 0x02: {
-                gp0WordsRemaining = 3;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0FillRectagleInVRAM();
-                };
-                break;
-            }
-            case 0x20: {
-                gp0WordsRemaining = 4;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0MonochromeThreePointOpaque();
-                };
-                break;
-            }
-            case 0x22: {
-                gp0WordsRemaining = 4;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0MonochromeThreePointSemiTransparent();
-                };
-                break;
-            }
-            case 0x28: {
-                gp0WordsRemaining = 5;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0MonochromeFourPointOpaque();
-                };
-                break;
-            }
-            case 0x2a: {
-                gp0WordsRemaining = 5;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0MonochromeFourPointSemiTransparent();
-                };
-                break;
-            }
-            case 0x24: {
-                gp0WordsRemaining = 7;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0TexturedThreePointOpaqueTextureBlending();
-                };
-                break;
-            }
-            case 0x25: {
-                gp0WordsRemaining = 7;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0TexturedThreePointOpaqueRawTexture();
-                };
-                break;
-            }
-            case 0x26: {
-                gp0WordsRemaining = 7;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0TexturedThreePointSemiTransparentTextureBlending();
-                };
-                break;
-            }
-            case 0x27: {
-                gp0WordsRemaining = 7;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0TexturedThreePointSemiTransparentRawTexture();
-                };
-                break;
-            }
-            case 0x2c: {
-                gp0WordsRemaining = 9;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0TexturedFourPointOpaqueTextureBlending();
-                };
-                break;
-            }
-            case 0x2d: {
-                gp0WordsRemaining = 9;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0TexturedFourPointOpaqueRawTexture();
-                };
-                break;
-            }
-            case 0x2e: {
-                gp0WordsRemaining = 9;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0TexturedFourPointSemiTransparentTextureBlending();
-                };
-                break;
-            }
-            case 0x2f: {
-                gp0WordsRemaining = 9;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0TexturedFourPointSemiTransparentRawTexture();
-                };
-                break;
-            }
-            case 0x30: {
-                gp0WordsRemaining = 6;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0ShadedThreePointOpaque();
-                };
-                break;
-            }
-            case 0x32: {
-                gp0WordsRemaining = 6;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0ShadedThreePointSemiTransparent();
-                };
-                break;
-            }
-            case 0x38: {
-                gp0WordsRemaining = 8;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0ShadedFourPointOpaque();
-                };
-                break;
-            }
-            case 0x3a: {
-                gp0WordsRemaining = 8;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0ShadedFourPointSemiTransparent();
-                };
-                break;
-            }
-            case 0x34: {
-                gp0WordsRemaining = 9;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0TexturedShadedThreePointOpaqueTextureBlending();
-                };
-                break;
-            }
-            case 0x36: {
-                gp0WordsRemaining = 9;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0TexturedShadedThreePointSemiTransparentTextureBlending();
-                };
-                break;
-            }
-            case 0x3c: {
-                gp0WordsRemaining = 12;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0TexturedShadedFourPointOpaqueTextureBlending();
-                };
-                break;
-            }
-            case 0x3e: {
-                gp0WordsRemaining = 12;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0TexturedShadedFourPointSemiTransparentTextureBlending();
-                };
-                break;
-            }
-            case 0x40: {
-                gp0WordsRemaining = 3;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0MonochromeLineOpaque();
-                };
-                break;
-            }
-            case 0x42: {
-                gp0WordsRemaining = 3;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0MonochromeLineSemiTransparent();
-                };
-                break;
-            }
-            case 0x48: {
-                gp0WordsRemaining = -1;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0MonochromePolylineOpaque();
-                };
-                break;
-            }
-            case 0x4a: {
-                gp0WordsRemaining = -1;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0MonochromePolylineSemiTransparent();
-                };
-                break;
-            }
-            case 0x50: {
-                gp0WordsRemaining = 4;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0ShadedLineOpaque();
-                };
-                break;
-            }
-            case 0x52: {
-                gp0WordsRemaining = 4;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0ShadedLineSemiTransparent();
-                };
-                break;
-            }
-            case 0x58: {
-                gp0WordsRemaining = -1;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0ShadedPolylineOpaque();
-                };
-                break;
-            }
-            case 0x5a: {
-                gp0WordsRemaining = -1;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0ShadedPolylineSemiTransparent();
-                };
-                break;
-            }
-            case 0x64: {
-                gp0WordsRemaining = 4;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0TexturedQuadOpaqueTextureBlending();
-                };
-                break;
-            }
-            case 0x65: {
-                gp0WordsRemaining = 4;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0TexturedQuadOpaqueRawTexture();
-                };
-                break;
-            }
-            case 0x66: {
-                gp0WordsRemaining = 4;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0TexturedQuadOpaqueRawTexture();
-                };
-                break;
-            }
-            case 0x67: {
-                gp0WordsRemaining = 4;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0TexturedQuadOpaqueRawTexture();
-                };
-                break;
-            }
-            case 0x60: {
-                gp0WordsRemaining = 3;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0MonochromeQuadOpaque();
-                };
-                break;
-            }
-            case 0x62: {
-                gp0WordsRemaining = 3;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0MonochromeQuadSemiTransparent();
-                };
-                break;
-            }
-            case 0x68: {
-                gp0WordsRemaining = 2;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0MonochromeQuad1x1Opaque();
-                };
-                break;
-            }
-            case 0x6a: {
-                gp0WordsRemaining = 2;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0MonochromeQuad1x1SemiTransparent();
-                };
-                break;
-            }
-            case 0x70: {
-                gp0WordsRemaining = 2;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0MonochromeQuad8x8Opaque();
-                };
-                break;
-            }
-            case 0x72: {
-                gp0WordsRemaining = 2;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0MonochromeQuad8x8SemiTransparent();
-                };
-                break;
-            }
-            case 0x78: {
-                gp0WordsRemaining = 2;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0MonochromeQuad16x16Opaque();
-                };
-                break;
-            }
-            case 0x7a: {
-                gp0WordsRemaining = 2;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0MonochromeQuad16x16SemiTransparent();
-                };
-                break;
-            }
-            case 0x6c: {
-                gp0WordsRemaining = 3;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0TexturedQuad1x1OpaqueTextureBlending();
-                };
-                break;
-            }
-            case 0x6d: {
-                gp0WordsRemaining = 3;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0TexturedQuad1x1OpaqueRawTexture();
-                };
-                break;
-            }
-            case 0x6e: {
-                gp0WordsRemaining = 3;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0TexturedQuad1x1SemiTransparentTextureBlending();
-                };
-                break;
-            }
-            case 0x6f: {
-                gp0WordsRemaining = 3;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0TexturedQuad1x1SemiTransparentRawTexture();
-                };
-                break;
-            }
-            case 0x74: {
-                gp0WordsRemaining = 3;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0TexturedQuad8x8OpaqueTextureBlending();
-                };
-                break;
-            }
-            case 0x75: {
-                gp0WordsRemaining = 3;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0TexturedQuad8x8OpaqueRawTexture();
-                };
-                break;
-            }
-            case 0x76: {
-                gp0WordsRemaining = 3;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0TexturedQuad8x8SemiTransparentTextureBlending();
-                };
-                break;
-            }
-            case 0x77: {
-                gp0WordsRemaining = 3;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0TexturedQuad8x8SemiTransparentRawTexture();
-                };
-                break;
-            }
-            case 0x7c: {
-                gp0WordsRemaining = 3;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0TexturedQuad16x16OpaqueTextureBlending();
-                };
-                break;
-            }
-            case 0x7d: {
-                gp0WordsRemaining = 3;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0TexturedQuad16x16OpaqueRawTexture();
-                };
-                break;
-            }
-            case 0x7e: {
-                gp0WordsRemaining = 3;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0TexturedQuad16x16SemiTransparentTextureBlending();
-                };
-                break;
-            }
-            case 0x7f: {
-                gp0WordsRemaining = 3;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0TexturedQuad16x16SemiTransparentRawTexture();
-                };
-                break;
-            }
-            case 0xa0: {
-                gp0WordsRemaining = 3;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0CopyRectangleCPUToVRAM();
-                };
-                break;
-            }
-            case 0xc0: {
-                gp0WordsRemaining = 3;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0CopyRectangleVRAMToCPU();
-                };
-                break;
-            }
-            case 0xe1: {
-                gp0WordsRemaining = 1;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0DrawMode();
-                };
-                break;
-            }
-            case 0xe2: {
-                gp0WordsRemaining = 1;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0TextureWindowSetting();
-                };
-                break;
-            }
-            case 0xe3: {
-                gp0WordsRemaining = 1;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0SetDrawingAreaTopLeft();
-                };
-                break;
-            }
-            case 0xe4: {
-                gp0WordsRemaining = 1;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0SetDrawingAreaBottomRight();
-                };
-                break;
-            }
-            case 0xe5: {
-                gp0WordsRemaining = 1;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0SetDrawingOffset();
-                };
-                break;
-            }
-            case 0xe6: {
-                gp0WordsRemaining = 1;
-                gp0InstructionMethod = [&]() {
-                    this->operationGp0MaskBitSetting();
-                };
-                break;
-            }
-            default: {
-                logger.logError("Unhandled gp0 instruction %#x", opCode);
-            }
-        }
+        const GP0Operation &operation = gp0Operations[opCode];
+        gp0WordsRemaining = operation.words;
+        gp0InstructionMethod = operation.method;
         gp0InstructionBuffer.clear();
     }
     gp0WordsRemaining -= 1;
@@ -563,27 +235,46 @@ void GPU::executeGp0(uint32_t value) {
         gp0InstructionBuffer.pushWord(value);
         gp0WordsRead++;
         if (gp0WordsRemaining == 0) {
-            gp0InstructionMethod();
+            (this->*gp0InstructionMethod)();
         }
         if (value == GP0_COMMAND_TERMINATION_CODE) {
-            gp0InstructionMethod();
+            (this->*gp0InstructionMethod)();
             gp0WordsRemaining = 0;
         }
     } else if (gp0Mode == GP0Mode::ImageLoad) {
         imageBuffer->pushWord(value);
         if (gp0WordsRemaining == 0) {
-            renderer->loadImage(imageBuffer);
+            if (renderer) {
+                renderer->loadImage(imageBuffer);
+            }
             gp0Mode = GP0Mode::Command;
         }
     }
 }
 
 void GPU::render() {
+    if (commandRing) {
+        commandRing->push(GPUCommandKind::RenderCommand, 0);
+        synchronize();
+        return;
+    }
+    renderFrame();
+}
+
+void GPU::renderFrame() {
+    if (!renderer) {
+        return;
+    }
     renderer->prepareFrame();
     renderer->renderFrame();
     renderer->finalizeFrame(this);
 }
 
+// Goes through GPUSTAT, so a threaded GPU only waits for the commands that can change it
+VideoMode GPU::currentVideoMode() {
+    return VideoMode((load<uint32_t>(4) >> 20) & 0x1);
+}
+
 Dimensions GPU::getResolution() {
     uint32_t verticalResolution = 240;
     if (this->verticalResolution == VerticalResolution::Y480) {
@@ -616,6 +307,24 @@ Point GPU::getDisplayAreaStart() {
     return { (int16_t)displayVRAMStartX, (int16_t)displayVRAMStartY };
 }
 
+bool GPU::readVRAM(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t *pixels) {
+    if (!renderer) {
+        return false;
+    }
+    bool result = false;
+    runOnThread([&]() {
+        result = renderer->readVRAM(x, y, width, height, pixels);
+    });
+    return result;
+}
+
+RendererStatistics GPU::rendererStatistics() {
+    if (!renderer) {
+        return RendererStatistics();
+    }
+    return renderer->lastFrameStatistics();
+}
+
 void GPU::executeGp1(uint32_t value) {
     uint32_t opCode = (value >> 24) & 0xff;
     switch (opCode) {
@@ -839,7 +548,9 @@ void GPU::operationGp0SetDrawingOffset() {
     int16_t drawingOffsetX = ((int16_t)(x << 5)) >> 5;
     int16_t drawingOffsetY = ((int16_t)(y << 5)) >> 5;
 
-    renderer->setDrawingOffset(drawingOffsetX, drawingOffsetY);
+    if (renderer) {
+        renderer->setDrawingOffset(drawingOffsetX, drawingOffsetY);
+    }
 }
 
 /*
@@ -955,705 +666,8 @@ void GPU::operationGp0CopyRectangleVRAMToCPU() {
     logger.logWarning("Unhandled GP0 Copy Rectangle VRAM to CPU with with resolution: %d x %d", width, height);
 }
 
-/*
-GP0(20h) - Monochrome three-point polygon, opaque
-1st  Color+Command     (CcBbGgRrh)
-2nd  Vertex1           (YyyyXxxxh)
-3rd  Vertex2           (YyyyXxxxh)
-4th  Vertex3           (YyyyXxxxh)
-*/
-void GPU::operationGp0MonochromeThreePointOpaque() {
-    monochromePolygon(3, true);
-    return;
-}
-
-/*
-GP0(22h) - Monochrome three-point polygon, semi-transparent
-1st  Color+Command     (CcBbGgRrh)
-2nd  Vertex1           (YyyyXxxxh)
-3rd  Vertex2           (YyyyXxxxh)
-4th  Vertex3           (YyyyXxxxh)
-*/
-void GPU::operationGp0MonochromeThreePointSemiTransparent() {
-    monochromePolygon(3, false);
-    return;
-}
-
-/*
-GP0(28h) - Monochrome four-point polygon, opaque
-1st  Color+Command     (CcBbGgRrh)
-2nd  Vertex1           (YyyyXxxxh)
-3rd  Vertex2           (YyyyXxxxh)
-4th  Vertex3           (YyyyXxxxh)
-(5th) Vertex4           (YyyyXxxxh) (if any)
-*/
-void GPU::operationGp0MonochromeFourPointOpaque() {
-    monochromePolygon(4, true);
-    return;
-}
-
-/*
-GP0(2Ah) - Monochrome four-point polygon, semi-transparent
-1st  Color+Command     (CcBbGgRrh)
-2nd  Vertex1           (YyyyXxxxh)
-3rd  Vertex2           (YyyyXxxxh)
-4th  Vertex3           (YyyyXxxxh)
-(5th) Vertex4           (YyyyXxxxh) (if any)
-*/
-void GPU::operationGp0MonochromeFourPointSemiTransparent() {
-    monochromePolygon(4, false);
-    return;
-}
-
-/*
-GP0(24h) - Textured three-point polygon, opaque, texture-blending
-1st  Color+Command     (CcBbGgRrh) (color is ignored for raw-textures)
-2nd  Vertex1           (YyyyXxxxh)
-3rd  Texcoord1+Palette (ClutYyXxh)
-4th  Vertex2           (YyyyXxxxh)
-5th  Texcoord2+Texpage (PageYyXxh)
-6th  Vertex3           (YyyyXxxxh)
-7th  Texcoord3         (0000YyXxh)
-*/
-void GPU::operationGp0TexturedThreePointOpaqueTextureBlending() {
-    texturedPolygon(3, true, TextureBlendModeTextureBlend);
-    return;
-}
-
-/*
-GP0(25h) - Textured three-point polygon, opaque, raw-texture
-1st  Color+Command     (CcBbGgRrh) (color is ignored for raw-textures)
-2nd  Vertex1           (YyyyXxxxh)
-3rd  Texcoord1+Palette (ClutYyXxh)
-4th  Vertex2           (YyyyXxxxh)
-5th  Texcoord2+Texpage (PageYyXxh)
-6th  Vertex3           (YyyyXxxxh)
-7th  Texcoord3         (0000YyXxh)
-*/
-void GPU::operationGp0TexturedThreePointOpaqueRawTexture() {
-    texturedPolygon(3, true, TextureBlendModeRawTexture);
-    return;
-}
-
-/*
-GP0(26h) - Textured three-point polygon, semi-transparent, texture-blending
-1st  Color+Command     (CcBbGgRrh) (color is ignored for raw-textures)
-2nd  Vertex1           (YyyyXxxxh)
-3rd  Texcoord1+Palette (ClutYyXxh)
-4th  Vertex2           (YyyyXxxxh)
-5th  Texcoord2+Texpage (PageYyXxh)
-6th  Vertex3           (YyyyXxxxh)
-7th  Texcoord3         (0000YyXxh)
-*/
-void GPU::operationGp0TexturedThreePointSemiTransparentTextureBlending() {
-    texturedPolygon(3, false, TextureBlendModeTextureBlend);
-    return;
-}
-
-/*
-GP0(27h) - Textured three-point polygon, semi-transparent, raw-texture
-1st  Color+Command     (CcBbGgRrh) (color is ignored for raw-textures)
-2nd  Vertex1           (YyyyXxxxh)
-3rd  Texcoord1+Palette (ClutYyXxh)
-4th  Vertex2           (YyyyXxxxh)
-5th  Texcoord2+Texpage (PageYyXxh)
-6th  Vertex3           (YyyyXxxxh)
-7th  Texcoord3         (0000YyXxh)
-*/
-void GPU::operationGp0TexturedThreePointSemiTransparentRawTexture() {
-    texturedPolygon(3, false, TextureBlendModeRawTexture);
-    return;
-}
-
-/*
-GP0(2Ch) - Textured four-point polygon, opaque, texture-blending
-1st  Color+Command     (CcBbGgRrh) (color is ignored for raw-textures)
-2nd  Vertex1           (YyyyXxxxh)
-3rd  Texcoord1+Palette (ClutYyXxh)
-4th  Vertex2           (YyyyXxxxh)
-5th  Texcoord2+Texpage (PageYyXxh)
-6th  Vertex3           (YyyyXxxxh)
-7th  Texcoord3         (0000YyXxh)
-(8th) Vertex4           (YyyyXxxxh) (if any)
-(9th) Texcoord4         (0000YyXxh) (if any)
-*/
-void GPU::operationGp0TexturedFourPointOpaqueTextureBlending() {
-    texturedPolygon(4, true, TextureBlendModeTextureBlend);
-    return;
-}
-
-/*
-GP0(2Dh) - Textured four-point polygon, opaque, raw-texture
-1st  Color+Command     (CcBbGgRrh) (color is ignored for raw-textures)
-2nd  Vertex1           (YyyyXxxxh)
-3rd  Texcoord1+Palette (ClutYyXxh)
-4th  Vertex2           (YyyyXxxxh)
-5th  Texcoord2+Texpage (PageYyXxh)
-6th  Vertex3           (YyyyXxxxh)
-7th  Texcoord3         (0000YyXxh)
-(8th) Vertex4           (YyyyXxxxh) (if any)
-(9th) Texcoord4         (0000YyXxh) (if any)
-*/
-void GPU::operationGp0TexturedFourPointOpaqueRawTexture() {
-    texturedPolygon(4, true, TextureBlendModeRawTexture);
-    return;
-}
-
-/*
-GP0(2Eh) - Textured four-point polygon, semi-transparent, texture-blending
-1st  Color+Command     (CcBbGgRrh) (color is ignored for raw-textures)
-2nd  Vertex1           (YyyyXxxxh)
-3rd  Texcoord1+Palette (ClutYyXxh)
-4th  Vertex2           (YyyyXxxxh)
-5th  Texcoord2+Texpage (PageYyXxh)
-6th  Vertex3           (YyyyXxxxh)
-7th  Texcoord3         (0000YyXxh)
-(8th) Vertex4           (YyyyXxxxh) (if any)
-(9th) Texcoord4         (0000YyXxh) (if any)
-*/
-void GPU::operationGp0TexturedFourPointSemiTransparentTextureBlending() {
-    texturedPolygon(4, false, TextureBlendModeTextureBlend);
-    return;
-}
-
-/*
-GP0(2Fh) - Textured four-point polygon, semi-transparent, raw-texture
-1st  Color+Command     (CcBbGgRrh) (color is ignored for raw-textures)
-2nd  Vertex1           (YyyyXxxxh)
-3rd  Texcoord1+Palette (ClutYyXxh)
-4th  Vertex2           (YyyyXxxxh)
-5th  Texcoord2+Texpage (PageYyXxh)
-6th  Vertex3           (YyyyXxxxh)
-7th  Texcoord3         (0000YyXxh)
-(8th) Vertex4           (YyyyXxxxh) (if any)
-(9th) Texcoord4         (0000YyXxh) (if any)
-*/
-void GPU::operationGp0TexturedFourPointSemiTransparentRawTexture() {
-    texturedPolygon(4, false, TextureBlendModeRawTexture);
-    return;
-}
-
-/*
-GP0(30h) - Shaded three-point polygon, opaque
-  1st  Color1+Command    (CcBbGgRrh)
-  2nd  Vertex1           (YyyyXxxxh)
-  3rd  Color2            (00BbGgRrh)
-  4th  Vertex2           (YyyyXxxxh)
-  5th  Color3            (00BbGgRrh)
-  6th  Vertex3           (YyyyXxxxh)
-*/
-void GPU::operationGp0ShadedThreePointOpaque() {
-    shadedPolygon(3, true);
-    return;
-}
-
-/*
-GP0(30h) - Shaded three-point polygon, opaque
-  1st  Color1+Command    (CcBbGgRrh)
-  2nd  Vertex1           (YyyyXxxxh)
-  3rd  Color2            (00BbGgRrh)
-  4th  Vertex2           (YyyyXxxxh)
-  5th  Color3            (00BbGgRrh)
-  6th  Vertex3           (YyyyXxxxh)
-*/
-void GPU::operationGp0ShadedThreePointSemiTransparent() {
-    shadedPolygon(3, false);
-    return;
-}
-
-/*
-GP0(30h) - Shaded three-point polygon, opaque
-  1st  Color1+Command    (CcBbGgRrh)
-  2nd  Vertex1           (YyyyXxxxh)
-  3rd  Color2            (00BbGgRrh)
-  4th  Vertex2           (YyyyXxxxh)
-  5th  Color3            (00BbGgRrh)
-  6th  Vertex3           (YyyyXxxxh)
- (7th) Color4            (00BbGgRrh) (if any)
- (8th) Vertex4           (YyyyXxxxh) (if any)
-
-*/
-void GPU::operationGp0ShadedFourPointOpaque() {
-    shadedPolygon(4, true);
-    return;
-}
-
-/*
-GP0(30h) - Shaded three-point polygon, opaque
-  1st  Color1+Command    (CcBbGgRrh)
-  2nd  Vertex1           (YyyyXxxxh)
-  3rd  Color2            (00BbGgRrh)
-  4th  Vertex2           (YyyyXxxxh)
-  5th  Color3            (00BbGgRrh)
-  6th  Vertex3           (YyyyXxxxh)
- (7th) Color4            (00BbGgRrh) (if any)
- (8th) Vertex4           (YyyyXxxxh) (if any)
-*/
-void GPU::operationGp0ShadedFourPointSemiTransparent() {
-    shadedPolygon(4, false);
-    return;
-}
-
-/*
-GP0(34h) - Shaded Textured three-point polygon, opaque, texture-blending
-  1st  Color1+Command    (CcBbGgRrh)
-  2nd  Vertex1           (YyyyXxxxh)
-  3rd  Texcoord1+Palette (ClutYyXxh)
-  4th  Color2            (00BbGgRrh)
-  5th  Vertex2           (YyyyXxxxh)
-  6th  Texcoord2+Texpage (PageYyXxh)
-  7th  Color3            (00BbGgRrh)
-  8th  Vertex3           (YyyyXxxxh)
-  9th  Texcoord3         (0000YyXxh)
-*/
-void GPU::operationGp0TexturedShadedThreePointOpaqueTextureBlending() {
-    shadedTexturedPolygon(3, true, TextureBlendModeTextureBlend);
-    return;
-}
-
-/*
-GP0(36h) - Shaded Textured three-point polygon, semi-transparent, tex-blend
-  1st  Color1+Command    (CcBbGgRrh)
-  2nd  Vertex1           (YyyyXxxxh)
-  3rd  Texcoord1+Palette (ClutYyXxh)
-  4th  Color2            (00BbGgRrh)
-  5th  Vertex2           (YyyyXxxxh)
-  6th  Texcoord2+Texpage (PageYyXxh)
-  7th  Color3            (00BbGgRrh)
-  8th  Vertex3           (YyyyXxxxh)
-  9th  Texcoord3         (0000YyXxh)
-*/
-void GPU::operationGp0TexturedShadedThreePointSemiTransparentTextureBlending() {
-    shadedTexturedPolygon(3, false, TextureBlendModeTextureBlend);
-    return;
-}
-
-/*
-GP0(3Ch) - Shaded Textured four-point polygon, opaque, texture-blending
-  1st  Color1+Command    (CcBbGgRrh)
-  2nd  Vertex1           (YyyyXxxxh)
-  3rd  Texcoord1+Palette (ClutYyXxh)
-  4th  Color2            (00BbGgRrh)
-  5th  Vertex2           (YyyyXxxxh)
-  6th  Texcoord2+Texpage (PageYyXxh)
-  7th  Color3            (00BbGgRrh)
-  8th  Vertex3           (YyyyXxxxh)
-  9th  Texcoord3         (0000YyXxh)
- (10th) Color4           (00BbGgRrh) (if any)
- (11th) Vertex4          (YyyyXxxxh) (if any)
- (12th) Texcoord4        (0000YyXxh) (if any)
-*/
-void GPU::operationGp0TexturedShadedFourPointOpaqueTextureBlending() {
-    shadedTexturedPolygon(4, true, TextureBlendModeTextureBlend);
-    return;
-}
-
-/*
-GP0(3Eh) - Shaded Textured four-point polygon, semi-transparent, tex-blend
-  1st  Color1+Command    (CcBbGgRrh)
-  2nd  Vertex1           (YyyyXxxxh)
-  3rd  Texcoord1+Palette (ClutYyXxh)
-  4th  Color2            (00BbGgRrh)
-  5th  Vertex2           (YyyyXxxxh)
-  6th  Texcoord2+Texpage (PageYyXxh)
-  7th  Color3            (00BbGgRrh)
-  8th  Vertex3           (YyyyXxxxh)
-  9th  Texcoord3         (0000YyXxh)
- (10th) Color4           (00BbGgRrh) (if any)
- (11th) Vertex4          (YyyyXxxxh) (if any)
- (12th) Texcoord4        (0000YyXxh) (if any)
-*/
-void GPU::operationGp0TexturedShadedFourPointSemiTransparentTextureBlending() {
-    shadedTexturedPolygon(4, true, TextureBlendModeTextureBlend);
-    return;
-}
-
-/*
-GP0(40h) - Monochrome line, opaque
-  1st   Color+Command     (CcBbGgRrh)
-  2nd   Vertex1           (YyyyXxxxh)
-  3rd   Vertex2           (YyyyXxxxh)
-*/
-void GPU::operationGp0MonochromeLineOpaque() {
-    monochromeLine(2, true);
-    return;
-}
-
-/*
-GP0(42h) - Monochrome line, semi-transparent
-  1st   Color+Command     (CcBbGgRrh)
-  2nd   Vertex1           (YyyyXxxxh)
-  3rd   Vertex2           (YyyyXxxxh)
-*/
-void GPU::operationGp0MonochromeLineSemiTransparent() {
-    monochromeLine(2, false);
-    return;
-}
-
-/*
-GP0(48h) - Monochrome Poly-line, opaque
-  1st   Color+Command     (CcBbGgRrh)
-  2nd   Vertex1           (YyyyXxxxh)
-  3rd   Vertex2           (YyyyXxxxh)
- (...)  VertexN           (YyyyXxxxh) (poly-line only)
- (Last) Termination Code  (55555555h) (poly-line only)
-*/
-void GPU::operationGp0MonochromePolylineOpaque() {
-    monochromeLine(gp0WordsRead - 2, true);
-    return;
-}
-
-/*
-GP0(4Ah) - Monochrome Poly-line, semi-transparent
-  1st   Color+Command     (CcBbGgRrh)
-  2nd   Vertex1           (YyyyXxxxh)
-  3rd   Vertex2           (YyyyXxxxh)
- (...)  VertexN           (YyyyXxxxh) (poly-line only)
- (Last) Termination Code  (55555555h) (poly-line only)
-*/
-void GPU::operationGp0MonochromePolylineSemiTransparent() {
-    monochromeLine(gp0WordsRead - 2, true);
-    return;
-}
-
-/*
-GP0(50h) - Shaded line, opaque
-  1st   Color1+Command    (CcBbGgRrh)
-  2nd   Vertex1           (YyyyXxxxh)
-  3rd   Color2            (00BbGgRrh)
-  4th   Vertex2           (YyyyXxxxh)
-*/
-void GPU::operationGp0ShadedLineOpaque() {
-    shadedLine(2, true);
-    return;
-}
-
-/*
-GP0(52h) - Shaded line, semi-transparent
-  1st   Color1+Command    (CcBbGgRrh)
-  2nd   Vertex1           (YyyyXxxxh)
-  3rd   Color2            (00BbGgRrh)
-  4th   Vertex2           (YyyyXxxxh)
-*/
-void GPU::operationGp0ShadedLineSemiTransparent() {
-    shadedLine(2, false);
-    return;
-}
-
-/*
-GP0(58h) - Shaded Poly-line, opaque
-  1st   Color1+Command    (CcBbGgRrh)
-  2nd   Vertex1           (YyyyXxxxh)
-  3rd   Color2            (00BbGgRrh)
-  4th   Vertex2           (YyyyXxxxh)
- (...)  ColorN            (00BbGgRrh) (poly-line only)
- (...)  VertexN           (YyyyXxxxh) (poly-line only)
- (Last) Termination Code  (55555555h) (poly-line only)
-*/
-void GPU::operationGp0ShadedPolylineOpaque()  {
-    shadedLine((gp0WordsRead - 1) / 2, true);
-    return;
-}
-
-/*
-GP0(5Ah) - Shaded Poly-line, semi-transparent
-  1st   Color1+Command    (CcBbGgRrh)
-  2nd   Vertex1           (YyyyXxxxh)
-  3rd   Color2            (00BbGgRrh)
-  4th   Vertex2           (YyyyXxxxh)
- (...)  ColorN            (00BbGgRrh) (poly-line only)
- (...)  VertexN           (YyyyXxxxh) (poly-line only)
- (Last) Termination Code  (55555555h) (poly-line only)
-*/
-void GPU::operationGp0ShadedPolylineSemiTransparent() {
-    shadedLine((gp0WordsRead - 1) / 2, false);
-    return;
-}
-
-/*
-GP0(60h) - Monochrome Rectangle (variable size) (opaque)
-1st  Color+Command     (CcBbGgRrh)
-2nd  Vertex            (YyyyXxxxh)
-(3rd) Width+Height      (YsizXsizh) (variable size only) (max 1023x511)
-*/
-void GPU::operationGp0MonochromeQuadOpaque() {
-    Dimensions dimensions = Dimensions(gp0InstructionBuffer[2]);
-    quad(dimensions, true);
-    return;
-}
-
-/*
-GP0(62h) - Monochrome Rectangle (variable size) (semi-transparent)
-1st  Color+Command     (CcBbGgRrh)
-2nd  Vertex            (YyyyXxxxh)
-(3rd) Width+Height      (YsizXsizh) (variable size only) (max 1023x511)
-*/
-void GPU::operationGp0MonochromeQuadSemiTransparent() {
-    Dimensions dimensions = Dimensions(gp0InstructionBuffer[2]);
-    quad(dimensions, false);
-    return;
-}
-
-/*
-GP0(68h) - Monochrome Rectangle (1x1) (Dot) (opaque)
-1st  Color+Command     (CcBbGgRrh)
-2nd  Vertex            (YyyyXxxxh)
-*/
-void GPU::operationGp0MonochromeQuad1x1Opaque() {
-    Dimensions dimensions = Dimensions(1, 1);
-    quad(dimensions, true);
-    return;
-}
-
-/*
-GP0(6Ah) - Monochrome Rectangle (1x1) (Dot) (semi-transparent)
-1st  Color+Command     (CcBbGgRrh)
-2nd  Vertex            (YyyyXxxxh)
-*/
-void GPU::operationGp0MonochromeQuad1x1SemiTransparent() {
-    Dimensions dimensions = Dimensions(1, 1);
-    quad(dimensions, false);
-    return;
-}
-
-/*
-GP0(70h) - Monochrome Rectangle (8x8) (opaque)
-1st  Color+Command     (CcBbGgRrh)
-2nd  Vertex            (YyyyXxxxh)
-*/
-void GPU::operationGp0MonochromeQuad8x8Opaque() {
-    Dimensions dimensions = Dimensions(8, 8);
-    quad(dimensions, true);
-    return;
-}
-
-/*
-GP0(72h) - Monochrome Rectangle (8x8) (semi-transparent)
-1st  Color+Command     (CcBbGgRrh)
-2nd  Vertex            (YyyyXxxxh)
-*/
-void GPU::operationGp0MonochromeQuad8x8SemiTransparent() {
-    Dimensions dimensions = Dimensions(8, 8);
-    quad(dimensions, false);
-    return;
-}
-
-/*
-GP0(78h) - Monochrome Rectangle (16x16) (opaque)
-1st  Color+Command     (CcBbGgRrh)
-2nd  Vertex            (YyyyXxxxh)
-*/
-void GPU::operationGp0MonochromeQuad16x16Opaque() {
-    Dimensions dimensions = Dimensions(16, 16);
-    quad(dimensions, true);
-    return;
-}
-
-/*
-GP0(7Ah) - Monochrome Rectangle (16x16) (semi-transparent)
-1st  Color+Command     (CcBbGgRrh)
-2nd  Vertex            (YyyyXxxxh)
-*/
-void GPU::operationGp0MonochromeQuad16x16SemiTransparent() {
-    Dimensions dimensions = Dimensions(16, 16);
-    quad(dimensions, false);
-    return;
-}
-
-/*
-GP0(64h) - Textured Rectangle, variable size, opaque, texture-blending
-1st  Color+Command     (CcBbGgRrh) (color is ignored for raw-textures)
-2nd  Vertex            (YyyyXxxxh) (upper-left edge of the rectangle)
-3rd  Texcoord+Palette  (ClutYyXxh) (for 4bpp Textures Xxh must be even!)
-(4th) Width+Height      (YsizXsizh) (variable size only) (max 1023x511)
-*/
-void GPU::operationGp0TexturedQuadOpaqueTextureBlending() {
-    Dimensions dimensions = Dimensions(gp0InstructionBuffer[3]);
-    texturedQuad(dimensions, true, TextureBlendModeTextureBlend);
-    return;
-}
-
-/*
-GP0(65h) - Textured Rectangle, variable size, opaque, raw-texture
-1st  Color+Command     (CcBbGgRrh) (color is ignored for raw-textures)
-2nd  Vertex            (YyyyXxxxh) (upper-left edge of the rectangle)
-3rd  Texcoord+Palette  (ClutYyXxh) (for 4bpp Textures Xxh must be even!)
-(4th) Width+Height      (YsizXsizh) (variable size only) (max 1023x511)
-*/
-void GPU::operationGp0TexturedQuadOpaqueRawTexture() {
-    Dimensions dimensions = Dimensions(gp0InstructionBuffer[3]);
-    texturedQuad(dimensions, true, TextureBlendModeRawTexture);
-    return;
-}
-
-/*
-GP0(66h) - Textured Rectangle, variable size, semi-transp, texture-blending
-1st  Color+Command     (CcBbGgRrh) (color is ignored for raw-textures)
-2nd  Vertex            (YyyyXxxxh) (upper-left edge of the rectangle)
-3rd  Texcoord+Palette  (ClutYyXxh) (for 4bpp Textures Xxh must be even!)
-(4th) Width+Height      (YsizXsizh) (variable size only) (max 1023x511)
-*/
-void GPU::operationGp0TexturedSemiTransparentOpaqueTextureBlending() {
-    Dimensions dimensions = Dimensions(gp0InstructionBuffer[3]);
-    texturedQuad(dimensions, false, TextureBlendModeTextureBlend);
-    return;
-}
-
-/*
-GP0(67h) - Textured Rectangle, variable size, semi-transp, raw-texture
-1st  Color+Command     (CcBbGgRrh) (color is ignored for raw-textures)
-2nd  Vertex            (YyyyXxxxh) (upper-left edge of the rectangle)
-3rd  Texcoord+Palette  (ClutYyXxh) (for 4bpp Textures Xxh must be even!)
-(4th) Width+Height      (YsizXsizh) (variable size only) (max 1023x511)
-*/
-void GPU::operationGp0TexturedSemiTransparentOpaqueRawTexture() {
-    Dimensions dimensions = Dimensions(gp0InstructionBuffer[3]);
-    texturedQuad(dimensions, false, TextureBlendModeRawTexture);
-    return;
-}
-
-/*
-GP0(6Ch) - Textured Rectangle, 1x1 (nonsense), opaque, texture-blending
-1st  Color+Command     (CcBbGgRrh) (color is ignored for raw-textures)
-2nd  Vertex            (YyyyXxxxh) (upper-left edge of the rectangle)
-3rd  Texcoord+Palette  (ClutYyXxh) (for 4bpp Textures Xxh must be even!)
-*/
-void GPU::operationGp0TexturedQuad1x1OpaqueTextureBlending() {
-    Dimensions dimensions = Dimensions(1, 1);
-    texturedQuad(dimensions, true, TextureBlendModeTextureBlend);
-    return;
-}
-
-/*
-GP0(6Dh) - Textured Rectangle, 1x1 (nonsense), opaque, raw-texture
-1st  Color+Command     (CcBbGgRrh) (color is ignored for raw-textures)
-2nd  Vertex            (YyyyXxxxh) (upper-left edge of the rectangle)
-3rd  Texcoord+Palette  (ClutYyXxh) (for 4bpp Textures Xxh must be even!)
-*/
-void GPU::operationGp0TexturedQuad1x1OpaqueRawTexture() {
-    Dimensions dimensions = Dimensions(1, 1);
-    texturedQuad(dimensions, true, TextureBlendModeRawTexture);
-    return;
-}
-
-/*
-GP0(6Eh) - Textured Rectangle, 1x1 (nonsense), semi-transp, texture-blending
-1st  Color+Command     (CcBbGgRrh) (color is ignored for raw-textures)
-2nd  Vertex            (YyyyXxxxh) (upper-left edge of the rectangle)
-3rd  Texcoord+Palette  (ClutYyXxh) (for 4bpp Textures Xxh must be even!)
-*/
-void GPU::operationGp0TexturedQuad1x1SemiTransparentTextureBlending() {
-    Dimensions dimensions = Dimensions(1, 1);
-    texturedQuad(dimensions, false, TextureBlendModeTextureBlend);
-    return;
-}
-
-/*
-GP0(6Fh) - Textured Rectangle, 1x1 (nonsense), semi-transp, raw-texture
-1st  Color+Command     (CcBbGgRrh) (color is ignored for raw-textures)
-2nd  Vertex            (YyyyXxxxh) (upper-left edge of the rectangle)
-3rd  Texcoord+Palette  (ClutYyXxh) (for 4bpp Textures Xxh must be even!)
-*/
-void GPU::operationGp0TexturedQuad1x1SemiTransparentRawTexture() {
-    Dimensions dimensions = Dimensions(1, 1);
-    texturedQuad(dimensions, false, TextureBlendModeRawTexture);
-    return;
-}
-
-/*
-GP0(74h) - Textured Rectangle, 8x8, opaque, texture-blending
-1st  Color+Command     (CcBbGgRrh) (color is ignored for raw-textures)
-2nd  Vertex            (YyyyXxxxh) (upper-left edge of the rectangle)
-3rd  Texcoord+Palette  (ClutYyXxh) (for 4bpp Textures Xxh must be even!)
-*/
-void GPU::operationGp0TexturedQuad8x8OpaqueTextureBlending() {
-    Dimensions dimensions = Dimensions(8, 8);
-    texturedQuad(dimensions, true, TextureBlendModeTextureBlend);
-    return;
-}
-
-/*
-GP0(75h) - Textured Rectangle, 8x8, opaque, raw-texture
-1st  Color+Command     (CcBbGgRrh) (color is ignored for raw-textures)
-2nd  Vertex            (YyyyXxxxh) (upper-left edge of the rectangle)
-3rd  Texcoord+Palette  (ClutYyXxh) (for 4bpp Textures Xxh must be even!)
-*/
-void GPU::operationGp0TexturedQuad8x8OpaqueRawTexture() {
-    Dimensions dimensions = Dimensions(8, 8);
-    texturedQuad(dimensions, true, TextureBlendModeRawTexture);
-    return;
-}
-
-/*
-GP0(76h) - Textured Rectangle, 8x8, semi-transparent, texture-blending
-1st  Color+Command     (CcBbGgRrh) (color is ignored for raw-textures)
-2nd  Vertex            (YyyyXxxxh) (upper-left edge of the rectangle)
-3rd  Texcoord+Palette  (ClutYyXxh) (for 4bpp Textures Xxh must be even!)
-*/
-void GPU::operationGp0TexturedQuad8x8SemiTransparentTextureBlending() {
-    Dimensions dimensions = Dimensions(8, 8);
-    texturedQuad(dimensions, false, TextureBlendModeTextureBlend);
-    return;
-}
-
-/*
-GP0(77h) - Textured Rectangle, 8x8, semi-transparent, raw-texture
-1st  Color+Command     (CcBbGgRrh) (color is ignored for raw-textures)
-2nd  Vertex            (YyyyXxxxh) (upper-left edge of the rectangle)
-3rd  Texcoord+Palette  (ClutYyXxh) (for 4bpp Textures Xxh must be even!)
-*/
-void GPU::operationGp0TexturedQuad8x8SemiTransparentRawTexture() {
-    Dimensions dimensions = Dimensions(8, 8);
-    texturedQuad(dimensions, false, TextureBlendModeRawTexture);
-    return;
-}
-
-/*
-GP0(7Ch) - Textured Rectangle, 16x16, opaque, texture-blending
-1st  Color+Command     (CcBbGgRrh) (color is ignored for raw-textures)
-2nd  Vertex            (YyyyXxxxh) (upper-left edge of the rectangle)
-3rd  Texcoord+Palette  (ClutYyXxh) (for 4bpp Textures Xxh must be even!)
-*/
-void GPU::operationGp0TexturedQuad16x16OpaqueTextureBlending() {
-    Dimensions dimensions = Dimensions(16, 16);
-    texturedQuad(dimensions, true, TextureBlendModeTextureBlend);
-    return;
-}
-
-/*
-GP0(7Dh) - Textured Rectangle, 16x16, opaque, raw-texture
-1st  Color+Command     (CcBbGgRrh) (color is ignored for raw-textures)
-2nd  Vertex            (YyyyXxxxh) (upper-left edge of the rectangle)
-3rd  Texcoord+Palette  (ClutYyXxh) (for 4bpp Textures Xxh must be even!)
-*/
-void GPU::operationGp0TexturedQuad16x16OpaqueRawTexture() {
-    Dimensions dimensions = Dimensions(16, 16);
-    texturedQuad(dimensions, true, TextureBlendModeRawTexture);
-    return;
-}
-
-/*
-GP0(7Eh) - Textured Rectangle, 16x16, semi-transparent, texture-blending
-1st  Color+Command     (CcBbGgRrh) (color is ignored for raw-textures)
-2nd  Vertex            (YyyyXxxxh) (upper-left edge of the rectangle)
-3rd  Texcoord+Palette  (ClutYyXxh) (for 4bpp Textures Xxh must be even!)
-*/
-void GPU::operationGp0TexturedQuad16x16SemiTransparentTextureBlending() {
-    Dimensions dimensions = Dimensions(16, 16);
-    texturedQuad(dimensions, false, TextureBlendModeTextureBlend);
-    return;
-}
-
-/*
-GP0(7Fh) - Textured Rectangle, 16x16, semi-transparent, raw-texture
-1st  Color+Command     (CcBbGgRrh) (color is ignored for raw-textures)
-2nd  Vertex            (YyyyXxxxh) (upper-left edge of the rectangle)
-3rd  Texcoord+Palette  (ClutYyXxh) (for 4bpp Textures Xxh must be even!)
-*/
-void GPU::operationGp0TexturedQuad16x16SemiTransparentRawTexture() {
-    Dimensions dimensions = Dimensions(16, 16);
-    texturedQuad(dimensions, false, TextureBlendModeRawTexture);
-    return;
+void GPU::operationGp0Unhandled() {
+    logger.logError("Unhandled gp0 instruction %#x", gp0InstructionBuffer[0] >> 24);
 }
 
 /*
@@ -1762,13 +776,15 @@ void GPU::operationGp0FillRectagleInVRAM() {
     Vertex bottomRight = Vertex(gp0InstructionBuffer[1], color);
     bottomRight.point.x = bottomRight.point.x + width;
     bottomRight.point.y = bottomRight.point.y + height;
-    vector<Vertex> vertices = {
+    Vertex vertices[] = {
         topLeft,
         topRight,
         bottomLeft,
         bottomRight,
     };
-    renderer->pushPolygon(vertices);
+    if (renderer) {
+        renderer->pushPolygon(vertices, 4);
+    }
     return;
 }
 
@@ -1797,15 +813,17 @@ void GPU::texturedQuad(Dimensions dimensions, bool opaque, TextureBlendMode text
     texturePageData <<= 2;
     texturePageData |= texturePageBaseX;
     Point texturePage = Point::forTexturePage(texturePageData);
-    GLuint textureDepthShift = 2 - texturePageColors;
+    uint32_t textureDepthShift = 2 - texturePageColors;
     Point clut = Point::forClut(gp0InstructionBuffer[2] >> 16);
-    vector<Vertex> vertices = {
+    Vertex vertices[] = {
         Vertex(point1, color, texturePoint1, textureBlendMode, texturePage, textureDepthShift, clut),
         Vertex(point2, color, texturePoint2, textureBlendMode, texturePage, textureDepthShift, clut),
         Vertex(point3, color, texturePoint3, textureBlendMode, texturePage, textureDepthShift, clut),
         Vertex(point4, color, texturePoint4, textureBlendMode, texturePage, textureDepthShift, clut),
     };
-    renderer->pushPolygon(vertices);
+    if (renderer) {
+        renderer->pushPolygon(vertices, 4);
+    }
     return;
 }
 
@@ -1822,13 +840,15 @@ void GPU::quad(Dimensions dimensions, bool opaque) {
     Vertex bottomRight = Vertex(point, color);
     bottomRight.point.x += dimensions.width;
     bottomRight.point.y += dimensions.height;
-    vector<Vertex> vertices = {
+    Vertex vertices[] = {
         topLeft,
         topRight,
         bottomLeft,
         bottomRight,
     };
-    renderer->pushPolygon(vertices);
+    if (renderer) {
+        renderer->pushPolygon(vertices, 4);
+    }
     return;
 }
 
@@ -1836,24 +856,28 @@ void GPU::monochromePolygon(unsigned int numberOfPoints, bool opaque) {
     // TODO: unused
     (void)opaque;
     Color color = Color(gp0InstructionBuffer[0]);
-    vector<Vertex> vertices = vector<Vertex>();
+    Vertex vertices[GPU_POLYGON_MAXIMUM_VERTICES];
     for (unsigned int i = 1; i <= numberOfPoints; i++) {
         Point point = Point(gp0InstructionBuffer[i]);
-        vertices.push_back(Vertex(point, color));
+        vertices[i-1] = Vertex(point, color);
+    }
+    if (renderer) {
+        renderer->pushPolygon(vertices, numberOfPoints);
     }
-    renderer->pushPolygon(vertices);
 }
 
 void GPU::shadedPolygon(unsigned int numberOfPoints, bool opaque) {
     // TODO: unused
     (void)opaque;
-    vector<Vertex> vertices = vector<Vertex>();
+    Vertex vertices[GPU_POLYGON_MAXIMUM_VERTICES];
     for (unsigned int i = 0; i < numberOfPoints; i++) {
         Color color = Color(gp0InstructionBuffer[i*2]);
         Point point = Point(gp0InstructionBuffer[i*2+1]);
-        vertices.push_back(Vertex(point, color));
+        vertices[i] = Vertex(point, color);
+    }
+    if (renderer) {
+        renderer->pushPolygon(vertices, numberOfPoints);
     }
-    renderer->pushPolygon(vertices);
 }
 
 void GPU::texturedPolygon(unsigned int numberOfPoints, bool opaque, TextureBlendMode textureBlendMode) {
@@ -1864,16 +888,17 @@ void GPU::texturedPolygon(unsigned int numberOfPoints, bool opaque, TextureBlend
     Point clut = Point::forClut(gp0InstructionBuffer[2] >> 16);
     Point texturePage = Point::forTexturePage(gp0InstructionBuffer[4] >> 16);
     TexturePageColors texturePageColors = texturePageColorsWithValue(((gp0InstructionBuffer[4] >> 16) >> 7) & 0x3);
-    GLuint textureDepthShift = 2 - texturePageColors;
+    uint32_t textureDepthShift = 2 - texturePageColors;
 
-    vector<Vertex> vertices = vector<Vertex>();
+    Vertex vertices[GPU_POLYGON_MAXIMUM_VERTICES];
     for (unsigned int i = 0; i < numberOfPoints; i++) {
         Point point = Point(gp0InstructionBuffer[i*2+1]);
         Point texturePoint = Point::forTexturePosition(gp0InstructionBuffer[i*2+2] & 0xffff);
-        Vertex vertex = Vertex(point, color, texturePoint, textureBlendMode, texturePage, textureDepthShift, clut);
-        vertices.push_back(vertex);
+        vertices[i] = Vertex(point, color, texturePoint, textureBlendMode, texturePage, textureDepthShift, clut);
+    }
+    if (renderer) {
+        renderer->pushPolygon(vertices, numberOfPoints);
     }
-    renderer->pushPolygon(vertices);
 }
 
 void GPU::shadedTexturedPolygon(unsigned int numberOfPoints, bool opaque, TextureBlendMode textureBlendMode) {
@@ -1883,59 +908,46 @@ void GPU::shadedTexturedPolygon(unsigned int numberOfPoints, bool opaque, Textur
     Point clut = Point::forClut(gp0InstructionBuffer[2] >> 16);
     Point texturePage = Point::forTexturePage(gp0InstructionBuffer[5] >> 16);
     TexturePageColors texturePageColors = texturePageColorsWithValue(((gp0InstructionBuffer[5] >> 16) >> 7) & 0x3);
-    GLuint textureDepthShift = 2 - texturePageColors;
-    vector<Vertex> vertices = vector<Vertex>();
+    uint32_t textureDepthShift = 2 - texturePageColors;
+    Vertex vertices[GPU_POLYGON_MAXIMUM_VERTICES];
     for (unsigned int i = 0; i < numberOfPoints; i++) {
         Color color = Color(gp0InstructionBuffer[i*3]);
         Point point = Point(gp0InstructionBuffer[i*3+1]);
         Point texturePoint = Point::forTexturePosition(gp0InstructionBuffer[i*3+2] & 0xffff);
-        Vertex vertex = Vertex(point, color, texturePoint, textureBlendMode, texturePage, textureDepthShift, clut);
-        vertices.push_back(vertex);
+        vertices[i] = Vertex(point, color, texturePoint, textureBlendMode, texturePage, textureDepthShift, clut);
+    }
+    if (renderer) {
+        renderer->pushPolygon(vertices, numberOfPoints);
     }
-    renderer->pushPolygon(vertices);
 }
 
+// Polylines are pushed one segment at a time
 void GPU::monochromeLine(unsigned int numberOfPoints, bool opaque) {
     // TODO: unused
     (void)opaque;
     Color color = Color(gp0InstructionBuffer[0]);
-    vector<Vertex> vertices = vector<Vertex>();
-    for (unsigned int i = 1; i <= numberOfPoints; i++) {
-        Point point = Point(gp0InstructionBuffer[i]);
-        vertices.push_back(Vertex(point, color));
-    }
-    if (numberOfPoints == 2) {
-        renderer->pushLine(vertices);
-        return;
-    }
-    vector<Vertex> lines = vector<Vertex>();
-    for (unsigned int i = 0; i < vertices.size() - 1; i++) {
-        lines.push_back(vertices[i]);
-        lines.push_back(vertices[i+1]);
-        renderer->pushLine(lines);
-        lines.clear();
+    Vertex segment[2];
+    segment[1] = Vertex(Point(gp0InstructionBuffer[1]), color);
+    for (unsigned int i = 2; i <= numberOfPoints; i++) {
+        segment[0] = segment[1];
+        segment[1] = Vertex(Point(gp0InstructionBuffer[i]), color);
+        if (renderer) {
+            renderer->pushLine(segment, 2);
+        }
     }
 }
 
 void GPU::shadedLine(unsigned int numberOfPoints, bool opaque) {
     // TODO: unused
     (void)opaque;
-    vector<Vertex> vertices = vector<Vertex>();
-    for (unsigned int i = 0; i < numberOfPoints; i++) {
-        Color color = Color(gp0InstructionBuffer[i*2]);
-        Point point = Point(gp0InstructionBuffer[i*2+1]);
-        vertices.push_back(Vertex(point, color));
-    }
-    if (numberOfPoints == 2) {
-        renderer->pushLine(vertices);
-        return;
-    }
-    vector<Vertex> lines = vector<Vertex>();
-    for (unsigned int i = 0; i < vertices.size() - 1; i++) {
-        lines.push_back(vertices[i]);
-        lines.push_back(vertices[i+1]);
-        renderer->pushLine(lines);
-        lines.clear();
+    Vertex segment[2];
+    segment[1] = Vertex(Point(gp0InstructionBuffer[1]), Color(gp0InstructionBuffer[0]));
+    for (unsigned int i = 1; i < numberOfPoints; i++) {
+        segment[0] = segment[1];
+        segment[1] = Vertex(Point(gp0InstructionBuffer[i*2+1]), Color(gp0InstructionBuffer[i*2]));
+        if (renderer) {
+            renderer->pushLine(segment, 2);
+        }
     }
 }
 
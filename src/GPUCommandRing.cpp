@@ -0,0 +1,38 @@
+#include "GPUCommandRing.tcc"
+#include <thread>
+
+using namespace std;
+
+// Yields before going to sleep, commands usually come in bursts
+const uint32_t SPINS_BEFORE_SLEEPING = 1000;
+
+GPUCommandRing::GPUCommandRing() : commands(GPU_COMMAND_RING_SIZE), writeIndex(0), readIndex(0), isConsumerSleeping(false) {}
+
+GPUCommandRing::~GPUCommandRing() {}
+
+void GPUCommandRing::waitUntilPopped(uint64_t count) {
+    while (readIndex.load(memory_order_acquire) < count) {
+        this_thread::yield();
+    }
+}
+
+void GPUCommandRing::waitForCommand() {
+    uint64_t index = readIndex.load(memory_order_relaxed);
+    for (uint32_t spin = 0; spin < SPINS_BEFORE_SLEEPING; spin++) {
+        if (index != writeIndex.load(memory_order_acquire)) {
+            return;
+        }
+        this_thread::yield();
+    }
+    unique_lock<std::mutex> lock(mutex);
+    isConsumerSleeping.store(true, memory_order_seq_cst);
+    condition.wait(lock, [&]() {
+        return index != writeIndex.load(memory_order_seq_cst);
+    });
+    isConsumerSleeping.store(false, memory_order_relaxed);
+}
+
+void GPUCommandRing::wakeConsumer() {
+    lock_guard<std::mutex> lock(mutex);
+    condition.notify_one();
+}
@@ -15,6 +15,7 @@ GPUInstructionBuffer::~GPUInstructionBuffer() {
 uint32_t& GPUInstructionBuffer::operator[] (const uint8_t index) {
     if (index >= length) {
         logger.logError("GPU Instruction Buffer index-out-of-bounds: %d", index);
+        return buffer[0];
     }
     return buffer[index];
 }
@@ -0,0 +1,218 @@
+#include "HighLevelBIOS.hpp"
+#include "CPU.tcc"
+#include <algorithm>
+
+using namespace std;
+
+const uint32_t BIOS_A_FUNCTIONS_ADDRESS = 0xA0;
+const uint32_t BIOS_B_FUNCTIONS_ADDRESS = 0xB0;
+
+// Rough instruction counts of the kernel routines, used to estimate how much
+// interpretation each native call saves: the A0/B0 dispatcher plus the
+// function prologue and epilogue, and the body of the copy/compare loops
+const uint32_t BIOS_FUNCTION_CALL_INSTRUCTIONS = 16;
+const uint32_t BIOS_FUNCTION_INSTRUCTIONS_PER_BYTE = 6;
+// std_out_putchar walks the kernel device table before getting to the TTY
+const uint32_t BIOS_PUTCHAR_INSTRUCTIONS = 120;
+
+HighLevelBIOS::HighLevelBIOS(LogLevel logLevel, unique_ptr<CPU> &cpu) : logger(logLevel, "  HLE: "), cpu(cpu), functions() {
+
+}
+
+HighLevelBIOS::~HighLevelBIOS() {
+
+}
+
+bool HighLevelBIOS::call(uint32_t programCounter, uint32_t r9) {
+    // Arguments could still be on their way from a load in the delay slot of the call
+    if (cpu->hasPendingDelaySlot()) {
+        return false;
+    }
+    array<uint32_t, 4> subroutineArguments = cpu->getSubroutineArguments();
+    BIOSFunctionStatistics *function = nullptr;
+    optional<uint32_t> result;
+    switch (programCounter) {
+        case BIOS_A_FUNCTIONS_ADDRESS: {
+            result = callAFunction(r9, subroutineArguments, function);
+            break;
+        }
+        case BIOS_B_FUNCTIONS_ADDRESS: {
+            result = callBFunction(r9, subroutineArguments, function);
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+    if (!result) {
+        return false;
+    }
+    logger.logMessage("%s returned %#x", function->name.c_str(), *result);
+    cpu->returnFromSubroutine(*result);
+    return true;
+}
+
+const vector<BIOSFunctionStatistics>& HighLevelBIOS::functionStatistics() const {
+    return functions;
+}
+
+optional<uint32_t> HighLevelBIOS::callAFunction(uint32_t r9, array<uint32_t, 4> subroutineArguments, BIOSFunctionStatistics *&function) {
+    uint32_t processedBytes = 0;
+    uint32_t result;
+    switch (r9) {
+        case 0x17: {
+            result = stringCompare(subroutineArguments[0], subroutineArguments[1], processedBytes);
+            function = statisticsForFunction("strcmp", processedBytes);
+            return { result };
+        }
+        case 0x19: {
+            result = stringCopy(subroutineArguments[0], subroutineArguments[1], processedBytes);
+            function = statisticsForFunction("strcpy", processedBytes);
+            return { result };
+        }
+        case 0x1B: {
+            result = stringLength(subroutineArguments[0], processedBytes);
+            function = statisticsForFunction("strlen", processedBytes);
+            return { result };
+        }
+        case 0x28: {
+            result = zeroMemory(subroutineArguments[0], subroutineArguments[1], processedBytes);
+            function = statisticsForFunction("bzero", processedBytes);
+            return { result };
+        }
+        case 0x2A: {
+            result = copyMemory(subroutineArguments[0], subroutineArguments[1], subroutineArguments[2], processedBytes);
+            function = statisticsForFunction("memcpy", processedBytes);
+            return { result };
+        }
+        case 0x2B: {
+            result = setMemory(subroutineArguments[0], subroutineArguments[1], subroutineArguments[2], processedBytes);
+            function = statisticsForFunction("memset", processedBytes);
+            return { result };
+        }
+        case 0x3C: {
+            // The character was already sent to the TTY log when the call was checked
+            function = statisticsForFunction("std_out_putchar", 0);
+            function->skippedInstructions += BIOS_PUTCHAR_INSTRUCTIONS;
+            return { subroutineArguments[0] & 0xff };
+        }
+        default: {
+            return nullopt;
+        }
+    }
+}
+
+optional<uint32_t> HighLevelBIOS::callBFunction(uint32_t r9, array<uint32_t, 4> subroutineArguments, BIOSFunctionStatistics *&function) {
+    switch (r9) {
+        case 0x3D: {
+            function = statisticsForFunction("std_out_putchar", 0);
+            function->skippedInstructions += BIOS_PUTCHAR_INSTRUCTIONS;
+            return { subroutineArguments[0] & 0xff };
+        }
+        default: {
+            return nullopt;
+        }
+    }
+}
+
+BIOSFunctionStatistics* HighLevelBIOS::statisticsForFunction(string name, uint32_t processedBytes) {
+    auto iterator = find_if(functions.begin(), functions.end(), [&](const BIOSFunctionStatistics &function) {
+        return function.name == name;
+    });
+    if (iterator == functions.end()) {
+        functions.push_back({ name, 0, 0 });
+        iterator = functions.end() - 1;
+    }
+    iterator->calls++;
+    iterator->skippedInstructions += BIOS_FUNCTION_CALL_INSTRUCTIONS + processedBytes * BIOS_FUNCTION_INSTRUCTIONS_PER_BYTE;
+    return &(*iterator);
+}
+
+/*
+The following follow the kernel behavior described in the no$ documentation,
+including what is returned for null pointers and non positive lengths:
+http://problemkaputt.de/psx-spx.htm#biosmemorystringfunctions
+*/
+
+uint32_t HighLevelBIOS::stringCompare(uint32_t str1, uint32_t str2, uint32_t &processedBytes) {
+    if (str1 == 0 && str2 == 0) {
+        return 0;
+    }
+    if (str1 == 0) {
+        return -1;
+    }
+    if (str2 == 0) {
+        return 1;
+    }
+    while (true) {
+        uint8_t c1 = cpu->load<uint8_t>(str1 + processedBytes);
+        uint8_t c2 = cpu->load<uint8_t>(str2 + processedBytes);
+        processedBytes++;
+        if (c1 != c2) {
+            return (int32_t)c1 - (int32_t)c2;
+        }
+        if (c1 == 0) {
+            return 0;
+        }
+    }
+}
+
+uint32_t HighLevelBIOS::stringCopy(uint32_t dst, uint32_t src, uint32_t &processedBytes) {
+    if (dst == 0 || src == 0) {
+        return 0;
+    }
+    while (true) {
+        uint8_t c = cpu->load<uint8_t>(src + processedBytes);
+        cpu->store<uint8_t>(dst + processedBytes, c);
+        processedBytes++;
+        if (c == 0) {
+            return dst;
+        }
+    }
+}
+
+uint32_t HighLevelBIOS::stringLength(uint32_t src, uint32_t &processedBytes) {
+    if (src == 0) {
+        return 0;
+    }
+    while (cpu->load<uint8_t>(src + processedBytes) != 0) {
+        processedBytes++;
+    }
+    return processedBytes;
+}
+
+uint32_t HighLevelBIOS::zeroMemory(uint32_t dst, uint32_t len, uint32_t &processedBytes) {
+    if (dst == 0 || (int32_t)len <= 0) {
+        return 0;
+    }
+    for (; processedBytes < len; processedBytes++) {
+        cpu->store<uint8_t>(dst + processedBytes, 0);
+    }
+    return dst;
+}
+
+uint32_t HighLevelBIOS::copyMemory(uint32_t dst, uint32_t src, uint32_t len, uint32_t &processedBytes) {
+    if (dst == 0 || src == 0) {
+        return 0;
+    }
+    if ((int32_t)len <= 0) {
+        return dst;
+    }
+    for (; processedBytes < len; processedBytes++) {
+        cpu->store<uint8_t>(dst + processedBytes, cpu->load<uint8_t>(src + processedBytes));
+    }
+    return dst;
+}
+
+uint32_t HighLevelBIOS::setMemory(uint32_t dst, uint32_t fillbyte, uint32_t len, uint32_t &processedBytes) {
+    if (dst == 0) {
+        return 0;
+    }
+    if ((int32_t)len <= 0) {
+        return dst;
+    }
+    for (; processedBytes < len; processedBytes++) {
+        cpu->store<uint8_t>(dst + processedBytes, fillbyte & 0xff);
+    }
+    return dst;
+}
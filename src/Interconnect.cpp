@@ -1,35 +1,166 @@
 #include "Interconnect.hpp"
+#include "Interconnect.tcc"
 #include "Range.hpp"
-#include "EmulatorRunner.hpp"
+#include <algorithm>
 
 using namespace std;
 
-const uint32_t regionMask[8] = {
-    // KUSEG: 2048MB
-    0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff,
-    // KSEG0: 512MB
-    0x7fffffff,
-    // KSEG1: 512MB
-    0x1fffffff,
-    // KSEG2: 1024MB
-    0xffffffff, 0xffffffff,
-};
+const array<pair<Range, IODevice>, 9> ioDeviceRanges = {{
+    { controllerRegisterRange, IOController },
+    { interruptRequestControlRange, IOInterruptController },
+    { dmaRegisterRange, IODMA },
+    { timer0RegisterRange, IOTimer0 },
+    { timer1RegisterRange, IOTimer1 },
+    { timer2RegisterRange, IOTimer2 },
+    { cdromRegisterRange, IOCDROM },
+    { gpuRegisterRange, IOGPU },
+    { soundProcessingUnitRange, IOSPU },
+}};
 
-Interconnect::Interconnect(LogLevel logLevel, std::unique_ptr<COP0> &cop0, unique_ptr<BIOS> &bios, unique_ptr<RAM> &ram, unique_ptr<GPU> &gpu, unique_ptr<DMA> &dma, unique_ptr<Scratchpad> &scratchpad, unique_ptr<CDROM> &cdrom, unique_ptr<InterruptController> &interruptController, unique_ptr<Expansion1> &expansion1, std::unique_ptr<Timer0> &timer0, std::unique_ptr<Timer1> &timer1, std::unique_ptr<Timer2> &timer2, std::unique_ptr<Controller> &controller, std::unique_ptr<SPU> &spu) : logger(logLevel), cop0(cop0), bios(bios), ram(ram), gpu(gpu), dma(dma), scratchpad(scratchpad), cdrom(cdrom), interruptController(interruptController), expansion1(expansion1), timer0(timer0), timer1(timer1), timer2(timer2), controller(controller), spu(spu) {
-    filesystem::path biosFilePath = filesystem::current_path() / "SCPH1001.BIN";
-    bios->loadBin(biosFilePath);
-    EmulatorRunner *emulatorRunner = EmulatorRunner::getInstance();
-    if (emulatorRunner->shouldRunTests()) {
-        filesystem::path expansionFilePath = filesystem::current_path() / "expansion" / "EXPNSION.BIN";
-        expansion1->loadBin(expansionFilePath);
+// Later entries take over the pages they share with earlier ones
+const array<pair<Range, MemoryRegion>, 6> memoryRegionRanges = {{
+    { ramMirrorsRange, RAMRegion },
+    { scratchpadRange, ScratchpadRegion },
+    { biosRange, BIOSRegion },
+    { expansion1Range, Expansion1Region },
+    { ioPortsRange, IOPortsRegion },
+    { soundProcessingUnitRange, SPURegion },
+}};
+
+static const char* ioDeviceName(IODevice device) {
+    switch (device) {
+        case IOController: return "Controller";
+        case IOInterruptController: return "IRQ";
+        case IODMA: return "DMA";
+        case IOTimer0: return "Timer 0";
+        case IOTimer1: return "Timer 1";
+        case IOTimer2: return "Timer 2";
+        case IOCDROM: return "CDROM";
+        case IOGPU: return "GPU";
+        case IOSPU: return "SPU";
+        case IOUnmapped: break;
+    }
+    return "";
+}
+
+Interconnect::Interconnect(LogLevel logLevel, std::unique_ptr<COP0> &cop0, unique_ptr<BIOS> &bios, unique_ptr<RAM> &ram, unique_ptr<GPU> &gpu, unique_ptr<DMA> &dma, unique_ptr<Scratchpad> &scratchpad, unique_ptr<CDROM> &cdrom, unique_ptr<InterruptController> &interruptController, unique_ptr<Expansion1> &expansion1, std::unique_ptr<Timer0> &timer0, std::unique_ptr<Timer1> &timer1, std::unique_ptr<Timer2> &timer2, std::unique_ptr<Controller> &controller, std::unique_ptr<SPU> &spu, std::unique_ptr<Debugger> &debugger) : logger(logLevel), cop0(cop0), bios(bios), ram(ram), gpu(gpu), dma(dma), scratchpad(scratchpad), cdrom(cdrom), interruptController(interruptController), expansion1(expansion1), timer0(timer0), timer1(timer1), timer2(timer2), controller(controller), spu(spu), debugger(debugger), loadPages(MEMORY_PAGE_COUNT, nullptr), storePages(MEMORY_PAGE_COUNT, nullptr), isolatedCacheStorePages(MEMORY_PAGE_COUNT, nullptr), currentStorePages(storePages.data()), fastmem(nullptr), pageRegions(MEMORY_PAGE_COUNT, UnmappedRegion), ioPorts(IO_PORT_COUNT, { IOUnmapped, 0 }), ioPortLoads(IO_PORT_COUNT, 0), ioPortStores(IO_PORT_COUNT, 0) {
+    for (uint32_t mirror = 0; mirror < 4; mirror++) {
+        mapPages(loadPages, mirror * RAM_SIZE, ram->dataAtOffset(0), RAM_SIZE);
+        mapPages(storePages, mirror * RAM_SIZE, ram->dataAtOffset(0), RAM_SIZE);
+    }
+    mapPages(loadPages, 0x1f800000, scratchpad->dataAtOffset(0), SCRATCHPAD_SIZE);
+    mapPages(storePages, 0x1f800000, scratchpad->dataAtOffset(0), SCRATCHPAD_SIZE);
+    mapPages(isolatedCacheStorePages, 0x1f800000, scratchpad->dataAtOffset(0), SCRATCHPAD_SIZE);
+    mapPages(loadPages, 0x1fc00000, bios->dataAtOffset(0), BIOS_SIZE);
+    updateCacheIsolation();
+    for (uint32_t port = 0; port < IO_PORT_COUNT; port++) {
+        uint32_t address = 0x1f801000 + port * 4;
+        for (const pair<Range, IODevice> &deviceRange : ioDeviceRanges) {
+            optional<uint32_t> offset = deviceRange.first.contains(address);
+            if (offset) {
+                ioPorts[port] = { deviceRange.second, static_cast<uint16_t>(*offset) };
+            }
+        }
+    }
+    for (uint32_t page = 0; page < MEMORY_PAGE_COUNT; page++) {
+        for (const pair<Range, MemoryRegion> &regionRange : memoryRegionRanges) {
+            if (regionRange.first.contains(page * MEMORY_PAGE_SIZE)) {
+                pageRegions[page] = regionRange.second;
+            }
+        }
     }
 }
 
 Interconnect::~Interconnect() {}
 
-uint32_t Interconnect::maskRegion(uint32_t address) const {
-    uint8_t index = address >> 29;
-    return address & regionMask[index];
+void Interconnect::mapPages(vector<uint8_t*> &pages, uint32_t address, uint8_t *data, uint32_t size) {
+    for (uint32_t offset = 0; offset < size; offset += MEMORY_PAGE_SIZE) {
+        pages[(address + offset) / MEMORY_PAGE_SIZE] = data + offset;
+    }
+}
+
+void Interconnect::mapRAMCodePageForStores(uint32_t offset, bool isMapped) {
+    uint32_t codePageOffset = offset - (offset % RAM_CODE_PAGE_SIZE);
+    for (uint32_t mirror = 0; mirror < 4; mirror++) {
+        for (uint32_t pageOffset = 0; pageOffset < RAM_CODE_PAGE_SIZE; pageOffset += MEMORY_PAGE_SIZE) {
+            uint32_t page = (mirror * RAM_SIZE + codePageOffset + pageOffset) / MEMORY_PAGE_SIZE;
+            storePages[page] = isMapped ? ram->dataAtOffset(codePageOffset + pageOffset) : nullptr;
+        }
+    }
+    if (fastmem) {
+        fastmem->setRAMCodePageWriteProtected(codePageOffset, !isMapped);
+    }
+}
+
+void Interconnect::updateCacheIsolation() {
+    if (cop0->isCacheIsolated()) {
+        currentStorePages = isolatedCacheStorePages.data();
+    } else {
+        currentStorePages = storePages.data();
+    }
+    if (fastmem) {
+        fastmem->setCacheIsolated(cop0->isCacheIsolated());
+    }
+}
+
+void Interconnect::enableFastmem() {
+    fastmem = make_unique<Fastmem>(LogLevel::Warning, this, *ram, *scratchpad, *bios);
+    if (!fastmem->isEnabled()) {
+        fastmem = nullptr;
+        return;
+    }
+    for (uint32_t offset = 0; offset < RAM_SIZE; offset += RAM_CODE_PAGE_SIZE) {
+        if (ram->isCodePage(offset)) {
+            fastmem->setRAMCodePageWriteProtected(offset, true);
+        }
+    }
+    fastmem->setCacheIsolated(cop0->isCacheIsolated());
+}
+
+Fastmem* Interconnect::getFastmem() const {
+    return fastmem.get();
+}
+
+// The I/O ports accessed the most since power on, most accessed first
+vector<IOPortStatistics> Interconnect::ioPortStatistics(size_t count) const {
+    vector<IOPortStatistics> statistics;
+    for (uint32_t port = 0; port < IO_PORT_COUNT; port++) {
+        if (ioPortLoads[port] == 0 && ioPortStores[port] == 0) {
+            continue;
+        }
+        statistics.push_back({ ioDeviceName(ioPorts[port].device), 0x1f801000 + port * 4, ioPortLoads[port], ioPortStores[port] });
+    }
+    sort(statistics.begin(), statistics.end(), [](const IOPortStatistics &a, const IOPortStatistics &b) {
+        return a.loads + a.stores > b.loads + b.stores;
+    });
+    if (statistics.size() > count) {
+        statistics.resize(count);
+    }
+    return statistics;
+}
+
+// Reading these addresses again and again gives the same value until a store or a scheduled
+// event changes it, as opposed to FIFOs such as GPUREAD or the CDROM response. Timer counters
+// are left out: they move with the clock without any event due, so a loop polling one only
+// looks idle between two ticks
+bool Interconnect::hasSideEffectFreeLoads(uint32_t address) const {
+    uint32_t absoluteAddress = maskRegion(address);
+    if (ramMirrorsRange.contains(absoluteAddress) || scratchpadRange.contains(absoluteAddress) || biosRange.contains(absoluteAddress)) {
+        return true;
+    }
+    if (interruptRequestControlRange.contains(absoluteAddress) || dmaRegisterRange.contains(absoluteAddress)) {
+        return true;
+    }
+    // GPUSTAT and the CDROM index/status register
+    optional<uint32_t> offset = gpuRegisterRange.contains(absoluteAddress);
+    if (offset) {
+        return *offset == 4;
+    }
+    offset = cdromRegisterRange.contains(absoluteAddress);
+    if (offset) {
+        return *offset == 0;
+    }
+    return false;
 }
 
 void Interconnect::transferToRAM(filesystem::path filePath, uint32_t origin, uint32_t size, uint32_t destination) {
@@ -0,0 +1,77 @@
+#include "LockstepJournal.hpp"
+#include "Output.hpp"
+
+using namespace std;
+
+LockstepJournal::LockstepJournal() : accesses(), replayIndex(0), replaying(false), divergence() {}
+
+LockstepJournal::~LockstepJournal() {}
+
+void LockstepJournal::startRecording() {
+    accesses.clear();
+    replayIndex = 0;
+    replaying = false;
+    divergence.reset();
+}
+
+void LockstepJournal::startReplaying() {
+    replayIndex = 0;
+    replaying = true;
+}
+
+bool LockstepJournal::isReplaying() const {
+    return replaying;
+}
+
+void LockstepJournal::recordLoad(uint32_t address, uint32_t size, uint32_t value) {
+    accesses.push_back({ false, address, size, value });
+}
+
+void LockstepJournal::recordStore(uint32_t address, uint32_t size, uint32_t value) {
+    accesses.push_back({ true, address, size, value });
+}
+
+const MemoryAccess* LockstepJournal::nextReplayedAccess(bool isStore, uint32_t address, uint32_t size) {
+    if (replayIndex >= accesses.size()) {
+        if (!divergence) {
+            divergence = format("interpreter made an extra %s of %u bytes at %#x", isStore ? "store" : "load", size, address);
+        }
+        return nullptr;
+    }
+    const MemoryAccess *access = &accesses[replayIndex];
+    replayIndex++;
+    if (access->isStore != isStore || access->address != address || access->size != size) {
+        if (!divergence) {
+            divergence = format("interpreter made a %s of %u bytes at %#x, recompiler made a %s of %u bytes at %#x", isStore ? "store" : "load", size, address, access->isStore ? "store" : "load", access->size, access->address);
+        }
+        return nullptr;
+    }
+    return access;
+}
+
+uint32_t LockstepJournal::replayLoad(uint32_t address, uint32_t size) {
+    const MemoryAccess *access = nextReplayedAccess(false, address, size);
+    if (access == nullptr) {
+        return 0;
+    }
+    return access->value;
+}
+
+void LockstepJournal::replayStore(uint32_t address, uint32_t size, uint32_t value) {
+    const MemoryAccess *access = nextReplayedAccess(true, address, size);
+    if (access == nullptr) {
+        return;
+    }
+    if (access->value != value && !divergence) {
+        divergence = format("interpreter stored %#x at %#x, recompiler stored %#x", value, address, access->value);
+    }
+}
+
+optional<string> LockstepJournal::finishReplaying() {
+    replaying = false;
+    if (!divergence && replayIndex != accesses.size()) {
+        const MemoryAccess &access = accesses[replayIndex];
+        divergence = format("recompiler made an extra %s of %u bytes at %#x", access.isStore ? "store" : "load", access.size, access.address);
+    }
+    return divergence;
+}
@@ -9,8 +9,13 @@ using namespace std;
 
 const uint32_t BUFFER_SIZE_LIMIT = 8192;
 
-std::stringstream stream = std::stringstream();
-uint16_t bufferSize = 0;
+// Trace messages are buffered per thread, so emulators running on different threads
+// don't share a buffer, and get appended to the log file in chunks
+thread_local std::stringstream stream = std::stringstream();
+thread_local uint16_t bufferSize = 0;
+// The chunks of every thread end up in the same file
+mutex logFileMutex;
+thread_local FatalErrorState *fatalErrorState = nullptr;
 
 LogLevel logLevelWithValue(std::string value) {
     if (value.compare("WAR") == 0) {
@@ -23,6 +28,38 @@ LogLevel logLevelWithValue(std::string value) {
     return LogLevel::NoLog;
 }
 
+FatalErrorState::FatalErrorState() : messageMutex(), failed(false), message() {}
+
+void FatalErrorState::fail(string message) {
+    lock_guard<mutex> lock(messageMutex);
+    if (failed) {
+        return;
+    }
+    this->message = message;
+    failed = true;
+}
+
+bool FatalErrorState::hasFailed() const {
+    return failed;
+}
+
+string FatalErrorState::errorMessage() const {
+    lock_guard<mutex> lock(messageMutex);
+    return message;
+}
+
+FatalErrorScope::FatalErrorScope(FatalErrorState *state) : previousState(fatalErrorState) {
+    fatalErrorState = state;
+}
+
+FatalErrorScope::~FatalErrorScope() {
+    fatalErrorState = previousState;
+}
+
+FatalErrorState* currentFatalErrorState() {
+    return fatalErrorState;
+}
+
 Logger::Logger(LogLevel level) : level(level), prefix("") {
     ConfigurationManager *configurationManager = ConfigurationManager::getInstance();
     shouldTrace = configurationManager->shouldTraceLogs();
@@ -36,6 +73,7 @@ Logger::Logger(LogLevel level, string prefix) : level(level), prefix(prefix) {
 Logger::Logger(LogLevel level, string prefix, bool shouldTrace) : level(level), prefix(prefix), shouldTrace(shouldTrace) {}
 
 void Logger::flush() const {
+    lock_guard<mutex> lock(logFileMutex);
     ofstream logfile = ofstream();
     filesystem::path logFilePath = filesystem::current_path() / "ruby.log";
     logfile.open(logFilePath, ios::out | ios::app);
@@ -106,5 +144,9 @@ void Logger::logError(const char *fmt, ...) const {
     cout << formatted << endl;
     traceMessage(formatted);
     flush();
+    if (fatalErrorState) {
+        fatalErrorState->fail(formatted);
+        return;
+    }
     exit(1);
 }
@@ -0,0 +1,375 @@
+#include "Machine.hpp"
+#include "ConfigurationManager.hpp"
+#include "Constants.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+using namespace std;
+
+Machine::Machine(filesystem::path biosFilePath) : logger(LogLevel::NoLog), fatalErrors(), ttyBuffer(), biosFunctionsLog(), statistics(), measuredFrames(0), measuredInstructions(0), measuredClocks(0), measuredTime(), emulatedFrames(0), exitRequested(false), exitCode(0) {
+    FatalErrorScope fatalErrorScope(&fatalErrors);
+    ConfigurationManager *configurationManager = ConfigurationManager::getInstance();
+    scheduler = make_unique<Scheduler>();
+    scheduler->schedule(VBlankEvent, SystemClocksPerVideoFrame);
+    debugger = make_unique<Debugger>();
+    cop0 = make_unique<COP0>();
+    bios = make_unique<BIOS>(configurationManager->biosLogLevel());
+    bios->loadBin(biosFilePath);
+    ram = make_unique<RAM>();
+    gpu = make_unique<GPU>(configurationManager->gpuLogLevel());
+    gpu->setThreaded(configurationManager->shouldRunGPUOnThread());
+    scratchpad = make_unique<Scratchpad>();
+    interruptController = make_unique<InterruptController>(configurationManager->interruptLogLevel(), cop0);
+    LogLevel cdromLogLevel = configurationManager->cdromLogLevel();
+    cdrom = make_unique<CDROM>(cdromLogLevel, interruptController, scheduler);
+    dma = make_unique<DMA>(configurationManager->dmaLogLevel(), ram, gpu, cdrom, interruptController);
+    expansion1 = make_unique<Expansion1>();
+    timer0 = make_unique<Timer0>(scheduler);
+    timer1 = make_unique<Timer1>(scheduler);
+    timer2 = make_unique<Timer2>(scheduler);
+    controller = make_unique<Controller>(configurationManager->controllerLogLevel(), interruptController, scheduler);
+    spu = make_unique<SPU>(configurationManager->spuLogLevel());
+    interconnect = make_unique<Interconnect>(configurationManager->interconnectLogLevel(), cop0, bios, ram, gpu, dma, scratchpad, cdrom, interruptController, expansion1, timer0, timer1, timer2, controller, spu, debugger);
+    if (configurationManager->shouldUseFastmem()) {
+        interconnect->enableFastmem();
+    }
+    cpu = make_unique<CPU>(configurationManager->cpuLogLevel(), interconnect, cop0, scheduler, debugger, false);
+    debugger->setCPU(cpu.get());
+    cpu->setExecutionMode(configurationManager->cpuExecutionMode());
+    cpu->setLockstep(configurationManager->shouldRunCPUInLockstep());
+    cpu->setIdleLoopSkipping(configurationManager->shouldSkipCPUIdleLoops());
+    cpu->setClockPercentage(configurationManager->cpuClockPercentage());
+    for (uint32_t address : bios->functionsStepAddresses()) {
+        cpu->addExecutionHook(address);
+    }
+    if (configurationManager->shouldEmulateBIOSFunctions()) {
+        highLevelBIOS = make_unique<HighLevelBIOS>(configurationManager->biosLogLevel(), cpu);
+    }
+    statistics.biosHighLevelEmulation = highLevelBIOS != nullptr;
+    statistics.cpuExecutionMode = cpuExecutionModeName(cpu->getExecutionMode());
+    statistics.cpuClockPercentage = cpu->getClockPercentage();
+}
+
+Machine::~Machine() {}
+
+void Machine::loadExpansion(filesystem::path filePath) {
+    FatalErrorScope fatalErrorScope(&fatalErrors);
+    expansion1->loadBin(filePath);
+}
+
+void Machine::loadExecutable(filesystem::path filePath) {
+    FatalErrorScope fatalErrorScope(&fatalErrors);
+    executable = make_unique<Executable>(LogLevel::NoLog, filePath);
+}
+
+void Machine::loadCDROMImageFile(filesystem::path filePath) {
+    FatalErrorScope fatalErrorScope(&fatalErrors);
+    cdrom->loadCDROMImageFile(filePath);
+}
+
+void Machine::setRenderer(unique_ptr<GPUBackend> renderer) {
+    FatalErrorScope fatalErrorScope(&fatalErrors);
+    gpu->setRenderer(move(renderer));
+}
+
+bool Machine::isGPUThreaded() {
+    return gpu->isThreaded();
+}
+
+void Machine::attachRendererToCurrentThread() {
+    gpu->attachRendererToCurrentThread();
+}
+
+void Machine::detachRendererFromCurrentThread() {
+    gpu->detachRendererFromCurrentThread();
+}
+
+void Machine::setControllerSwitches(DigitalControllerSwitches switches) {
+    controller->setSwitches(switches);
+}
+
+void Machine::queueControllerSwitches(DigitalControllerSwitches switches, uint64_t timestamp) {
+    // Switches are applied in the order they were queued, even if the clocks go backwards
+    timestamp = max(timestamp, scheduler->currentTimestamp());
+    if (!pendingControllerSwitches.empty()) {
+        timestamp = max(timestamp, pendingControllerSwitches.back().first);
+    }
+    pendingControllerSwitches.push_back({ timestamp, switches });
+    if (!scheduler->isScheduled(InputEvent)) {
+        scheduler->schedule(InputEvent, timestamp - scheduler->currentTimestamp());
+    }
+}
+
+void Machine::emulateFrame() {
+    chrono::steady_clock::time_point frameStart = chrono::steady_clock::now();
+    uint64_t skippedIdleCyclesAtFrameStart = cpu->skippedIdleCycleCount();
+    uint64_t frameStartTimestamp = scheduler->currentTimestamp();
+    uint64_t instructionsAtFrameStart = statistics.executedInstructions;
+    // A frame ends at VBLANK. The CPU clock scaling only changes how many
+    // instructions fit in a frame, the events keep their timestamps
+    bool isFrameComplete = false;
+    while (!isFrameComplete && !exitRequested && !fatalErrors.hasFailed()) {
+        isFrameComplete = runSlice(numeric_limits<uint32_t>::max());
+    }
+    statistics.skippedIdleCycles = cpu->skippedIdleCycleCount() - skippedIdleCyclesAtFrameStart;
+    updateStatistics(statistics.executedInstructions - instructionsAtFrameStart, scheduler->currentTimestamp() - frameStartTimestamp, chrono::steady_clock::now() - frameStart);
+}
+
+void Machine::emulateCycles(uint64_t cycles) {
+    uint64_t endTimestamp = scheduler->currentTimestamp() + cycles;
+    while (scheduler->currentTimestamp() < endTimestamp && !exitRequested && !fatalErrors.hasFailed()) {
+        runSlice(endTimestamp - scheduler->currentTimestamp());
+    }
+}
+
+// Runs the CPU until the budget is spent or the next scheduled event is due, then
+// lets the device that scheduled it catch up. Returns true when VBLANK was reached
+bool Machine::runSlice(uint64_t cycleBudget) {
+    // Errors logged while running stop the machine instead of the process
+    FatalErrorScope fatalErrorScope(&fatalErrors);
+    // The CPU stops at the BIOS function hooks, so they are checked right before executing them
+    checkBIOSFunctions();
+    // Nothing runs after the program exits or the machine failed
+    if (exitRequested || fatalErrors.hasFailed()) {
+        return false;
+    }
+    uint32_t executedInstructions;
+    if (!cpu->run(min<uint64_t>(cycleBudget, numeric_limits<uint32_t>::max()), executedInstructions)) {
+        sideloadExecutable();
+    }
+    statistics.executedInstructions += executedInstructions;
+    bool isFrameComplete = false;
+    optional<SchedulerEvent> event;
+    while ((event = scheduler->popDueEvent())) {
+        if (handleScheduledEvent(*event)) {
+            isFrameComplete = true;
+        }
+    }
+    return isFrameComplete;
+}
+
+// Returns true when the event ends the frame
+bool Machine::handleScheduledEvent(SchedulerEvent event) {
+    switch (event) {
+        case VBlankEvent: {
+            // PAL has more and slightly shorter scanlines, 50 frames a second instead of 60
+            scheduler->schedule(VBlankEvent, gpu->currentVideoMode() == VideoMode::PAL ? PALSystemClocksPerVideoFrame : SystemClocksPerVideoFrame);
+            interruptController->trigger(VBLANK);
+            emulatedFrames++;
+            gpu->render();
+            return true;
+        }
+        case InputEvent: {
+            while (!pendingControllerSwitches.empty() && pendingControllerSwitches.front().first <= scheduler->currentTimestamp()) {
+                controller->setSwitches(pendingControllerSwitches.front().second);
+                pendingControllerSwitches.pop_front();
+            }
+            if (!pendingControllerSwitches.empty()) {
+                scheduler->schedule(InputEvent, pendingControllerSwitches.front().first - scheduler->currentTimestamp());
+            }
+            return false;
+        }
+        case Timer0Event: {
+            timer0->update();
+            break;
+        }
+        case Timer1Event: {
+            timer1->update();
+            break;
+        }
+        case Timer2Event: {
+            timer2->update();
+            break;
+        }
+        case CDROMInterruptEvent: {
+            cdrom->triggerInterrupt();
+            break;
+        }
+        case CDROMSectorEvent: {
+            cdrom->readNextSector();
+            break;
+        }
+        case ControllerEvent: {
+            controller->triggerAcknowledgeInterrupt();
+            break;
+        }
+        case SchedulerEventCount: {
+            break;
+        }
+    }
+    return false;
+}
+
+void Machine::sideloadExecutable() {
+    if (!executable) {
+        return;
+    }
+    interconnect->transferToRAM(executable->getFilePath(), 0x800, executable->fileSize(), executable->destinationAddress());
+    cpu->setProgramCounter(executable->programCounter());
+    cpu->setGlobalPointer(executable->globalPointer());
+    cpu->setStackPointer(executable->initialStackFramePointerBase() + executable->initialStackFramePointeroffset());
+    cpu->setFramePointer(executable->initialStackFramePointerBase() + executable->initialStackFramePointeroffset());
+}
+
+void Machine::updateStatistics(uint64_t executedInstructions, uint64_t emulatedClocks, chrono::steady_clock::duration frameTime) {
+    measuredFrames++;
+    measuredInstructions += executedInstructions;
+    measuredClocks += emulatedClocks;
+    measuredTime += frameTime;
+    if (measuredFrames < FrameRateTarget) {
+        return;
+    }
+    double seconds = chrono::duration<double>(measuredTime).count();
+    if (seconds > 0) {
+        statistics.emulatedMHz = (measuredInstructions / seconds) / 1000000.0;
+    }
+    if (measuredClocks > 0) {
+        double emulatedSeconds = static_cast<double>(measuredClocks) / SystemClocksPerSecond;
+        statistics.guestMIPS = (measuredInstructions / emulatedSeconds) / 1000000.0;
+    }
+    statistics.cpuExecutionMode = cpuExecutionModeName(cpu->getExecutionMode());
+    statistics.cachedBasicBlocks = cpu->basicBlockCount();
+    statistics.invalidatedBasicBlocks = cpu->invalidatedBasicBlockCount();
+    statistics.recompiledBasicBlocks = cpu->recompiledBasicBlockCount();
+    statistics.cpuLockstep = cpu->isLockstepEnabled();
+    statistics.ioPorts = interconnect->ioPortStatistics(8);
+    statistics.renderer = gpu->rendererStatistics();
+    if (highLevelBIOS) {
+        statistics.biosFunctions = highLevelBIOS->functionStatistics();
+    }
+    measuredFrames = 0;
+    measuredInstructions = 0;
+    measuredClocks = 0;
+    measuredTime = chrono::steady_clock::duration::zero();
+}
+
+bool Machine::readRAM(uint32_t address, uint32_t size, uint8_t *data) {
+    uint32_t offset = address & 0x1fffffff;
+    if (offset >= RAM_SIZE || size > RAM_SIZE - offset) {
+        return false;
+    }
+    memcpy(data, ram->dataAtOffset(offset), size);
+    return true;
+}
+
+bool Machine::readVRAM(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t *pixels) {
+    return gpu->readVRAM(x, y, width, height, pixels);
+}
+
+void Machine::dumpRAM() {
+    interconnect->dumpRAM();
+}
+
+CPU* Machine::getCPU() {
+    return cpu.get();
+}
+
+Debugger* Machine::getDebugger() {
+    return debugger.get();
+}
+
+const EmulationStatistics& Machine::getStatistics() {
+    return statistics;
+}
+
+const vector<string>& Machine::getBIOSFunctionsLog() {
+    return biosFunctionsLog;
+}
+
+uint64_t Machine::emulatedFrameCount() {
+    return emulatedFrames;
+}
+
+uint64_t Machine::executedInstructionCount() {
+    return statistics.executedInstructions;
+}
+
+uint64_t Machine::elapsedCycles() {
+    return scheduler->currentTimestamp();
+}
+
+bool Machine::hasExited() {
+    return exitRequested;
+}
+
+uint32_t Machine::getExitCode() {
+    return exitCode;
+}
+
+bool Machine::hasFailed() {
+    return fatalErrors.hasFailed();
+}
+
+string Machine::getErrorMessage() {
+    return fatalErrors.errorMessage();
+}
+
+void Machine::cycleCPUExecutionMode() {
+    switch (cpu->getExecutionMode()) {
+        case CPUExecutionMode::Interpreter: {
+            cpu->setExecutionMode(CPUExecutionMode::CachedInterpreter);
+            break;
+        }
+        case CPUExecutionMode::CachedInterpreter: {
+            cpu->setExecutionMode(CPUExecutionMode::DynamicRecompiler);
+            break;
+        }
+        case CPUExecutionMode::DynamicRecompiler: {
+            cpu->setExecutionMode(CPUExecutionMode::Interpreter);
+            break;
+        }
+    }
+    statistics.cpuExecutionMode = cpuExecutionModeName(cpu->getExecutionMode());
+}
+
+void Machine::toggleCPULockstep() {
+    cpu->setLockstep(!cpu->isLockstepEnabled());
+    statistics.cpuLockstep = cpu->isLockstepEnabled();
+}
+
+void Machine::cycleCPUClock() {
+    const uint32_t clockPercentages[] = { 50, 100, 150, 200, 300, 400 };
+    uint32_t current = cpu->getClockPercentage();
+    uint32_t next = clockPercentages[0];
+    for (uint32_t percentage : clockPercentages) {
+        if (percentage > current) {
+            next = percentage;
+            break;
+        }
+    }
+    cpu->setClockPercentage(next);
+    statistics.cpuClockPercentage = cpu->getClockPercentage();
+}
+
+void Machine::checkTTY(char c) {
+    if (c == '\n') {
+        logger.logDebug("%s", ttyBuffer.c_str());
+        ttyBuffer.clear();
+        return;
+    }
+    ttyBuffer.append(1, c);
+}
+
+void Machine::checkBIOSFunctions() {
+    array<uint32_t, 32> registers = cpu->getRegisters();
+    uint32_t function = registers[9];
+    array<uint32_t, 4> subroutineArguments = cpu->getSubroutineArguments();
+    uint32_t programCounter = cpu->getProgramCounter();
+    optional<string> result = bios->checkFunctions(programCounter, function, subroutineArguments);
+    if (!result) {
+        return;
+    }
+    string functionCallLog = (*result);
+    if (functionCallLog.find("std_out_putchar(char)") == 0) {
+        checkTTY(registers[4]);
+    }
+    if (functionCallLog.find("exit(exitcode)") == 0) {
+        exitRequested = true;
+        exitCode = registers[4];
+    }
+    biosFunctionsLog.push_back(functionCallLog);
+    if (highLevelBIOS) {
+        highLevelBIOS->call(programCounter, function);
+    }
+}
@@ -5,18 +5,41 @@
 
 using namespace std;
 
-RAM::RAM() : data() {
+RAM::RAM() : memory(RAM_SIZE), data(memory.getData()), codePages(), codePageGenerations() {
 }
 
 RAM::~RAM() {
 
 }
 
+uint8_t* RAM::dataAtOffset(uint32_t offset) {
+    return &data[offset];
+}
+
+const SharedMemory& RAM::getMemory() const {
+    return memory;
+}
+
 void RAM::receiveTransfer(filesystem::path filePath, uint32_t origin, uint32_t size, uint32_t destination) {
+    invalidateCodePages(destination, size);
     uint8_t *dataDestination = &data[destination];
     readBinary(filePath, dataDestination, origin, size);
 }
 
+void RAM::invalidateCodePages(uint32_t offset, uint32_t size) {
+    if (size == 0) {
+        return;
+    }
+    uint32_t firstPage = offset / RAM_CODE_PAGE_SIZE;
+    uint32_t lastPage = min((offset + size - 1) / RAM_CODE_PAGE_SIZE, RAM_CODE_PAGE_COUNT - 1);
+    for (uint32_t page = firstPage; page <= lastPage; page++) {
+        if (codePages[page]) {
+            codePages[page] = false;
+            codePageGenerations[page]++;
+        }
+    }
+}
+
 void RAM::dump() {
     filesystem::path ramBinFilePath = filesystem::current_path() / "ram.bin";
     std::ofstream(ramBinFilePath, std::ios::binary).write(reinterpret_cast<char *>(data), RAM_SIZE);
@@ -0,0 +1,697 @@
+#include "Recompiler.hpp"
+#include "Interconnect.tcc"
+#include <cstring>
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+using namespace std;
+
+// Host registers as encoded in the ModRM byte
+const uint8_t EAX = 0;
+const uint8_t ECX = 1;
+const uint8_t EDX = 2;
+const uint8_t ESI = 6;
+const uint8_t EDI = 7;
+const uint8_t R8 = 8;
+
+#if defined(_WIN32)
+const uint8_t argumentRegisters[3] = { ECX, EDX, R8 };
+#else
+const uint8_t argumentRegisters[3] = { EDI, ESI, EDX };
+#endif
+
+Recompiler::Recompiler(LogLevel logLevel, CPU *cpu) : logger(logLevel, "  RECOMPILER: "), cpu(cpu), codeCache(nullptr), codeCacheUsed(0), full(false), code(), exitJumps(), fastmem(nullptr) {
+    if (!RUBY_RECOMPILER_SUPPORTED) {
+        return;
+    }
+#if defined(_WIN32)
+    void *memory = VirtualAlloc(nullptr, RECOMPILER_CODE_CACHE_SIZE, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+    if (memory == nullptr) {
+        logger.logWarning("Unable to allocate executable memory");
+        return;
+    }
+#else
+    void *memory = mmap(nullptr, RECOMPILER_CODE_CACHE_SIZE, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        logger.logWarning("Unable to allocate executable memory");
+        return;
+    }
+#endif
+    codeCache = static_cast<uint8_t *>(memory);
+}
+
+Recompiler::~Recompiler() {
+    if (codeCache == nullptr) {
+        return;
+    }
+#if defined(_WIN32)
+    VirtualFree(codeCache, 0, MEM_RELEASE);
+#else
+    munmap(codeCache, RECOMPILER_CODE_CACHE_SIZE);
+#endif
+}
+
+bool Recompiler::isSupported() {
+    return RUBY_RECOMPILER_SUPPORTED;
+}
+
+bool Recompiler::isFull() {
+    return full;
+}
+
+void Recompiler::flush() {
+    codeCacheUsed = 0;
+    full = false;
+}
+
+size_t Recompiler::codeCacheUsage() {
+    return codeCacheUsed;
+}
+
+bool Recompiler::canEmitNatively(Instruction instruction) {
+    switch (instruction.funct) {
+        case 0b000000: {
+            switch (instruction.subfunct) {
+                case 0b000000: // SLL
+                case 0b000010: // SRL
+                case 0b000011: // SRA
+                case 0b000100: // SLLV
+                case 0b000110: // SRLV
+                case 0b000111: // SRAV
+                case 0b100001: // ADDU
+                case 0b100011: // SUBU
+                case 0b100100: // AND
+                case 0b100101: // OR
+                case 0b100110: // XOR
+                case 0b100111: // NOR
+                case 0b101010: // SLT
+                case 0b101011: { // SLTU
+                    return true;
+                }
+                default: {
+                    return false;
+                }
+            }
+        }
+        case 0b001001: // ADDIU
+        case 0b001010: // SLTI
+        case 0b001011: // SLTIU
+        case 0b001100: // ANDI
+        case 0b001101: // ORI
+        case 0b001110: // XORI
+        case 0b001111: { // LUI
+            return true;
+        }
+        default: {
+            return false;
+        }
+    }
+}
+
+bool Recompiler::isMemoryAccess(Instruction instruction) {
+    switch (instruction.funct) {
+        case 0b100000: // LB
+        case 0b100001: // LH
+        case 0b100011: // LW
+        case 0b100100: // LBU
+        case 0b100101: // LHU
+        case 0b101000: // SB
+        case 0b101001: // SH
+        case 0b101011: { // SW
+            return true;
+        }
+        default: {
+            return false;
+        }
+    }
+}
+
+RecompiledCode Recompiler::compile(const BasicBlock &basicBlock, uint32_t address) {
+    if (codeCache == nullptr || full) {
+        return nullptr;
+    }
+    const vector<CachedInstruction> &instructions = basicBlock.instructions;
+    uint32_t instructionCount = instructions.size();
+    bool endsWithDelaySlot = instructionCount >= 2 && instructions[instructionCount - 2].instruction.isBranchOrJump();
+    if (endsWithDelaySlot && instructions[instructionCount - 1].instruction.isBranchOrJump()) {
+        // Branches in delay slots are left to the interpreter
+        return nullptr;
+    }
+
+    code.clear();
+    exitJumps.clear();
+    fastmem = cpu->lockstep ? nullptr : cpu->interconnect->getFastmem();
+    emitPrologue();
+    // At the start of a block the previous one may have left a load pending
+    bool isLoadSlotPending = true;
+    array<optional<uint32_t>, 32> constantRegisters = {};
+    constantRegisters[0] = 0;
+    // A block never crosses a page, so all its instructions take as long to fetch
+    uint32_t instructionCycles = 1 + cpu->interconnect->fetchCycles(address);
+    for (uint32_t i = 0; i < instructionCount; i++) {
+        const CachedInstruction &cachedInstruction = instructions[i];
+        Instruction instruction = cachedInstruction.instruction;
+        bool isNativeMemoryAccess = isFastmemAccess(instruction, constantRegisters);
+        uint32_t accessCycles = isNativeMemoryAccess ? loadCycles(instruction, constantRegisters) : 0;
+        trackConstantRegisters(instruction, constantRegisters);
+        if (isNativeMemoryAccess) {
+            emitMemoryAccess(cachedInstruction, address + i * 4, i + 1, isLoadSlotPending, accessCycles);
+            // Only a load leaves its value in a slot after moving them
+            isLoadSlotPending = instruction.funct < 0b101000 && instruction.rt != 0;
+            continue;
+        }
+        if (!canEmitNatively(instruction)) {
+            // mov dword [rbx + disp32], imm32
+            emitByte(0xc7); emitByte(0x83);
+            emitWord(displacement(&cpu->blockElapsedCycles));
+            emitWord(i * instructionCycles);
+            emitCall(reinterpret_cast<const void *>(&Recompiler::executeInstruction), reinterpret_cast<uint64_t>(&cachedInstruction), address + i * 4);
+            emitExitIfTrue(i + 1);
+            isLoadSlotPending = true;
+            continue;
+        }
+        uint32_t destination = instruction.funct == 0b000000 ? instruction.rd : instruction.rt;
+        if (destination != 0) {
+            emitInstruction(instruction);
+            emitStoreRegister(destination);
+            if (isLoadSlotPending) {
+                emitInvalidateLoadSlot(destination);
+            }
+        }
+        if (isLoadSlotPending) {
+            emitMoveLoadDelaySlots();
+        }
+        isLoadSlotPending = false;
+    }
+    emitCall(reinterpret_cast<const void *>(&Recompiler::finishBlock), address + instructionCount * 4, endsWithDelaySlot);
+    // mov eax, imm32
+    emitByte(0xb8);
+    emitWord(instructionCount);
+    for (size_t jumpOffset : exitJumps) {
+        patchJump(jumpOffset);
+    }
+    emitEpilogue();
+
+    if (codeCacheUsed + code.size() > RECOMPILER_CODE_CACHE_SIZE) {
+        full = true;
+        return nullptr;
+    }
+    uint8_t *destination = codeCache + codeCacheUsed;
+    memcpy(destination, code.data(), code.size());
+    // Keep every block 16 bytes aligned
+    codeCacheUsed += (code.size() + 15) & ~15;
+    return reinterpret_cast<RecompiledCode>(destination);
+}
+
+void Recompiler::emitByte(uint8_t value) {
+    code.push_back(value);
+}
+
+void Recompiler::emitWord(uint32_t value) {
+    for (uint8_t i = 0; i < 4; i++) {
+        code.push_back(value >> (i * 8));
+    }
+}
+
+void Recompiler::emitQuad(uint64_t value) {
+    for (uint8_t i = 0; i < 8; i++) {
+        code.push_back(value >> (i * 8));
+    }
+}
+
+void Recompiler::emitPrologue() {
+    // push rbx
+    emitByte(0x53);
+    // sub rsp, 32 (keeps the stack aligned and doubles as shadow space on Windows)
+    emitByte(0x48); emitByte(0x83); emitByte(0xec); emitByte(0x20);
+    // mov rbx, imm64 (guest registers)
+    emitByte(0x48); emitByte(0xbb);
+    emitQuad(reinterpret_cast<uint64_t>(cpu->registers));
+}
+
+void Recompiler::emitEpilogue() {
+    // add rsp, 32
+    emitByte(0x48); emitByte(0x83); emitByte(0xc4); emitByte(0x20);
+    // pop rbx
+    emitByte(0x5b);
+    // ret
+    emitByte(0xc3);
+}
+
+void Recompiler::emitCall(const void *function, uint64_t firstArgument, uint64_t secondArgument) {
+    uint64_t arguments[3] = { reinterpret_cast<uint64_t>(cpu), firstArgument, secondArgument };
+    for (uint8_t i = 0; i < 3; i++) {
+        // mov r64, imm64
+        uint8_t hostRegister = argumentRegisters[i];
+        emitByte(hostRegister >= R8 ? 0x49 : 0x48);
+        emitByte(0xb8 + (hostRegister & 7));
+        emitQuad(arguments[i]);
+    }
+    // mov rax, imm64
+    emitByte(0x48); emitByte(0xb8);
+    emitQuad(reinterpret_cast<uint64_t>(function));
+    // call rax
+    emitByte(0xff); emitByte(0xd0);
+}
+
+void Recompiler::emitExitIfTrue(uint32_t executedInstructions) {
+    // test al, al
+    emitByte(0x84); emitByte(0xc0);
+    // jz +10
+    emitByte(0x74); emitByte(0x0a);
+    // mov eax, imm32
+    emitByte(0xb8);
+    emitWord(executedInstructions);
+    // jmp rel32 (patched to the epilogue)
+    emitByte(0xe9);
+    exitJumps.push_back(code.size());
+    emitWord(0);
+}
+
+// Points a rel32 jump emitted earlier to the current end of the code
+void Recompiler::patchJump(size_t jumpOffset) {
+    int32_t relativeOffset = code.size() - (jumpOffset + 4);
+    memcpy(&code[jumpOffset], &relativeOffset, sizeof(relativeOffset));
+}
+
+int32_t Recompiler::displacement(const void *address) const {
+    return reinterpret_cast<intptr_t>(address) - reinterpret_cast<intptr_t>(cpu->registers);
+}
+
+void Recompiler::emitLoadRegister(uint8_t hostRegister, uint32_t guestRegister) {
+    // mov r32, [rbx + disp32]
+    emitByte(0x8b);
+    emitByte(0x83 | (hostRegister << 3));
+    emitWord(displacement(&cpu->registers[guestRegister]));
+}
+
+void Recompiler::emitRegisterOperation(uint8_t opcode, uint32_t guestRegister) {
+    // op eax, [rbx + disp32]
+    emitByte(opcode);
+    emitByte(0x83);
+    emitWord(displacement(&cpu->registers[guestRegister]));
+}
+
+void Recompiler::emitStoreRegister(uint32_t guestRegister) {
+    // mov [rbx + disp32], eax
+    emitByte(0x89);
+    emitByte(0x83);
+    emitWord(displacement(&cpu->registers[guestRegister]));
+}
+
+void Recompiler::emitInvalidateLoadSlot(uint32_t guestRegister) {
+    int32_t loadSlotDisplacement = displacement(&cpu->loadSlots[0].registerIndex);
+    // cmp dword [rbx + disp32], imm32
+    emitByte(0x81); emitByte(0xbb);
+    emitWord(loadSlotDisplacement);
+    emitWord(guestRegister);
+    // jne +10
+    emitByte(0x75); emitByte(0x0a);
+    // mov dword [rbx + disp32], 0
+    emitByte(0xc7); emitByte(0x83);
+    emitWord(loadSlotDisplacement);
+    emitWord(0);
+}
+
+// Same as CPU::moveLoadDelaySlots
+void Recompiler::emitMoveLoadDelaySlots() {
+    const LoadSlot *loadSlots = cpu->loadSlots.data();
+    // mov ecx, [rbx + disp32] (first slot register)
+    emitByte(0x8b); emitByte(0x8b);
+    emitWord(displacement(&loadSlots[0].registerIndex));
+    // test ecx, ecx
+    emitByte(0x85); emitByte(0xc9);
+    // jz +20
+    emitByte(0x74); emitByte(0x14);
+    // mov eax, [rbx + rcx * 4]
+    emitByte(0x8b); emitByte(0x04); emitByte(0x8b);
+    // cmp eax, [rbx + disp32] (first slot previous value)
+    emitByte(0x3b); emitByte(0x83);
+    emitWord(displacement(&loadSlots[0].previousValue));
+    // jne +9
+    emitByte(0x75); emitByte(0x09);
+    // mov eax, [rbx + disp32] (first slot value)
+    emitByte(0x8b); emitByte(0x83);
+    emitWord(displacement(&loadSlots[0].value));
+    // mov [rbx + rcx * 4], eax
+    emitByte(0x89); emitByte(0x04); emitByte(0x8b);
+    // mov rax, [rbx + disp32] (second slot register and value)
+    emitByte(0x48); emitByte(0x8b); emitByte(0x83);
+    emitWord(displacement(&loadSlots[1].registerIndex));
+    // mov [rbx + disp32], rax
+    emitByte(0x48); emitByte(0x89); emitByte(0x83);
+    emitWord(displacement(&loadSlots[0].registerIndex));
+    // mov eax, [rbx + disp32] (second slot previous value)
+    emitByte(0x8b); emitByte(0x83);
+    emitWord(displacement(&loadSlots[1].previousValue));
+    // mov [rbx + disp32], eax
+    emitByte(0x89); emitByte(0x83);
+    emitWord(displacement(&loadSlots[0].previousValue));
+    // mov dword [rbx + disp32], 0
+    emitByte(0xc7); emitByte(0x83);
+    emitWord(displacement(&loadSlots[1].registerIndex));
+    emitWord(0);
+}
+
+bool Recompiler::isFastmemAccess(Instruction instruction, const array<optional<uint32_t>, 32> &constantRegisters) const {
+    if (fastmem == nullptr || !isMemoryAccess(instruction)) {
+        return false;
+    }
+    optional<uint32_t> base = constantRegisters[instruction.rs];
+    return !base || fastmem->isMapped(*base + instruction.immSE());
+}
+
+// Wait states of a native load, exact when the address is known and otherwise assuming
+// RAM, where nearly all of them land
+uint32_t Recompiler::loadCycles(Instruction instruction, const array<optional<uint32_t>, 32> &constantRegisters) const {
+    if (instruction.funct >= 0b101000) {
+        return 0;
+    }
+    optional<uint32_t> base = constantRegisters[instruction.rs];
+    // Byte, half word and word accesses are 0, 1 and 3 in the low bits of the opcode
+    switch (instruction.funct & 3) {
+        case 0: {
+            return base ? cpu->interconnect->loadCycles<uint8_t>(*base + instruction.immSE()) : regionAccessCycles[RAMRegion].byte;
+        }
+        case 1: {
+            return base ? cpu->interconnect->loadCycles<uint16_t>(*base + instruction.immSE()) : regionAccessCycles[RAMRegion].halfWord;
+        }
+        default: {
+            return base ? cpu->interconnect->loadCycles<uint32_t>(*base + instruction.immSE()) : regionAccessCycles[RAMRegion].word;
+        }
+    }
+}
+
+// Follows registers whose value is known when translating, as set by LUI and then
+// ORI or ADDIU, which is how guest code builds the addresses of I/O ports
+void Recompiler::trackConstantRegisters(Instruction instruction, array<optional<uint32_t>, 32> &constantRegisters) const {
+    uint32_t rs = instruction.rs;
+    uint32_t rt = instruction.rt;
+    switch (instruction.funct) {
+        case 0b001111: {
+            if (rt != 0) {
+                constantRegisters[rt] = instruction.imm() << 16;
+            }
+            return;
+        }
+        case 0b001001:
+        case 0b001101: {
+            if (rt == 0) {
+                return;
+            }
+            if (!constantRegisters[rs]) {
+                constantRegisters[rt] = nullopt;
+                return;
+            }
+            uint32_t value = *constantRegisters[rs];
+            constantRegisters[rt] = instruction.funct == 0b001001 ? value + instruction.immSE() : value | instruction.imm();
+            return;
+        }
+        case 0b101000:
+        case 0b101001:
+        case 0b101011: {
+            return;
+        }
+    }
+    if (isMemoryAccess(instruction)) {
+        if (rt != 0) {
+            constantRegisters[rt] = nullopt;
+        }
+        return;
+    }
+    if (canEmitNatively(instruction)) {
+        uint32_t destination = instruction.funct == 0b000000 ? instruction.rd : rt;
+        if (destination != 0) {
+            constantRegisters[destination] = nullopt;
+        }
+        return;
+    }
+    // Anything else may write any register
+    constantRegisters.fill(nullopt);
+    constantRegisters[0] = 0;
+}
+
+// Loads and stores straight on the fastmem region, in the forms Fastmem decodes when they
+// fault. Misaligned addresses are left to the interpreter, which raises the exception
+void Recompiler::emitMemoryAccess(const CachedInstruction &cachedInstruction, uint32_t programCounter, uint32_t executedInstructions, bool isLoadSlotPending, uint32_t accessCycles) {
+    Instruction instruction = cachedInstruction.instruction;
+    uint32_t rt = instruction.rt;
+    bool isLoad = instruction.funct < 0b101000;
+    // Byte, half word and word accesses are 0, 1 and 3 in the low bits of the opcode
+    uint8_t alignmentMask = instruction.funct & 3;
+    emitLoadRegister(ECX, instruction.rs);
+    // add ecx, imm32
+    emitByte(0x81); emitByte(0xc1);
+    emitWord(instruction.immSE());
+    size_t alignedJump = 0;
+    size_t doneJump = 0;
+    if (alignmentMask != 0) {
+        // test cl, imm8
+        emitByte(0xf6); emitByte(0xc1);
+        emitByte(alignmentMask);
+        // jz rel32 (patched to the access)
+        emitByte(0x0f); emitByte(0x84);
+        alignedJump = code.size();
+        emitWord(0);
+        emitCall(reinterpret_cast<const void *>(&Recompiler::executeInstruction), reinterpret_cast<uint64_t>(&cachedInstruction), programCounter);
+        emitExitIfTrue(executedInstructions);
+        // jmp rel32 (patched past the access)
+        emitByte(0xe9);
+        doneJump = code.size();
+        emitWord(0);
+        patchJump(alignedJump);
+    }
+    if (!isLoad) {
+        emitLoadRegister(EAX, rt);
+    }
+    // mov rdx, imm64 (fastmem base)
+    emitByte(0x48); emitByte(0xba);
+    emitQuad(reinterpret_cast<uint64_t>(fastmem->getBase()));
+    switch (instruction.funct) {
+        case 0b100000: {
+            // movsx eax, byte [rdx + rcx]
+            emitByte(0x0f); emitByte(0xbe); emitByte(0x04); emitByte(0x0a);
+            break;
+        }
+        case 0b100001: {
+            // movsx eax, word [rdx + rcx]
+            emitByte(0x0f); emitByte(0xbf); emitByte(0x04); emitByte(0x0a);
+            break;
+        }
+        case 0b100011: {
+            // mov eax, [rdx + rcx]
+            emitByte(0x8b); emitByte(0x04); emitByte(0x0a);
+            break;
+        }
+        case 0b100100: {
+            // movzx eax, byte [rdx + rcx]
+            emitByte(0x0f); emitByte(0xb6); emitByte(0x04); emitByte(0x0a);
+            break;
+        }
+        case 0b100101: {
+            // movzx eax, word [rdx + rcx]
+            emitByte(0x0f); emitByte(0xb7); emitByte(0x04); emitByte(0x0a);
+            break;
+        }
+        case 0b101000: {
+            // mov [rdx + rcx], al
+            emitByte(0x88); emitByte(0x04); emitByte(0x0a);
+            break;
+        }
+        case 0b101001: {
+            // mov [rdx + rcx], ax
+            emitByte(0x66); emitByte(0x89); emitByte(0x04); emitByte(0x0a);
+            break;
+        }
+        case 0b101011: {
+            // mov [rdx + rcx], eax
+            emitByte(0x89); emitByte(0x04); emitByte(0x0a);
+            break;
+        }
+    }
+    if (accessCycles > 0) {
+        // add dword [rbx + disp32], imm32
+        emitByte(0x81); emitByte(0x83);
+        emitWord(displacement(&cpu->stallCycles));
+        emitWord(accessCycles);
+    }
+    bool fillsLoadSlot = isLoad && rt != 0;
+    if (fillsLoadSlot) {
+        // Same as CPU::loadDelaySlot
+        if (isLoadSlotPending) {
+            emitInvalidateLoadSlot(rt);
+        }
+        // mov dword [rbx + disp32], imm32
+        emitByte(0xc7); emitByte(0x83);
+        emitWord(displacement(&cpu->loadSlots[1].registerIndex));
+        emitWord(rt);
+        // mov [rbx + disp32], eax
+        emitByte(0x89); emitByte(0x83);
+        emitWord(displacement(&cpu->loadSlots[1].value));
+        emitLoadRegister(EAX, rt);
+        // mov [rbx + disp32], eax
+        emitByte(0x89); emitByte(0x83);
+        emitWord(displacement(&cpu->loadSlots[1].previousValue));
+    }
+    if (isLoadSlotPending || fillsLoadSlot) {
+        emitMoveLoadDelaySlots();
+    }
+    if (alignmentMask != 0) {
+        patchJump(doneJump);
+    }
+}
+
+// Leaves the result of the instruction in eax
+void Recompiler::emitInstruction(Instruction instruction) {
+    uint32_t rs = instruction.rs;
+    uint32_t rt = instruction.rt;
+    switch (instruction.funct) {
+        case 0b000000: {
+            switch (instruction.subfunct) {
+                case 0b000000:
+                case 0b000010:
+                case 0b000011: {
+                    const uint8_t shiftOperation[4] = { 0xe0, 0x00, 0xe8, 0xf8 };
+                    emitLoadRegister(EAX, rt);
+                    // shl/shr/sar eax, imm8
+                    emitByte(0xc1); emitByte(shiftOperation[instruction.subfunct]);
+                    emitByte(instruction.shiftimm);
+                    break;
+                }
+                case 0b000100:
+                case 0b000110:
+                case 0b000111: {
+                    const uint8_t shiftOperation[4] = { 0xe0, 0x00, 0xe8, 0xf8 };
+                    emitLoadRegister(ECX, rs);
+                    emitLoadRegister(EAX, rt);
+                    // shl/shr/sar eax, cl (the host also masks the amount to 5 bits)
+                    emitByte(0xd3); emitByte(shiftOperation[instruction.subfunct & 3]);
+                    break;
+                }
+                case 0b100001: {
+                    emitLoadRegister(EAX, rs);
+                    // add eax, [rt]
+                    emitRegisterOperation(0x03, rt);
+                    break;
+                }
+                case 0b100011: {
+                    emitLoadRegister(EAX, rs);
+                    // sub eax, [rt]
+                    emitRegisterOperation(0x2b, rt);
+                    break;
+                }
+                case 0b100100: {
+                    emitLoadRegister(EAX, rs);
+                    // and eax, [rt]
+                    emitRegisterOperation(0x23, rt);
+                    break;
+                }
+                case 0b100101: {
+                    emitLoadRegister(EAX, rs);
+                    // or eax, [rt]
+                    emitRegisterOperation(0x0b, rt);
+                    break;
+                }
+                case 0b100110: {
+                    emitLoadRegister(EAX, rs);
+                    // xor eax, [rt]
+                    emitRegisterOperation(0x33, rt);
+                    break;
+                }
+                case 0b100111: {
+                    emitLoadRegister(EAX, rs);
+                    // or eax, [rt]
+                    emitRegisterOperation(0x0b, rt);
+                    // not eax
+                    emitByte(0xf7); emitByte(0xd0);
+                    break;
+                }
+                case 0b101010:
+                case 0b101011: {
+                    emitLoadRegister(EAX, rs);
+                    // cmp eax, [rt]
+                    emitRegisterOperation(0x3b, rt);
+                    // setl al / setb al
+                    emitByte(0x0f); emitByte(instruction.subfunct == 0b101010 ? 0x9c : 0x92); emitByte(0xc0);
+                    // movzx eax, al
+                    emitByte(0x0f); emitByte(0xb6); emitByte(0xc0);
+                    break;
+                }
+            }
+            break;
+        }
+        case 0b001001: {
+            emitLoadRegister(EAX, rs);
+            // add eax, imm32
+            emitByte(0x05);
+            emitWord(instruction.immSE());
+            break;
+        }
+        case 0b001010:
+        case 0b001011: {
+            emitLoadRegister(EAX, rs);
+            // cmp eax, imm32
+            emitByte(0x3d);
+            emitWord(instruction.immSE());
+            // setl al / setb al
+            emitByte(0x0f); emitByte(instruction.funct == 0b001010 ? 0x9c : 0x92); emitByte(0xc0);
+            // movzx eax, al
+            emitByte(0x0f); emitByte(0xb6); emitByte(0xc0);
+            break;
+        }
+        case 0b001100: {
+            emitLoadRegister(EAX, rs);
+            // and eax, imm32
+            emitByte(0x25);
+            emitWord(instruction.imm());
+            break;
+        }
+        case 0b001101: {
+            emitLoadRegister(EAX, rs);
+            // or eax, imm32
+            emitByte(0x0d);
+            emitWord(instruction.imm());
+            break;
+        }
+        case 0b001110: {
+            emitLoadRegister(EAX, rs);
+            // xor eax, imm32
+            emitByte(0x35);
+            emitWord(instruction.imm());
+            break;
+        }
+        case 0b001111: {
+            // mov eax, imm32
+            emitByte(0xb8);
+            emitWord(instruction.imm() << 16);
+            break;
+        }
+    }
+}
+
+// Runs an instruction the recompiler doesn't emit natively, returns true
+// when it raised an exception and the block has to be left
+bool Recompiler::executeInstruction(CPU *cpu, const CachedInstruction *cachedInstruction, uint32_t programCounter) {
+    cpu->programCounter = programCounter;
+    cpu->currentInstruction = cachedInstruction->instruction;
+    (cpu->*cachedInstruction->handler)(cachedInstruction->instruction);
+    cpu->moveLoadDelaySlots();
+    if (cpu->runningException) {
+        cpu->runningException = false;
+        return true;
+    }
+    return false;
+}
+
+void Recompiler::finishBlock(CPU *cpu, uint32_t nextProgramCounter, bool endsWithDelaySlot) {
+    if (endsWithDelaySlot && cpu->isBranching) {
+        cpu->programCounter = cpu->jumpDestination & 0xfffffffc;
+        cpu->jumpDestination = 0;
+        cpu->isBranching = false;
+        return;
+    }
+    cpu->programCounter = nextProgramCounter;
+}
@@ -10,22 +10,16 @@
 
 using namespace std;
 
-Renderer::Renderer(std::unique_ptr<Window> &mainWindow) : logger(LogLevel::NoLog), mode(GL_TRIANGLES) {
+const uint16_t TRIANGLE_INDICES[] = { 0, 1, 2 };
+const uint16_t QUAD_INDICES[] = { 0, 1, 2, 1, 2, 3 };
+const uint16_t LINE_INDICES[] = { 0, 1 };
+
+Renderer::Renderer(std::unique_ptr<Window> &mainWindow) : logger(LogLevel::NoLog), mainWindow(mainWindow), drawingOffset(), batches(), drawingFrame(0), readyFrame(1), presentedFrame(2), hasReadyFrame(false), frameStatistics(), finishedFrameStatistics() {
     ConfigurationManager *configurationManager = ConfigurationManager::getInstance();
     resizeToFitFramebuffer = configurationManager->shouldResizeWindowToFitFramebuffer();
 
-    textureRendererProgram = make_unique<RendererProgram>("./glsl/texture_load_vertex.glsl", "./glsl/texture_load_fragment.glsl");
-
-    textureBuffer = make_unique<RendererBuffer<Point>>(textureRendererProgram, RENDERER_BUFFER_SIZE);
-
-    program = make_unique<RendererProgram>("glsl/vertex.glsl", "glsl/fragment.glsl");
-    program->useProgram();
-
-    buffer = make_unique<RendererBuffer<Vertex>>(program, RENDERER_BUFFER_SIZE);
-
-    offsetUniform = program->findProgramAttribute("offset");
-    glUniform2i(offsetUniform, 0, 0);
-
+    // Vertex array objects aren't shared between contexts, the one that presents
+    // is created on the main window context
     // TODO: Use a single vertex shader
     string screenVertexFile = "./glsl/screen_vertex.glsl";
     if (resizeToFitFramebuffer) {
@@ -35,61 +29,141 @@ Renderer::Renderer(std::unique_ptr<Window> &mainWindow) : logger(LogLevel::NoLog
 
     screenBuffer = make_unique<RendererBuffer<Pixel>>(screenRendererProgram, RENDERER_BUFFER_SIZE);
 
+    renderingContext = mainWindow->createSharedContext();
+
+    textureRendererProgram = make_unique<RendererProgram>("./glsl/texture_load_vertex.glsl", "./glsl/texture_load_fragment.glsl");
+
+    textureBuffer = make_unique<RendererBuffer<Point>>(textureRendererProgram, RENDERER_BUFFER_SIZE);
+
+    program = make_unique<RendererProgram>("glsl/vertex.glsl", "glsl/fragment.glsl");
+    program->useProgram();
+
+    // Quads take the most indices, six for four vertices
+    buffer = make_unique<RendererBuffer<Vertex>>(program, RENDERER_BUFFER_SIZE, RENDERER_BUFFER_SIZE * 3 / 2);
+    // Every primitive takes at least two vertices, the runs of a full buffer never outgrow this
+    batches.reserve(RENDERER_BUFFER_SIZE / 2);
+
     // TODO: handle resolution for other targets
     loadImageTexture = make_unique<Texture>(((GLsizei) VRAM_WIDTH), ((GLsizei) VRAM_HEIGHT));
 
     Dimensions screenDimensions = mainWindow->getDimensions();
     screenTexture = make_unique<Texture>(((GLsizei) screenDimensions.width), ((GLsizei) screenDimensions.height));
+    for (RendererFrame &frame : frames) {
+        frame.texture = make_unique<Texture>(((GLsizei) screenDimensions.width), ((GLsizei) screenDimensions.height));
+    }
     RendererDebugger *rendererDebugger = RendererDebugger::getInstance();
     rendererDebugger->checkForOpenGLErrors();
+    // Nothing draws until a thread attaches
+    mainWindow->makeCurrent();
 }
 
 Renderer::~Renderer() {
+    mainWindow->makeCurrent();
+    screenBuffer.reset();
+    SDL_GL_MakeCurrent(mainWindow->getWindowRef(), renderingContext);
+    for (RendererFrame &frame : frames) {
+        if (frame.fence != nullptr) {
+            glDeleteSync(frame.fence);
+        }
+        frame.texture.reset();
+    }
+    buffer.reset();
+    program.reset();
+    textureBuffer.reset();
+    textureRendererProgram.reset();
+    loadImageTexture.reset();
+    screenTexture.reset();
+    screenRendererProgram.reset();
+    mainWindow->makeCurrent();
+    SDL_GL_DeleteContext(renderingContext);
     SDL_Quit();
 }
 
-void Renderer::checkForceDraw(unsigned int verticesToRender, GLenum newMode) {
-    unsigned int verticesToRenderTotal = verticesToRender;
-    if (verticesToRender == 4) {
-        verticesToRenderTotal = 6;
+void Renderer::checkForceDraw(unsigned int verticesToRender) {
+    if (buffer->remainingCapacity() < verticesToRender) {
+        flush(FlushBufferFull);
     }
-    if (buffer->remainingCapacity() < verticesToRenderTotal) {
-        renderFrame();
+    return;
+}
+
+// The offset is applied on a copy, mapped memory is only ever written
+void Renderer::addVertices(const Vertex *vertices, unsigned int count, const uint16_t *indices, unsigned int indexCount, GLenum mode) {
+    Vertex translatedVertices[GPU_POLYGON_MAXIMUM_VERTICES];
+    for (unsigned int i = 0; i < count; i++) {
+        translatedVertices[i] = vertices[i];
+        translatedVertices[i].point.x += drawingOffset.x;
+        translatedVertices[i].point.y += drawingOffset.y;
     }
-    if (mode != newMode) {
-        renderFrame();
+    buffer->addData(translatedVertices, count, indices, indexCount);
+    if (!batches.empty() && batches.back().mode == mode) {
+        batches.back().count += indexCount;
+    } else {
+        batches.push_back({ mode, indexCount });
     }
-    return;
 }
 
-void Renderer::pushLine(std::vector<Vertex> vertices) {
-    unsigned int size = vertices.size();
-    if (size < 2) {
-        logger.logError("Unhandled line with %d vertices", size);
+// Draws every pending run in the order they were pushed
+void Renderer::flush(RendererFlushReason reason) {
+    if (batches.empty()) {
+        return;
+    }
+    {
+        Framebuffer framebuffer = Framebuffer(screenTexture);
+        for (const RendererBatch &batch : batches) {
+            buffer->draw(batch.mode, batch.count);
+        }
+        RendererDebugger *rendererDebugger = RendererDebugger::getInstance();
+        rendererDebugger->checkForOpenGLErrors();
+    }
+    frameStatistics.drawCalls += batches.size();
+    frameStatistics.flushes++;
+    switch (reason) {
+        case FlushBufferFull: {
+            frameStatistics.bufferFullFlushes++;
+            break;
+        }
+        case FlushFrameEnd: {
+            frameStatistics.frameEndFlushes++;
+            break;
+        }
+        case FlushVRAMRead: {
+            frameStatistics.vramReadFlushes++;
+            break;
+        }
+        case FlushImageLoad: {
+            frameStatistics.imageLoadFlushes++;
+            break;
+        }
+    }
+    batches.clear();
+}
+
+// Vertices are taken in pairs, one line each
+void Renderer::pushLine(const Vertex *vertices, unsigned int count) {
+    if (count < 2) {
+        logger.logError("Unhandled line with %d vertices", count);
         return;
     }
-    checkForceDraw(size, GL_LINES);
-    mode = GL_LINES;
-    buffer->addData(vertices);
+    for (unsigned int i = 0; i + 1 < count; i += 2) {
+        checkForceDraw(2);
+        addVertices(vertices + i, 2, LINE_INDICES, 2, GL_LINES);
+    }
     return;
 }
 
-void Renderer::pushPolygon(std::vector<Vertex> vertices) {
-    unsigned int size = vertices.size();
-    if (size < 3 || size > 4) {
-        logger.logError("Unhandled polygon with %d vertices", size);
+void Renderer::pushPolygon(const Vertex *vertices, unsigned int count) {
+    if (count < 3 || count > 4) {
+        logger.logError("Unhandled polygon with %d vertices", count);
         return;
     }
-    checkForceDraw(size, GL_TRIANGLES);
-    mode = GL_TRIANGLES;
-    switch (size) {
+    checkForceDraw(count);
+    switch (count) {
         case 3: {
-            buffer->addData(vertices);
+            addVertices(vertices, 3, TRIANGLE_INDICES, 3, GL_TRIANGLES);
             break;
         }
         case 4: {
-            buffer->addData(vector<Vertex>(vertices.begin(), vertices.end() - 1));
-            buffer->addData(vector<Vertex>(vertices.begin() + 1, vertices.end()));
+            addVertices(vertices, 4, QUAD_INDICES, 6, GL_TRIANGLES);
             break;
         }
     }
@@ -101,15 +175,43 @@ void Renderer::prepareFrame() {
 }
 
 void Renderer::renderFrame() {
-    Framebuffer framebuffer = Framebuffer(screenTexture);
-    buffer->draw(mode);
+    flush(FlushFrameEnd);
+}
+
+void Renderer::finalizeFrame(GPU *gpu) {
+    flush(FlushFrameEnd);
+    RendererFrame &frame = frames[drawingFrame];
+    waitForFrame(frame);
+    glCopyImageSubData(screenTexture->getID(), GL_TEXTURE_2D, 0, 0, 0, 0, frame.texture->getID(), GL_TEXTURE_2D, 0, 0, 0, 0, screenTexture->getWidth(), screenTexture->getHeight(), 1);
+    frame.displayAreaStart = gpu->getDisplayAreaStart();
+    frame.resolution = gpu->getResolution();
+    frame.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    // The fence has to reach the GPU before the other context waits on it
+    glFlush();
     RendererDebugger *rendererDebugger = RendererDebugger::getInstance();
     rendererDebugger->checkForOpenGLErrors();
+    lock_guard<mutex> lock(framesMutex);
+    // An older frame that was never presented gets drawn over
+    swap(drawingFrame, readyFrame);
+    hasReadyFrame = true;
+    finishedFrameStatistics = frameStatistics;
+    frameStatistics = RendererStatistics();
 }
 
-void Renderer::finalizeFrame(GPU *gpu) {
-    buffer->draw(mode);
-    screenTexture->bind(GL_TEXTURE0);
+bool Renderer::presentFrame() {
+    {
+        lock_guard<mutex> lock(framesMutex);
+        if (!hasReadyFrame) {
+            return false;
+        }
+        swap(presentedFrame, readyFrame);
+        hasReadyFrame = false;
+    }
+    RendererFrame &frame = frames[presentedFrame];
+    waitForFrame(frame);
+    Dimensions windowDimensions = mainWindow->getDimensions();
+    glViewport(0, 0, windowDimensions.width, windowDimensions.height);
+    frame.texture->bind(GL_TEXTURE0);
     vector<Pixel> pixels;
     if (resizeToFitFramebuffer) {
         pixels = {
@@ -119,8 +221,8 @@ void Renderer::finalizeFrame(GPU *gpu) {
             Pixel(1.0f, 1.0f, 1.0f, 0.0f),
         };
     } else {
-        Point displayAreaStart = gpu->getDisplayAreaStart();
-        Dimensions screenResolution = gpu->getResolution();
+        Point displayAreaStart = frame.displayAreaStart;
+        Dimensions screenResolution = frame.resolution;
         pixels = {
             Pixel(-1.0f, -1.0f, displayAreaStart.x, displayAreaStart.y + screenResolution.height),
             Pixel(1.0f, -1.0f, displayAreaStart.x + screenResolution.width, displayAreaStart.y + screenResolution.height),
@@ -128,27 +230,81 @@ void Renderer::finalizeFrame(GPU *gpu) {
             Pixel(1.0f, 1.0f, displayAreaStart.x + screenResolution.width, displayAreaStart.y),
         };
     }
-    screenBuffer->addData(pixels);
+    screenBuffer->addData(pixels.data(), pixels.size());
     screenBuffer->draw(GL_TRIANGLE_STRIP);
+    // The drawing side waits for this before it copies a new picture over the frame
+    frame.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glFlush();
     RendererDebugger *rendererDebugger = RendererDebugger::getInstance();
     rendererDebugger->checkForOpenGLErrors();
+    SDL_GL_SwapWindow(mainWindow->getWindowRef());
+    return true;
+}
+
+// Makes this context wait for the commands that last wrote the frame
+void Renderer::waitForFrame(RendererFrame &frame) {
+    if (frame.fence == nullptr) {
+        return;
+    }
+    glWaitSync(frame.fence, 0, GL_TIMEOUT_IGNORED);
+    glDeleteSync(frame.fence);
+    frame.fence = nullptr;
+}
+
+void Renderer::attachToCurrentThread() {
+    SDL_GL_MakeCurrent(mainWindow->getWindowRef(), renderingContext);
 }
 
+// An OpenGL context can only be current on one thread at a time
+void Renderer::detachFromCurrentThread() {
+    SDL_GL_MakeCurrent(mainWindow->getWindowRef(), nullptr);
+}
+
+// Only applies to vertices pushed from now on, what is already batched keeps its offset
 void Renderer::setDrawingOffset(int16_t x, int16_t y) {
-    buffer->draw(mode);
-    glUniform2i(offsetUniform, ((GLint)x), ((GLint)y));
+    drawingOffset = { x, y };
+}
+
+RendererStatistics Renderer::lastFrameStatistics() {
+    lock_guard<mutex> lock(framesMutex);
+    return finishedFrameStatistics;
 }
 
 void Renderer::loadImage(std::unique_ptr<GPUImageBuffer> &imageBuffer) {
+    // Primitives pushed before the image have to be under it
+    flush(FlushImageLoad);
     loadImageTexture->setImageFromBuffer(imageBuffer);
-    textureBuffer->clean();
     uint16_t x, y, width, height;
     tie(x, y) = imageBuffer->destination();
     tie(width, height) = imageBuffer->resolution();
-    vector<Point> data = { {(GLshort)x, (GLshort)y}, {(GLshort)(x + width), (GLshort)y}, {(GLshort)x, (GLshort)(y + height)}, {(GLshort)(x + width), (GLshort)(y + height)} };
-    textureBuffer->addData(data);
+    vector<Point> data = { {(int16_t)x, (int16_t)y}, {(int16_t)(x + width), (int16_t)y}, {(int16_t)x, (int16_t)(y + height)}, {(int16_t)(x + width), (int16_t)(y + height)} };
+    textureBuffer->addData(data.data(), data.size());
     Framebuffer framebuffer = Framebuffer(screenTexture);
     textureBuffer->draw(GL_TRIANGLE_STRIP);
     RendererDebugger *rendererDebugger = RendererDebugger::getInstance();
     rendererDebugger->checkForOpenGLErrors();
 }
+
+bool Renderer::readVRAM(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t *pixels) {
+    if (x + width > VRAM_WIDTH || y + height > VRAM_HEIGHT) {
+        return false;
+    }
+    flush(FlushVRAMRead);
+    GLsizei textureWidth = screenTexture->getWidth();
+    GLsizei textureHeight = screenTexture->getHeight();
+    vector<uint16_t> texturePixels(textureWidth * textureHeight);
+    Framebuffer framebuffer = Framebuffer(screenTexture);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, textureWidth, textureHeight, GL_RGBA, GL_UNSIGNED_SHORT_1_5_5_5_REV, texturePixels.data());
+    // VRAM is drawn upside down and stretched over the whole texture
+    for (uint32_t row = 0; row < height; row++) {
+        uint32_t textureY = textureHeight - 1 - ((y + row) * textureHeight) / VRAM_HEIGHT;
+        for (uint32_t column = 0; column < width; column++) {
+            uint32_t textureX = ((x + column) * textureWidth) / VRAM_WIDTH;
+            pixels[row * width + column] = texturePixels[textureY * textureWidth + textureX];
+        }
+    }
+    RendererDebugger *rendererDebugger = RendererDebugger::getInstance();
+    rendererDebugger->checkForOpenGLErrors();
+    return true;
+}
@@ -1,24 +1,47 @@
 #include "RendererBuffer.hpp"
 #include <stddef.h>
+#include <algorithm>
 #include "Vertex.hpp"
 #include "RendererDebugger.hpp"
 
 using namespace std;
 
 template <class T>
-RendererBuffer<T>::RendererBuffer(unique_ptr<RendererProgram> &program, unsigned int capacity) : vao(make_unique<VertexArrayObject>()), program(program), capacity(capacity), size(0) {
+RendererBuffer<T>::RendererBuffer(unique_ptr<RendererProgram> &program, unsigned int capacity, unsigned int indexCapacity) : vao(make_unique<VertexArrayObject>()), ibo(0), mappedVertices(nullptr), mappedIndices(nullptr), program(program), capacity(capacity), indexCapacity(indexCapacity), regionFences(), region(0), size(0), drawnSize(0), indexCount(0), drawnIndexCount(0) {
     glGenBuffers(1, &vbo);
 
     vao->bind();
     bind();
 
-    GLsizeiptr bufferSize = sizeof(T) * capacity;
-    glBufferData(GL_ARRAY_BUFFER, bufferSize, nullptr, GL_DYNAMIC_DRAW);
+    GLsizeiptr bufferSize = sizeof(T) * capacity * RENDERER_BUFFER_REGIONS;
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glBufferStorage(GL_ARRAY_BUFFER, bufferSize, nullptr, flags);
+    mappedVertices = (T*)glMapBufferRange(GL_ARRAY_BUFFER, 0, bufferSize, flags);
+    if (isIndexed()) {
+        // The element array binding is part of the vertex array object
+        glGenBuffers(1, &ibo);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+        GLsizeiptr indexBufferSize = sizeof(uint16_t) * indexCapacity * RENDERER_BUFFER_REGIONS;
+        glBufferStorage(GL_ELEMENT_ARRAY_BUFFER, indexBufferSize, nullptr, flags);
+        mappedIndices = (uint16_t*)glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER, 0, indexBufferSize, flags);
+    }
     enableAttributes();
 }
 
 template <class T>
 RendererBuffer<T>::~RendererBuffer() {
+    for (GLsync fence : regionFences) {
+        if (fence != nullptr) {
+            glDeleteSync(fence);
+        }
+    }
+    vao->bind();
+    if (isIndexed()) {
+        glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
+        glDeleteBuffers(1, &ibo);
+    }
+    bind();
+    glUnmapBuffer(GL_ARRAY_BUFFER);
     glDeleteBuffers(1, &vbo);
 }
 
@@ -28,46 +51,94 @@ void RendererBuffer<T>::bind() const {
 }
 
 template <class T>
-void RendererBuffer<T>::clean() {
-    bind();
-    GLsizeiptr bufferSize = sizeof(T) * capacity;
-    glBufferData(GL_ARRAY_BUFFER, bufferSize, nullptr, GL_DYNAMIC_DRAW);
-    size = 0;
+bool RendererBuffer<T>::isIndexed() const {
+    return indexCapacity > 0;
 }
 
 template <class T>
-void RendererBuffer<T>::draw(GLenum mode) {
-    vao->bind();
-    program->useProgram();
-    glMemoryBarrier(GL_CLIENT_MAPPED_BUFFER_BARRIER_BIT);
-    glDrawArrays(mode, 0, (GLsizei)size);
-    GLsync sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+void RendererBuffer<T>::nextRegion() {
+    regionFences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    region = (region + 1) % RENDERER_BUFFER_REGIONS;
+    size = 0;
+    drawnSize = 0;
+    indexCount = 0;
+    drawnIndexCount = 0;
+    GLsync fence = regionFences[region];
+    if (fence == nullptr) {
+        return;
+    }
     while (true) {
-        GLenum result = glClientWaitSync(sync, GL_SYNC_FLUSH_COMMANDS_BIT, 10000000);
+        GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 10000000);
         if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED) {
             break;
         }
     }
-    clean();
+    glDeleteSync(fence);
+    regionFences[region] = nullptr;
+}
+
+template <class T>
+void RendererBuffer<T>::draw(GLenum mode) {
+    unsigned int pending = size - drawnSize;
+    if (isIndexed()) {
+        pending = indexCount - drawnIndexCount;
+    }
+    if (pending == 0) {
+        return;
+    }
+    draw(mode, pending);
     RendererDebugger *rendererDebugger = RendererDebugger::getInstance();
     rendererDebugger->checkForOpenGLErrors();
 }
 
 template <class T>
-void RendererBuffer<T>::addData(vector<T> data) {
-    bind();
+void RendererBuffer<T>::draw(GLenum mode, unsigned int count) {
+    vao->bind();
+    program->useProgram();
+    if (isIndexed()) {
+        uintptr_t offset = (region * indexCapacity + drawnIndexCount) * sizeof(uint16_t);
+        glDrawElementsBaseVertex(mode, (GLsizei)count, GL_UNSIGNED_SHORT, (void*)offset, (GLint)(region * capacity));
+        drawnIndexCount += count;
+        if (drawnIndexCount == indexCount) {
+            drawnSize = size;
+        }
+        return;
+    }
+    glDrawArrays(mode, (GLint)(region * capacity + drawnSize), (GLsizei)count);
+    drawnSize += count;
+}
 
-    unsigned int offset = size * sizeof(T);
-    unsigned int dataSize = data.size() * sizeof(T);
-    glBufferSubData(GL_ARRAY_BUFFER, offset, dataSize, data.data());
+template <class T>
+void RendererBuffer<T>::addData(const T *data, unsigned int count) {
+    if (size + count > capacity) {
+        // Callers draw when remainingCapacity() says so, pending vertices never wrap
+        nextRegion();
+    }
+    copy(data, data + count, mappedVertices + region * capacity + size);
+    size += count;
+}
 
-    size += data.size();
+template <class T>
+void RendererBuffer<T>::addData(const T *data, unsigned int count, const uint16_t *indices, unsigned int indexCount) {
+    if (size + count > capacity || this->indexCount + indexCount > indexCapacity) {
+        nextRegion();
+    }
+    copy(data, data + count, mappedVertices + region * capacity + size);
+    uint16_t *regionIndices = mappedIndices + region * indexCapacity + this->indexCount;
+    for (unsigned int i = 0; i < indexCount; i++) {
+        regionIndices[i] = (uint16_t)(size + indices[i]);
+    }
+    this->indexCount += indexCount;
+    size += count;
 }
 
+// Once everything was drawn the next vertices may go to a fresh region
 template <class T>
 unsigned int RendererBuffer<T>::remainingCapacity() {
-    int remainingCapacity = capacity - size;
-    return remainingCapacity;
+    if (drawnSize == size) {
+        return capacity;
+    }
+    return capacity - size;
 }
 
 template <>
@@ -84,21 +155,9 @@ void RendererBuffer<Vertex>::enableAttributes() const {
     glVertexAttribIPointer(texturePositionIdx, 2, GL_SHORT, sizeof(Vertex), (void*)offsetof(struct Vertex, texturePosition));
     glEnableVertexAttribArray(texturePositionIdx);
 
-    GLuint textureBlendModePositionIdx = program->findProgramAttribute("texture_blend_mode");
-    glVertexAttribIPointer(textureBlendModePositionIdx, 1, GL_UNSIGNED_INT, sizeof(Vertex), (void*)offsetof(struct Vertex, textureBlendMode));
-    glEnableVertexAttribArray(textureBlendModePositionIdx);
-
-    GLuint texturePageIdx = program->findProgramAttribute("texture_page");
-    glVertexAttribIPointer(texturePageIdx, 2, GL_SHORT, sizeof(Vertex), (void*)offsetof(struct Vertex, texturePage));
-    glEnableVertexAttribArray(texturePageIdx);
-
-    GLuint textureDepthShiftIdx = program->findProgramAttribute("texture_depth_shift");
-    glVertexAttribIPointer(textureDepthShiftIdx, 1, GL_UNSIGNED_INT, sizeof(Vertex), (void*)offsetof(struct Vertex, textureDepthShift));
-    glEnableVertexAttribArray(textureDepthShiftIdx);
-
-    GLuint clutIdx = program->findProgramAttribute("clut");
-    glVertexAttribIPointer(clutIdx, 2, GL_SHORT, sizeof(Vertex), (void*)offsetof(struct Vertex, clut));
-    glEnableVertexAttribArray(clutIdx);
+    GLuint attributesIdx = program->findProgramAttribute("vertex_attributes");
+    glVertexAttribIPointer(attributesIdx, 1, GL_UNSIGNED_INT, sizeof(Vertex), (void*)offsetof(struct Vertex, attributes));
+    glEnableVertexAttribArray(attributesIdx);
 }
 
 template <>
@@ -1,6 +1,5 @@
 #include "RendererDebugger.hpp"
 #include <glad/glad.h>
-#include <vector>
 #include <string>
 #include <sstream>
 #include "ConfigurationManager.hpp"
@@ -96,19 +95,19 @@ string RendererDebugger::debugSeverityDescription(DebugSeverity severity) const
 
 void RendererDebugger::checkForOpenGLErrors() const {
     bool highSeverityFound = false;
+    // Checked after every flush, nothing is allocated unless there is a message
+    GLchar buffer[4096];
     while (true) {
-        vector<GLchar> buffer(4096);
         GLenum severity;
         GLenum source;
         GLsizei messageSize;
         GLenum type;
         GLenum id;
-        GLuint count = glGetDebugMessageLog(1, (GLsizei)buffer.size(), &source, &type, &id, &severity, &messageSize, &buffer[0]);
+        GLuint count = glGetDebugMessageLog(1, (GLsizei)sizeof(buffer), &source, &type, &id, &severity, &messageSize, buffer);
         if (count == 0) {
             break;
         }
-        buffer.resize(messageSize);
-        string message = string(buffer.begin(), buffer.end());
+        string message = string(buffer, messageSize);
         DebugSource debugSource = DebugSource(source);
         DebugType debugType = DebugType(type);
         DebugSeverity debugSeverity = DebugSeverity(severity);
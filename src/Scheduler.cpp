@@ -0,0 +1,82 @@
+#include "Scheduler.tcc"
+#include <algorithm>
+#include <limits>
+
+using namespace std;
+
+const uint64_t NO_DEADLINE = numeric_limits<uint64_t>::max();
+// Every event can leave a few stale entries behind before the heap gets rebuilt
+const size_t MAX_HEAP_SIZE = SchedulerEventCount * 8;
+
+// Orders the heap so the earliest timestamp is at the front
+static bool isLater(const ScheduledEvent &a, const ScheduledEvent &b) {
+    return a.timestamp > b.timestamp;
+}
+
+Scheduler::Scheduler() : timestamp(0), nextDeadline(NO_DEADLINE), deadlines(), heap() {
+    deadlines.fill(NO_DEADLINE);
+}
+
+Scheduler::~Scheduler() {}
+
+uint64_t Scheduler::currentTimestamp() const {
+    return timestamp;
+}
+
+void Scheduler::schedule(SchedulerEvent event, uint64_t delay) {
+    uint64_t deadline = timestamp + delay;
+    deadlines[event] = deadline;
+    heap.push_back({ deadline, event });
+    push_heap(heap.begin(), heap.end(), isLater);
+    if (heap.size() > MAX_HEAP_SIZE) {
+        rebuildHeap();
+    }
+    updateNextDeadline();
+}
+
+void Scheduler::cancel(SchedulerEvent event) {
+    deadlines[event] = NO_DEADLINE;
+    updateNextDeadline();
+}
+
+bool Scheduler::isScheduled(SchedulerEvent event) const {
+    return deadlines[event] != NO_DEADLINE;
+}
+
+uint64_t Scheduler::cyclesUntilNextEvent() const {
+    if (nextDeadline <= timestamp) {
+        return 0;
+    }
+    return nextDeadline - timestamp;
+}
+
+optional<SchedulerEvent> Scheduler::popDueEvent() {
+    if (!isEventDue()) {
+        return nullopt;
+    }
+    SchedulerEvent event = heap.front().event;
+    pop_heap(heap.begin(), heap.end(), isLater);
+    heap.pop_back();
+    deadlines[event] = NO_DEADLINE;
+    updateNextDeadline();
+    return event;
+}
+
+// Drops the stale entries at the front, so it always holds a live deadline
+void Scheduler::updateNextDeadline() {
+    while (!heap.empty() && deadlines[heap.front().event] != heap.front().timestamp) {
+        pop_heap(heap.begin(), heap.end(), isLater);
+        heap.pop_back();
+    }
+    nextDeadline = heap.empty() ? NO_DEADLINE : heap.front().timestamp;
+}
+
+void Scheduler::rebuildHeap() {
+    heap.clear();
+    for (uint8_t event = 0; event < SchedulerEventCount; event++) {
+        if (deadlines[event] != NO_DEADLINE) {
+            heap.push_back({ deadlines[event], SchedulerEvent(event) });
+        }
+    }
+    make_heap(heap.begin(), heap.end(), isLater);
+}
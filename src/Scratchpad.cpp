@@ -3,9 +3,17 @@
 
 using namespace std;
 
-Scratchpad::Scratchpad() : data() {
+Scratchpad::Scratchpad() : memory(SCRATCHPAD_SIZE), data(memory.getData()) {
 }
 
 Scratchpad::~Scratchpad() {
 
 }
+
+uint8_t* Scratchpad::dataAtOffset(uint32_t offset) {
+    return &data[offset];
+}
+
+const SharedMemory& Scratchpad::getMemory() const {
+    return memory;
+}
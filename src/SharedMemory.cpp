@@ -0,0 +1,51 @@
+#include "SharedMemory.hpp"
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+SharedMemory::SharedMemory(size_t size) : data(nullptr), size(size), fileDescriptor(-1) {
+#if defined(__linux__)
+    size_t pageSize = sysconf(_SC_PAGESIZE);
+    size_t mappedSize = (size + pageSize - 1) / pageSize * pageSize;
+    int memoryFileDescriptor = memfd_create("ruby", MFD_CLOEXEC);
+    if (memoryFileDescriptor != -1) {
+        if (ftruncate(memoryFileDescriptor, mappedSize) == 0) {
+            void *memory = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, memoryFileDescriptor, 0);
+            if (memory != MAP_FAILED) {
+                data = static_cast<uint8_t *>(memory);
+                this->size = mappedSize;
+                fileDescriptor = memoryFileDescriptor;
+                return;
+            }
+        }
+        close(memoryFileDescriptor);
+    }
+#endif
+    data = new uint8_t[size]();
+}
+
+SharedMemory::~SharedMemory() {
+#if defined(__linux__)
+    if (fileDescriptor != -1) {
+        munmap(data, size);
+        close(fileDescriptor);
+        return;
+    }
+#endif
+    delete[] data;
+}
+
+uint8_t* SharedMemory::getData() const {
+    return data;
+}
+
+size_t SharedMemory::getSize() const {
+    return size;
+}
+
+int SharedMemory::getFileDescriptor() const {
+    return fileDescriptor;
+}
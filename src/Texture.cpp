@@ -34,6 +34,7 @@ void Texture::bind(GLenum texture) {
 void Texture::setImageFromBuffer(std::unique_ptr<GPUImageBuffer> &imageBuffer) {
     if (!imageBuffer->isValid()) {
         logger.logError("Invalid image buffer");
+        return;
     }
     uint16_t x, y, width, height;
     tie(x, y) = imageBuffer->destination();
@@ -1,10 +1,110 @@
 #include "Timer.hpp"
 #include "Constants.h"
+#include <limits>
 
-Timer::Timer(uint8_t identity) : logger(LogLevel::NoLog), identity(identity), counterValue(), counterMode(), counterTarget(), counter() {}
+using namespace std;
+
+const uint64_t NEVER = numeric_limits<uint64_t>::max();
+
+Timer::Timer(uint8_t identity, unique_ptr<Scheduler> &scheduler) : logger(LogLevel::NoLog), scheduler(scheduler), event(SchedulerEvent(Timer0Event + identity)), baseTimestamp(scheduler->currentTimestamp()), identity(identity), counterValue(), counterMode(), counterTarget() {}
 
 Timer::~Timer() {}
 
+// Ticks of the clock source since power on, so divided clocks keep their phase
+uint64_t Timer::ticksAt(uint64_t timestamp) {
+    TimerClockRate rate = clockRate();
+    return timestamp * rate.numerator / rate.denominator;
+}
+
+// Ticks until the counter next holds the given value, the counter goes up to
+// FFFFh unless it resets after reaching a target it is still below
+uint64_t Timer::ticksUntil(uint32_t value) {
+    uint32_t current = counterValue.value;
+    uint32_t target = counterTarget.target;
+    bool resetsAfterTarget = counterMode.timerResetCounter() == AfterTarget;
+    if (resetsAfterTarget && current <= target) {
+        if (value > target) {
+            return NEVER;
+        }
+        if (value > current) {
+            return value - current;
+        }
+        return target + 1 - current + value;
+    }
+    if (value > current) {
+        return value - current;
+    }
+    if (resetsAfterTarget && value > target) {
+        return NEVER;
+    }
+    return 0x10000 - current + value;
+}
+
+uint32_t Timer::valueAfter(uint64_t ticks) {
+    uint32_t current = counterValue.value;
+    uint32_t target = counterTarget.target;
+    bool resetsAfterTarget = counterMode.timerResetCounter() == AfterTarget;
+    if (resetsAfterTarget && current <= target) {
+        return (current + ticks) % (target + 1);
+    }
+    uint64_t ticksUntilWrap = 0x10000 - current;
+    if (ticks < ticksUntilWrap) {
+        return current + ticks;
+    }
+    ticks -= ticksUntilWrap;
+    if (resetsAfterTarget) {
+        return ticks % (target + 1);
+    }
+    return ticks % 0x10000;
+}
+
+// Counts all the ticks at once, the reached flags remember whether the
+// counter went through its target or FFFFh on the way
+void Timer::count(uint64_t ticks) {
+    if (ticks == 0) {
+        return;
+    }
+    if (ticks >= ticksUntil(counterTarget.target)) {
+        counterMode.rearchedTarget = true;
+    }
+    if (ticks >= ticksUntil(0xffff)) {
+        counterMode.rearchedOverflow = true;
+    }
+    counterValue.value = valueAfter(ticks);
+}
+
+void Timer::synchronize() {
+    uint64_t timestamp = scheduler->currentTimestamp();
+    count(ticksAt(timestamp) - ticksAt(baseTimestamp));
+    baseTimestamp = timestamp;
+}
+
+// Expects the counter to be synchronized
+void Timer::scheduleNextEvent() {
+    uint64_t ticks = NEVER;
+    if (counterMode.IRQWhenTarget) {
+        ticks = ticksUntil(counterTarget.target);
+    }
+    if (counterMode.IRQWhenOverflow) {
+        ticks = min(ticks, ticksUntil(0xffff));
+    }
+    if (ticks == NEVER) {
+        scheduler->cancel(event);
+        return;
+    }
+    TimerClockRate rate = clockRate();
+    uint64_t tick = ticksAt(baseTimestamp) + ticks;
+    uint64_t timestamp = (tick * rate.denominator + rate.numerator - 1) / rate.numerator;
+    scheduler->schedule(event, timestamp - scheduler->currentTimestamp());
+}
+
+// Called when the counter reaches a value an interrupt is armed for
+void Timer::update() {
+    synchronize();
+    checkInterruptRequest();
+    scheduleNextEvent();
+}
+
 uint32_t Timer::counterValueRegister() const {
     return counterValue._value;
 }
@@ -25,19 +125,13 @@ void Timer::setCounterTargetRegister(uint32_t value) {
     counterTarget._value = value;
 }
 
-void Timer0::step(uint32_t cycles) {
+TimerClockRate Timer0::clockRate() {
     Timer0ClockSource clockSource = counterMode.timer0ClockSource();
     if (clockSource == Timer0ClockSource::DotClock) {
-        uint32_t videoCycles = cycles*11/7;
-        counter += videoCycles;
-        counterValue.value += counter / VideoSystemClocksPerDot;
-        counter %= VideoSystemClocksPerDot;
-    } else {
-        counter += cycles;
-        counterValue.value += cycles;
+        // Video clocks are 11/7 system clocks
+        return { 11, 7 * VideoSystemClocksPerDot };
     }
-
-    checkTargetsAndOverflows();
+    return { 1, 1 };
 }
 
 void Timer0::setCounterModeRegister(uint32_t value) {
@@ -45,19 +139,12 @@ void Timer0::setCounterModeRegister(uint32_t value) {
     counterValue._value = 0;
 }
 
-void Timer1::step(uint32_t cycles) {
+TimerClockRate Timer1::clockRate() {
     Timer1ClockSource clockSource = counterMode.timer1ClockSource();
     if (clockSource == Timer1ClockSource::Hblank) {
-        uint32_t videoCycles = cycles*11/7;
-        counter += videoCycles;
-        counterValue.value += counter / VideoSystemClocksPerScanline;
-        counter %= VideoSystemClocksPerScanline;
-    } else {
-        counter += cycles;
-        counterValue.value += cycles;
+        return { 11, 7 * VideoSystemClocksPerScanline };
     }
-
-    checkTargetsAndOverflows();
+    return { 1, 1 };
 }
 
 void Timer1::setCounterModeRegister(uint32_t value) {
@@ -65,18 +152,12 @@ void Timer1::setCounterModeRegister(uint32_t value) {
     counterValue._value = 0;
 }
 
-void Timer2::step(uint32_t cycles) {
+TimerClockRate Timer2::clockRate() {
     Timer2ClockSource clockSource = counterMode.timer2ClockSource();
     if (clockSource == Timer2ClockSource::SystemClockByEight) {
-        counter += cycles;
-        counterValue.value += counter / 8;
-        counter %= 8;
-    } else {
-        counter += cycles;
-        counterValue.value += cycles;
+        return { 1, 8 };
     }
-
-    checkTargetsAndOverflows();
+    return { 1, 1 };
 }
 
 void Timer2::setCounterModeRegister(uint32_t value) {
@@ -84,38 +165,6 @@ void Timer2::setCounterModeRegister(uint32_t value) {
     counterValue._value = 0;
 }
 
-void Timer::checkTargetsAndOverflows() {
-    bool checkIRQ = false;
-
-    if (counterValue.value >= counterTarget.target) {
-        counterMode.rearchedTarget = true;
-        TimerResetCounter timerResetCounter = counterMode.timerResetCounter();
-        if (timerResetCounter == AfterTarget) {
-            counterValue._value = 0;
-        }
-        if (counterMode.IRQWhenTarget) {
-            checkIRQ = true;
-        }
-    }
-
-    if (counterValue.value >= 0xffff) {
-        counterMode.rearchedOverflow = true;
-        TimerResetCounter timerResetCounter = counterMode.timerResetCounter();
-        if (timerResetCounter == AfterOverflow) {
-            counterValue._value = 0;
-        }
-        if (counterMode.IRQWhenOverflow) {
-            checkIRQ = true;
-        }
-    }
-
-    if (!checkIRQ) {
-        return;
-    }
-
-    checkInterruptRequest();
-}
-
 void Timer::checkInterruptRequest() {
     logger.logWarning("Unhandled interrupt trigger for timer %d", identity);
 }
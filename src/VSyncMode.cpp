@@ -0,0 +1,14 @@
+#include "VSyncMode.hpp"
+
+using namespace std;
+
+VSyncMode vsyncModeWithValue(string value) {
+    if (value.compare("OFF") == 0) {
+        return VSyncMode::VSyncOff;
+    } else if (value.compare("ON") == 0) {
+        return VSyncMode::VSyncOn;
+    } else if (value.compare("ADAPTIVE") == 0) {
+        return VSyncMode::AdaptiveVSync;
+    }
+    return VSyncMode::AdaptiveVSync;
+}
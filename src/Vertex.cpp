@@ -3,16 +3,16 @@
 
 Point::Point() : x(), y() {}
 
-Point::Point(GLshort x, GLshort y) : x(x), y(y) {}
+Point::Point(int16_t x, int16_t y) : x(x), y(y) {}
 
 Point::Point(uint32_t position) {
-    x = ((GLshort)(position & 0xffff));
-    y = ((GLshort)((position >> 16) & 0xffff));
+    x = ((int16_t)(position & 0xffff));
+    y = ((int16_t)((position >> 16) & 0xffff));
 }
 
 Point Point::forTexturePosition(uint16_t position) {
-    GLshort texturePositonX = ((GLshort)(position & 0xff));
-    GLshort texturePositionY = ((GLshort)((position >> 8) & 0xff));
+    int16_t texturePositonX = ((int16_t)(position & 0xff));
+    int16_t texturePositionY = ((int16_t)((position >> 8) & 0xff));
     return {texturePositonX, texturePositionY};
 }
 
@@ -24,8 +24,8 @@ Texture page:
 7-8   Texture page colors   (0=4bit, 1=8bit, 2=15bit, 3=Reserved);GPUSTAT.7-8
 */
 Point Point::forTexturePage(uint32_t texturePage) {
-    GLshort texturePageX = ((GLshort)((texturePage & 0xf) << 6));
-    GLshort texturePageY = ((GLshort)(((texturePage >> 4) & 0x1) << 8));
+    int16_t texturePageX = ((int16_t)((texturePage & 0xf) << 6));
+    int16_t texturePageY = ((int16_t)(((texturePage >> 4) & 0x1) << 8));
     return {texturePageX, texturePageY};
 }
 
@@ -36,23 +36,32 @@ CLUT:
 15       Unknown/unused (should be 0)
 */
 Point Point::forClut(uint16_t clutData) {
-    GLshort x = ((GLshort)((clutData & 0x3f) << 4));
-    GLshort y = ((GLshort)((clutData >> 6) & 0x1ff));
+    int16_t x = ((int16_t)((clutData & 0x3f) << 4));
+    int16_t y = ((int16_t)((clutData >> 6) & 0x1ff));
     return {x, y};
 }
 
 Color::Color(uint32_t color) {
-    r = ((GLubyte)(color & 0xff));
-    g = ((GLubyte)((color >> 8) & 0xff));
-    b = ((GLubyte)((color >> 16) & 0xff));
+    r = ((uint8_t)(color & 0xff));
+    g = ((uint8_t)((color >> 8) & 0xff));
+    b = ((uint8_t)((color >> 16) & 0xff));
 }
 
-Vertex::Vertex(Point point, Color color) : point(point), color(color), texturePosition(), textureBlendMode(), texturePage(), textureDepthShift(), clut() {}
+Vertex::Vertex() : point(), color(0), texturePosition(), attributes(0) {}
 
-Vertex::Vertex(Point point, Color color, Point texturePosition, TextureBlendMode textureBlendMode, Point texturePage, GLuint textureDepthShift, Point clut) : point(point), color(color), texturePosition(texturePosition), textureBlendMode(textureBlendMode), texturePage(texturePage), textureDepthShift(textureDepthShift), clut(clut) {}
+Vertex::Vertex(Point point, Color color) : point(point), color(color), texturePosition(), attributes(0) {}
+
+Vertex::Vertex(Point point, Color color, Point texturePosition, TextureBlendMode textureBlendMode, Point texturePage, uint32_t textureDepthShift, Point clut) : point(point), color(color), texturePosition(texturePosition) {
+    attributes = (clut.x >> 4) & 0x3f;
+    attributes |= (clut.y & 0x1ff) << 6;
+    attributes |= ((texturePage.x >> 6) & 0xf) << 16;
+    attributes |= ((texturePage.y >> 8) & 0x1) << 20;
+    attributes |= (textureBlendMode & 0x3) << 21;
+    attributes |= (textureDepthShift & 0x3) << 23;
+}
 
 Vertex::~Vertex() {}
 
-Pixel::Pixel(GLfloat pointX, GLfloat pointY, GLfloat framebufferPositionX, GLfloat framebufferPositionY) : pointX(pointX), pointY(pointY), framebufferPositionX(framebufferPositionX), framebufferPositionY(framebufferPositionY) {}
+Pixel::Pixel(float pointX, float pointY, float framebufferPositionX, float framebufferPositionY) : pointX(pointX), pointY(pointY), framebufferPositionX(framebufferPositionX), framebufferPositionY(framebufferPositionY) {}
 
 Pixel::~Pixel() {}
@@ -26,6 +26,35 @@ void Window::makeCurrent() {
     SDL_GL_MakeCurrent(window, glContext);
 }
 
+// Shares textures, buffers and programs with the window context, which has to be current
+SDL_GLContext Window::createSharedContext() {
+    SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 1);
+    SDL_GLContext context = SDL_GL_CreateContext(window);
+    SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 0);
+    return context;
+}
+
+void Window::setVSync(VSyncMode mode) {
+    switch (mode) {
+        case VSyncMode::VSyncOff: {
+            SDL_GL_SetSwapInterval(0);
+            break;
+        }
+        case VSyncMode::VSyncOn: {
+            SDL_GL_SetSwapInterval(1);
+            break;
+        }
+        case VSyncMode::AdaptiveVSync: {
+            // Not every driver has late swap tearing
+            if (SDL_GL_SetSwapInterval(-1) != 0) {
+                logger.logWarning("Adaptive vsync isn't supported, using vsync");
+                SDL_GL_SetSwapInterval(1);
+            }
+            break;
+        }
+    }
+}
+
 Dimensions Window::getDimensions() {
     return { width, height };
 }
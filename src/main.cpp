@@ -1,8 +1,8 @@
 #include <SDL2/SDL.h>
 #include <memory>
 #include <cstdint>
+#include <chrono>
 #include "Emulator.hpp"
-#include "Debugger.hpp"
 #include "EmulatorRunner.hpp"
 #include "Logger.hpp"
 #include "Constants.h"
@@ -11,19 +11,28 @@
 using namespace std;
 
 int main(int argc, char* argv[]) {
-    EmulatorRunner *emulatorRunner = EmulatorRunner::getInstance();
+    unique_ptr<EmulatorRunner> emulatorRunner = make_unique<EmulatorRunner>();
     emulatorRunner->configure(argc, argv);
     ConfigurationManager *configurationManager = ConfigurationManager::getInstance();
     configurationManager->setupConfigurationFile();
     configurationManager->loadConfiguration();
-    std::unique_ptr<Emulator> emulator = std::make_unique<Emulator>();
+    std::unique_ptr<Emulator> emulator = std::make_unique<Emulator>(emulatorRunner.get());
     emulatorRunner->setEmulator(emulator.get());
-    Debugger *debugger = Debugger::getInstance();
-    debugger->setCPU(emulator->getCPU());
+    if (emulator->isHeadless()) {
+        // Nothing to present, so frames run back to back without pacing or event polling
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        while (!emulator->shouldTerminate()) {
+            emulator->emulateFrame();
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        Logger logger(LogLevel::NoLog);
+        logger.logDebug("%llu frames, %llu instructions in %.3f s", (unsigned long long)emulator->emulatedFrameCount(), (unsigned long long)emulator->executedInstructionCount(), seconds);
+        return emulator->getExitCode();
+    }
+    // Input is sampled about this often while waiting for frames to present
+    const chrono::milliseconds inputPollInterval(1);
+    emulator->startEmulationThread();
     bool quit = false;
-    uint32_t initTicks = SDL_GetTicks();
-    float interval = 1000;
-    interval /= FrameRateTarget;
     while (!quit) {
         SDL_Event event;
         while (SDL_PollEvent(&event)) {
@@ -32,36 +41,42 @@ int main(int argc, char* argv[]) {
             } else if (event.type == SDL_KEYDOWN) {
                 switch (event.key.keysym.sym) {
                     case SDLK_BACKSPACE: {
-                        debugger->debug();
+                        emulator->debug();
                         break;
                     }
                     case SDLK_i: {
                         emulator->toggleDebugInfoWindow();
                         break;
                     }
+                    case SDLK_c: {
+                        emulator->cycleCPUExecutionMode();
+                        break;
+                    }
+                    case SDLK_l: {
+                        emulator->toggleCPULockstep();
+                        break;
+                    }
+                    case SDLK_o: {
+                        emulator->cycleCPUClock();
+                        break;
+                    }
+                    case SDLK_u: {
+                        emulator->toggleThrottle();
+                        break;
+                    }
                 }
             }
             emulator->handleSDLEvent(event);
         }
-        if (debugger->isAttached() && debugger->shouldStep()) {
-            debugger->doStep();
-            continue;
-        }
-        if (debugger->isAttached() && debugger->isStopped()) {
-            continue;
-        }
-        if (quit) {
-            continue;
-        }
+        emulator->pollInput();
         if (emulator->shouldTerminate()) {
             quit = true;
             continue;
         }
-        uint32_t currentTicks = SDL_GetTicks();
-        if (initTicks + interval < currentTicks) {
-            emulator->emulateFrame();
-            initTicks = SDL_GetTicks();
+        if (emulator->waitForFrame(inputPollInterval)) {
+            emulator->presentFrame();
         }
     }
-    return 0;
+    emulator->stopEmulationThread();
+    return emulator->getMachine()->hasFailed() ? 1 : 0;
 }
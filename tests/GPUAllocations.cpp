@@ -0,0 +1,108 @@
+#include "GPU.tcc"
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+using namespace std;
+
+/*
+Checks that drawing commands go from GP0 to the backend without touching the heap
+
+Every global operator new is counted, the GPU gets warmed up with a few rounds
+of polygon, line and rectangle commands and then no further allocation is allowed.
+*/
+
+static uint64_t allocations = 0;
+
+void* operator new(size_t size) {
+    allocations++;
+    void *pointer = malloc(size ? size : 1);
+    if (pointer == nullptr) {
+        throw bad_alloc();
+    }
+    return pointer;
+}
+
+void operator delete(void *pointer) noexcept {
+    free(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept {
+    free(pointer);
+}
+
+class CountingBackend : public GPUBackend {
+public:
+    uint64_t lineVertices = 0;
+    uint64_t polygonVertices = 0;
+
+    void pushLine(const Vertex *, unsigned int count) override { lineVertices += count; }
+    void pushPolygon(const Vertex *, unsigned int count) override { polygonVertices += count; }
+    void setDrawingOffset(int16_t, int16_t) override {}
+    void prepareFrame() override {}
+    void renderFrame() override {}
+    void finalizeFrame(GPU *) override {}
+    void loadImage(unique_ptr<GPUImageBuffer> &) override {}
+    bool readVRAM(uint16_t, uint16_t, uint16_t, uint16_t, uint16_t *) override { return false; }
+};
+
+static const uint32_t drawingCommands[] = {
+    // Monochrome triangle and quad
+    0x20ff0000, 0x00100010, 0x00200010, 0x00100020,
+    0x2800ff00, 0x00100010, 0x00100020, 0x00200010, 0x00200020,
+    // Textured quad
+    0x2c808080, 0x00100010, 0x7fc00000, 0x00100020, 0x00080010, 0x00200010, 0x00001000, 0x00200020, 0x00101010,
+    // Shaded quad and shaded textured triangle
+    0x38ff0000, 0x00100010, 0x0000ff00, 0x00100020, 0x000000ff, 0x00200010, 0x00ffffff, 0x00200020,
+    0x34808080, 0x00100010, 0x7fc00000, 0x00808080, 0x00100020, 0x00080010, 0x00808080, 0x00200010, 0x00001000,
+    // Line, polyline ended by the termination code and shaded line
+    0x40ffffff, 0x00100010, 0x00200020,
+    0x48ffffff, 0x00100010, 0x00200020, 0x00300010, 0x00400020, 0x55555555,
+    0x50ff0000, 0x00100010, 0x0000ff00, 0x00200020,
+    // Variable size rectangle, textured one, and a 16x16 one
+    0x60ffffff, 0x00100010, 0x00100010,
+    0x64808080, 0x00100010, 0x7fc00000, 0x00100010,
+    0x78ffffff, 0x00100010,
+    // VRAM fill, which is drawn as a quad as well
+    0x02ffffff, 0x00000000, 0x00100010,
+};
+
+static void drawRound(GPU &gpu, uint32_t round) {
+    // Moves the drawing offset around so the batch isn't the same every time
+    gpu.store<uint32_t>(0, 0xe5000000 | (round & 0x3ff));
+    for (uint32_t word : drawingCommands) {
+        gpu.store<uint32_t>(0, word);
+    }
+}
+
+int main() {
+    const uint32_t warmUpRounds = 16;
+    const uint32_t measuredRounds = 1000;
+
+    GPU gpu(NoLog);
+    unique_ptr<CountingBackend> backend = make_unique<CountingBackend>();
+    CountingBackend *counters = backend.get();
+    gpu.setRenderer(move(backend));
+
+    for (uint32_t round = 0; round < warmUpRounds; round++) {
+        drawRound(gpu, round);
+    }
+    uint64_t allocationsBefore = allocations;
+    uint64_t verticesBefore = counters->lineVertices + counters->polygonVertices;
+    for (uint32_t round = 0; round < measuredRounds; round++) {
+        drawRound(gpu, round);
+    }
+    uint64_t newAllocations = allocations - allocationsBefore;
+    uint64_t vertices = counters->lineVertices + counters->polygonVertices - verticesBefore;
+
+    printf("%u rounds: %llu vertices pushed, %llu allocations\n", measuredRounds, (unsigned long long)vertices, (unsigned long long)newAllocations);
+    if (vertices == 0) {
+        printf("No primitive reached the backend\n");
+        return EXIT_FAILURE;
+    }
+    if (newAllocations != 0) {
+        printf("Drawing commands allocated after warm-up\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}